@@ -0,0 +1,53 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Position in an arena, made of the index of a block and the offset inside it.
+struct ArenaMarker
+{
+    size_t block;
+    size_t offset;
+};
+
+// Bump-pointer arena: memory is handed out from large blocks by advancing an offset.
+// Individual allocations are never freed; reset() makes all the blocks available
+// again, so a tape which is cleared and re-recorded stops allocating after the first
+// evaluation.
+class Arena
+{
+    std::vector<std::unique_ptr<char[]> > m_blocks;
+    std::vector<size_t> m_blockSizes;
+    size_t m_currentBlock;
+    size_t m_offset;
+    size_t m_blockSize;
+public:
+    Arena(size_t blockSize=(1 << 20));
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    void* allocate(size_t numBytes, size_t alignment=alignof(std::max_align_t));
+    void reset();
+    size_t getCapacity() const;
+    // rewind() releases everything allocated after getMarker() was called, while the
+    // allocations made before it stay valid; reset() is a rewind to the very start.
+    ArenaMarker getMarker() const;
+    void rewind(const ArenaMarker& marker);
+
+    // Constructs a copy of a trivially destructible object inside the arena.
+    template <typename T>
+    T* create(const T& obj)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(obj);
+    }
+
+    template <typename T>
+    T* allocateArray(size_t n)
+    {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,333 @@
+#ifndef AUTODIFF_HPP
+#define AUTODIFF_HPP
+
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include "vectr.hpp"
+
+// Dual number for forward-mode automatic differentiation. Along with the value, it
+// carries N tangents (derivatives along N seed directions), so that N directional
+// derivatives are propagated in a single evaluation. All the tangent loops have a
+// compile-time length, which lets the compiler unroll and vectorize them.
+//
+// Functions to be differentiated should be written generically, e.g.
+//   template <typename T> T f(T x) { return x * sin(x); }
+// The overloads of the mathematical functions below are found through argument
+// dependent lookup, so an unqualified call like sin(x) works for both double and Dual.
+template <size_t N=1>
+class Dual
+{
+    double m_value;
+    double m_tangent[N];
+public:
+    Dual(double value=0)
+    {
+        m_value = value;
+        for(size_t i = 0; i < N; i++)
+        {
+            m_tangent[i] = 0;
+        }
+    }
+
+    // Creates a dual number seeded with a unit tangent in the direction 'lane'.
+    Dual(double value, size_t lane)
+    :Dual(value)
+    {
+        m_tangent[lane] = 1;
+    }
+
+    double getValue() const
+    {
+        return m_value;
+    }
+
+    double getTangent(size_t i=0) const
+    {
+        return m_tangent[i];
+    }
+
+    void setTangent(size_t i, double t)
+    {
+        m_tangent[i] = t;
+    }
+
+    // Returns a dual number with value f and tangents scaled by the derivative df,
+    // i.e. the result of applying a function with derivative df to this number.
+    Dual chain(double f, double df) const
+    {
+        Dual r(f);
+        for(size_t i = 0; i < N; i++)
+        {
+            r.m_tangent[i] = df * m_tangent[i];
+        }
+        return r;
+    }
+
+    Dual operator-() const
+    {
+        return chain(-m_value, -1);
+    }
+
+    Dual operator+(const Dual& d) const
+    {
+        Dual r(m_value + d.m_value);
+        for(size_t i = 0; i < N; i++)
+        {
+            r.m_tangent[i] = m_tangent[i] + d.m_tangent[i];
+        }
+        return r;
+    }
+
+    Dual operator-(const Dual& d) const
+    {
+        Dual r(m_value - d.m_value);
+        for(size_t i = 0; i < N; i++)
+        {
+            r.m_tangent[i] = m_tangent[i] - d.m_tangent[i];
+        }
+        return r;
+    }
+
+    Dual operator*(const Dual& d) const
+    {
+        Dual r(m_value * d.m_value);
+        for(size_t i = 0; i < N; i++)
+        {
+            r.m_tangent[i] = m_tangent[i] * d.m_value + m_value * d.m_tangent[i];
+        }
+        return r;
+    }
+
+    Dual operator/(const Dual& d) const
+    {
+        double inv = 1 / d.m_value;
+        double q = m_value * inv;
+        Dual r(q);
+        for(size_t i = 0; i < N; i++)
+        {
+            r.m_tangent[i] = (m_tangent[i] - q * d.m_tangent[i]) * inv;
+        }
+        return r;
+    }
+
+    // Operations with constants avoid the multiplications with zero tangents.
+    Dual operator+(double c) const
+    {
+        Dual r = (*this);
+        r.m_value += c;
+        return r;
+    }
+
+    Dual operator-(double c) const
+    {
+        return (*this) + (-c);
+    }
+
+    Dual operator*(double c) const
+    {
+        return chain(m_value * c, c);
+    }
+
+    Dual operator/(double c) const
+    {
+        return (*this) * (1 / c);
+    }
+
+    Dual& operator+=(const Dual& d)
+    {
+        return (*this) = (*this) + d;
+    }
+
+    Dual& operator-=(const Dual& d)
+    {
+        return (*this) = (*this) - d;
+    }
+
+    Dual& operator*=(const Dual& d)
+    {
+        return (*this) = (*this) * d;
+    }
+
+    Dual& operator/=(const Dual& d)
+    {
+        return (*this) = (*this) / d;
+    }
+
+    // Comparisons only look at the values, so that branches in the differentiated
+    // function behave as they do for plain doubles.
+    // They are friends so that a constant is accepted on either side.
+    friend bool operator<(const Dual& a, const Dual& b) { return a.m_value < b.m_value; }
+    friend bool operator>(const Dual& a, const Dual& b) { return a.m_value > b.m_value; }
+    friend bool operator<=(const Dual& a, const Dual& b) { return a.m_value <= b.m_value; }
+    friend bool operator>=(const Dual& a, const Dual& b) { return a.m_value >= b.m_value; }
+    friend bool operator==(const Dual& a, const Dual& b) { return a.m_value == b.m_value; }
+    friend bool operator!=(const Dual& a, const Dual& b) { return a.m_value != b.m_value; }
+};
+
+template <size_t N>
+Dual<N> operator+(double c, const Dual<N>& d)
+{
+    return d + c;
+}
+
+template <size_t N>
+Dual<N> operator-(double c, const Dual<N>& d)
+{
+    return (-d) + c;
+}
+
+template <size_t N>
+Dual<N> operator*(double c, const Dual<N>& d)
+{
+    return d * c;
+}
+
+template <size_t N>
+Dual<N> operator/(double c, const Dual<N>& d)
+{
+    double inv = 1 / d.getValue();
+    return d.chain(c * inv, -c * inv * inv);
+}
+
+template <size_t N>
+Dual<N> sin(const Dual<N>& d)
+{
+    return d.chain(std::sin(d.getValue()), std::cos(d.getValue()));
+}
+
+template <size_t N>
+Dual<N> cos(const Dual<N>& d)
+{
+    return d.chain(std::cos(d.getValue()), -std::sin(d.getValue()));
+}
+
+template <size_t N>
+Dual<N> tan(const Dual<N>& d)
+{
+    double t = std::tan(d.getValue());
+    return d.chain(t, 1 + t * t);
+}
+
+template <size_t N>
+Dual<N> asin(const Dual<N>& d)
+{
+    double x = d.getValue();
+    return d.chain(std::asin(x), 1 / std::sqrt(1 - x * x));
+}
+
+template <size_t N>
+Dual<N> acos(const Dual<N>& d)
+{
+    double x = d.getValue();
+    return d.chain(std::acos(x), -1 / std::sqrt(1 - x * x));
+}
+
+template <size_t N>
+Dual<N> atan(const Dual<N>& d)
+{
+    double x = d.getValue();
+    return d.chain(std::atan(x), 1 / (1 + x * x));
+}
+
+template <size_t N>
+Dual<N> sinh(const Dual<N>& d)
+{
+    return d.chain(std::sinh(d.getValue()), std::cosh(d.getValue()));
+}
+
+template <size_t N>
+Dual<N> cosh(const Dual<N>& d)
+{
+    return d.chain(std::cosh(d.getValue()), std::sinh(d.getValue()));
+}
+
+template <size_t N>
+Dual<N> tanh(const Dual<N>& d)
+{
+    double t = std::tanh(d.getValue());
+    return d.chain(t, 1 - t * t);
+}
+
+template <size_t N>
+Dual<N> exp(const Dual<N>& d)
+{
+    double e = std::exp(d.getValue());
+    return d.chain(e, e);
+}
+
+template <size_t N>
+Dual<N> log(const Dual<N>& d)
+{
+    return d.chain(std::log(d.getValue()), 1 / d.getValue());
+}
+
+template <size_t N>
+Dual<N> sqrt(const Dual<N>& d)
+{
+    double s = std::sqrt(d.getValue());
+    return d.chain(s, 0.5 / s);
+}
+
+template <size_t N>
+Dual<N> fabs(const Dual<N>& d)
+{
+    return d.chain(std::fabs(d.getValue()), (d.getValue() < 0) ? -1 : 1);
+}
+
+template <size_t N>
+Dual<N> pow(const Dual<N>& d, double p)
+{
+    double x = d.getValue();
+    return d.chain(std::pow(x, p), p * std::pow(x, p - 1));
+}
+
+template <size_t N>
+Dual<N> pow(const Dual<N>& a, const Dual<N>& b)
+{
+    // a^b = exp(b * log(a)), which requires a > 0.
+    return exp(b * log(a));
+}
+
+// Returns the derivative of func at x, which is exact up to rounding error (unlike the
+// finite difference of getDifferentiatedValue). func must accept and return Dual<1>.
+template <typename Function>
+double getAutoDifferentiatedValue(const Function& func, double x)
+{
+    return func(Dual<1>(x, 0)).getTangent(0);
+}
+
+// Returns the gradient of the scalar function func at x. func must accept a
+// const std::vector<Dual<Lanes> >& and return a Dual<Lanes>. Every evaluation
+// propagates Lanes partial derivatives at once, so the gradient takes
+// ceil(x.size() / Lanes) evaluations; choosing Lanes >= x.size() gives the whole
+// gradient in a single pass.
+template <size_t Lanes=8, typename Function>
+Vector getAutoGradient(const Function& func, const Vector& x)
+{
+    size_t n = x.size();
+    std::vector<double> gradient(n, 0);
+    std::vector<Dual<Lanes> > xDual(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        xDual[i] = Dual<Lanes>(x[i]);
+    }
+    for(size_t i0 = 0; i0 < n; i0 += Lanes)
+    {
+        size_t count = ((n - i0) < Lanes) ? (n - i0) : Lanes;
+        // Seed the lanes with the unit directions of this block of variables.
+        for(size_t k = 0; k < count; k++)
+        {
+            xDual[i0 + k].setTangent(k, 1);
+        }
+        Dual<Lanes> r = func(xDual);
+        for(size_t k = 0; k < count; k++)
+        {
+            gradient[i0 + k] = r.getTangent(k);
+            xDual[i0 + k].setTangent(k, 0);
+        }
+    }
+    return Vector(gradient);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#ifndef BINARY_IO_HPP
+#define BINARY_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "mapped_file.hpp"
+#include "linalg_fwd.hpp"
+
+// Binary file format for Matrix, Vector, SparseMatrix and TiledMatrix, laid out so that a mapped file
+// can be used in place: the Mapped* classes below read the elements straight from the
+// mapped pages, without parsing or copying them.
+//
+// A file is a 128 byte header followed by the payload. The header holds, in this order:
+//   magic        8 bytes   "MATHOPS" followed by a 0 byte
+//   version      uint32    BINARY_FORMAT_VERSION
+//   byteOrder    uint32    0x01020304, written in the byte order of the writer
+//   objectType   uint32    BinaryObjectEnum
+//   flags        uint32    bit 0: the checksum is set
+//   alignment    uint32    alignment of the payload sections, in bytes (a multiple of 8)
+//   tileSize     uint32    side of the square tiles of a TiledMatrix, else 0
+//   numRows      uint64    1 for a Vector
+//   numColumns   uint64
+//   numStored    uint64    stored elements: numRows * numColumns, or those of the CSR
+//   defaultValue double    value of the elements not stored by a SparseMatrix, else 0
+//   checksum     uint64    see getBinaryChecksum, or 0
+// and zeros up to 128 bytes. All the integers and doubles are in the byte order of the
+// writer; readers reject files of the other byte order.
+//
+// The payload is a sequence of sections, each one starting at a multiple of the alignment
+// from the start of the file and padded with zeros to the next multiple:
+//   MATRIX, VECTOR   numStored doubles, in row-major order
+//   SPARSE_MATRIX    compressed sparse rows (CSR): numRows + 1 uint64 row offsets, then
+//                    numStored uint64 column indices (increasing within a row), then
+//                    numStored double values
+//   TILED_MATRIX     numStored doubles: the tiles, by rows of tiles, each one as tileSize
+//                    rows of tileSize doubles; the tiles at the right and bottom edges are
+//                    padded with zeros, so numStored is a multiple of tileSize * tileSize
+const uint32_t BINARY_FORMAT_VERSION = 1;
+const size_t BINARY_HEADER_SIZE = 128;
+const size_t BINARY_ALIGNMENT = 64;
+
+enum BinaryObjectEnum {BINARY_MATRIX = 1, BINARY_VECTOR = 2, BINARY_SPARSE_MATRIX = 3, BINARY_TILED_MATRIX = 4};
+
+struct BinaryFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t objectType;
+    uint32_t flags;
+    uint32_t alignment;
+    uint32_t tileSize;
+    uint64_t numRows;
+    uint64_t numColumns;
+    uint64_t numStored;
+    double defaultValue;
+    uint64_t checksum;
+};
+
+// A header with the current version, byte order and alignment, and no checksum.
+BinaryFileHeader getBinaryFileHeader(BinaryObjectEnum objectType, size_t numRows, size_t numColumns, size_t numStored, double defaultValue);
+
+// Checksum of a payload, as a sequence of 64-bit words: FNV-1a over words instead of
+// bytes. size must be a multiple of 8. The running value starts at BINARY_CHECKSUM_SEED.
+const uint64_t BINARY_CHECKSUM_SEED = 0xcbf29ce484222325ULL;
+uint64_t getBinaryChecksum(const char* data, size_t size, uint64_t checksum=BINARY_CHECKSUM_SEED);
+
+// Writes the object to a file in the format above, with the checksum if withChecksum.
+// Returns false if the file could not be written.
+bool writeBinaryFile(const std::string& path, const Matrix& m, bool withChecksum=true);
+bool writeBinaryFile(const std::string& path, const Vector& v, bool withChecksum=true);
+bool writeBinaryFile(const std::string& path, const SparseMatrix& sm, bool withChecksum=true);
+
+// Reads and validates the header of a mapped file (magic, version, byte order and size)
+// and, for a sparse matrix, the row offsets and column indices of the CSR arrays.
+// Returns false, with a description in error, if the file is not a valid binary file.
+bool readBinaryFileHeader(const MappedFile& file, BinaryFileHeader& header, std::string& error);
+// Recomputes the checksum of the payload; true if it matches, or if there is none.
+bool verifyBinaryChecksum(const MappedFile& file);
+
+// Read-only views of the objects in mapped files. They share the mapping, which stays
+// alive as long as any view of it does. The constructors with an error string open files
+// which may not be valid: if the file is not a valid binary file of the right object type
+// (or its checksum does not match, when verified), the view is left empty, isValid()
+// returns false and error describes the problem (error is cleared on success). The
+// constructors without one are for files known to be valid, and fail an assertion.
+class MappedMatrix
+{
+    std::shared_ptr<MappedFile> m_file;
+    const double* m_data;
+    size_t m_numRows;
+    size_t m_numColumns;
+    bool open(const std::string& path, bool verifyChecksum, std::string& error);
+public:
+    MappedMatrix(const std::string& path, bool verifyChecksum=false);
+    MappedMatrix(const std::string& path, std::string& error, bool verifyChecksum=false);
+    bool isValid() const;
+    size_t getNumRows() const;
+    size_t getNumColumns() const;
+    // Row i, as numColumns contiguous doubles.
+    const double* operator[](size_t i) const;
+    double operator()(size_t i, size_t j) const;
+    const double* getData() const;
+    // Copies the elements into a new Matrix.
+    Matrix getMatrix() const;
+};
+
+class MappedVector
+{
+    std::shared_ptr<MappedFile> m_file;
+    const double* m_data;
+    size_t m_size;
+    bool open(const std::string& path, bool verifyChecksum, std::string& error);
+public:
+    MappedVector(const std::string& path, bool verifyChecksum=false);
+    MappedVector(const std::string& path, std::string& error, bool verifyChecksum=false);
+    bool isValid() const;
+    size_t size() const;
+    double operator[](size_t i) const;
+    const double* getData() const;
+    Vector getVector() const;
+};
+
+class MappedSparseMatrix
+{
+    std::shared_ptr<MappedFile> m_file;
+    const uint64_t* m_rowOffsets;
+    const uint64_t* m_columns;
+    const double* m_values;
+    size_t m_numRows;
+    size_t m_numColumns;
+    size_t m_numStored;
+    double m_defaultValue;
+    bool open(const std::string& path, bool verifyChecksum, std::string& error);
+public:
+    MappedSparseMatrix(const std::string& path, bool verifyChecksum=false);
+    MappedSparseMatrix(const std::string& path, std::string& error, bool verifyChecksum=false);
+    bool isValid() const;
+    size_t getNumRows() const;
+    size_t getNumColumns() const;
+    size_t getNumStoredElements() const;
+    double getDefaultValue() const;
+    // The stored elements of row i are k = getRowOffsets()[i], ..., getRowOffsets()[i + 1] - 1,
+    // with column getColumns()[k] and value getValues()[k].
+    const uint64_t* getRowOffsets() const;
+    const uint64_t* getColumns() const;
+    const double* getValues() const;
+    // Element (i, j), found by binary search in row i.
+    double operator()(size_t i, size_t j) const;
+    // Product with a vector, straight from the mapped arrays.
+    Vector operator*(const Vector& v) const;
+    SparseMatrix getSparseMatrix() const;
+};
+
+#endif
\ No newline at end of file
@@ -1,9 +1,352 @@
 #ifndef CALCULUS_HPP
 #define CALCULUS_HPP
 
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include "parallel.hpp"
+#include "summation.hpp"
+
 double getIntegratedValue(double (*func)(double), double start, double end, int n=1000, double frac=0.5); 
 
+// The following overload accepts any callable (lambdas with captures, functors, etc.),
+// so that the integrand can be inlined into the summation loop. Plain function pointers
+// still resolve to the non-template version above.
+template <typename Function>
+double getIntegratedValue(const Function& func, double start, double end, int n=1000, double frac=0.5)
+{
+    assert((frac >= 0) && (frac <= 1));
+    double dx = (end - start) / n;
+    double sum = 0;
+    for(int i = 0; i < n; i++)
+    {
+        // The node is computed from its index, instead of cumulatively, so that the
+        // iterations do not depend on each other.
+        sum += func(start + (i + frac) * dx);
+    }
+    return sum * dx;
+}
+
+// Integration for integrands which evaluate a whole block of points in one call. The
+// callable must be usable as: func(const double* x, double* fx, size_t count), and it
+// must write func(x[k]) into fx[k] for every k < count.
+template <typename BatchFunction>
+double getBatchIntegratedValue(const BatchFunction& func, double start, double end, int n=1000, double frac=0.5, size_t batchSize=256)
+{
+    assert((frac >= 0) && (frac <= 1));
+    assert(batchSize > 0);
+    double dx = (end - start) / n;
+    double sum = 0;
+    // The buffers are allocated once and reused for all the blocks.
+    std::vector<double> x(batchSize);
+    std::vector<double> fx(batchSize);
+    size_t numPoints = (n > 0) ? (size_t)n : 0;
+    for(size_t i0 = 0; i0 < numPoints; i0 += batchSize)
+    {
+        size_t count = ((numPoints - i0) < batchSize) ? (numPoints - i0) : batchSize;
+        for(size_t k = 0; k < count; k++)
+        {
+            x[k] = start + ((i0 + k) + frac) * dx;
+        }
+        func(x.data(), fx.data(), count);
+        for(size_t k = 0; k < count; k++)
+        {
+            sum += fx[k];
+        }
+    }
+    return sum * dx;
+}
+
+// Same rule as getIntegratedValue, with the n nodes split into numThreads contiguous
+// chunks which are summed concurrently (numThreads=0 uses all the hardware threads).
+// Every node is computed from its index as start + (i + frac) * dx, and both the chunk
+// sums and their total use compensated summation, so neither the node positions nor
+// the sum accumulate rounding error with n. The chunk sums are combined in chunk order,
+// hence the result is the same on every run for a fixed numThreads. The integrand is
+// called concurrently from several threads, so it must be safe to do so.
+template <typename Function>
+double getParallelIntegratedValue(const Function& func, double start, double end, int n=1000, double frac=0.5, size_t numThreads=0)
+{
+    assert((frac >= 0) && (frac <= 1));
+    double dx = (end - start) / n;
+    size_t numPoints = (n > 0) ? (size_t)n : 0;
+    size_t numChunks = getNumThreads(numThreads);
+    // There is no use for more chunks than there are nodes.
+    numChunks = (numPoints < numChunks) ? ((numPoints > 0) ? numPoints : 1) : numChunks;
+    std::vector<double> chunkSums(numChunks, 0);
+    runInParallel(numPoints, numChunks, [&](size_t chunkIndex, size_t chunkStart, size_t chunkEnd)
+    {
+        CompensatedSum sum;
+        for(size_t i = chunkStart; i < chunkEnd; i++)
+        {
+            sum.add(func(start + (i + frac) * dx));
+        }
+        chunkSums[chunkIndex] = sum.getSum();
+    });
+    CompensatedSum total;
+    for(const auto& chunkSum: chunkSums)
+    {
+        total.add(chunkSum);
+    }
+    return total.getSum() * dx;
+}
+
+struct IntegrationResult
+{
+    double value;
+    double errorEstimate;
+    size_t numEvaluations;
+    bool converged;
+};
+
+// Applies the 15-point Kronrod rule, with its embedded 7-point Gauss rule, to the
+// interval [start, end]. The returned value is the Kronrod estimate, and 'error' is
+// set to the (QUADPACK-style scaled) difference between the two estimates.
+template <typename Function>
+double getGaussKronrodValue(const Function& func, double start, double end, double& error)
+{
+    // Kronrod nodes in decreasing order; the odd-indexed ones, along with the centre,
+    // are also the nodes of the 7-point Gauss rule.
+    static const double xgk[8] = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+    };
+    static const double wgk[8] = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+    };
+    static const double wg[4] = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+    };
+    double centre = 0.5 * (start + end);
+    double halfLength = 0.5 * (end - start);
+    double absHalfLength = fabs(halfLength);
+    double fCentre = func(centre);
+    double resultGauss = fCentre * wg[3];
+    double resultKronrod = fCentre * wgk[7];
+    double resultAbs = fabs(resultKronrod);
+    double fv1[7], fv2[7];
+    for(size_t j = 0; j < 7; j++)
+    {
+        double dx = halfLength * xgk[j];
+        fv1[j] = func(centre - dx);
+        fv2[j] = func(centre + dx);
+        double fSum = fv1[j] + fv2[j];
+        resultKronrod += wgk[j] * fSum;
+        resultAbs += wgk[j] * (fabs(fv1[j]) + fabs(fv2[j]));
+        if(j % 2 == 1)
+        {
+            resultGauss += wg[j / 2] * fSum;
+        }
+    }
+    // resultAsc approximates the integral of |f - mean(f)|, which is used to scale the
+    // raw error estimate.
+    double meanKronrod = 0.5 * resultKronrod;
+    double resultAsc = wgk[7] * fabs(fCentre - meanKronrod);
+    for(size_t j = 0; j < 7; j++)
+    {
+        resultAsc += wgk[j] * (fabs(fv1[j] - meanKronrod) + fabs(fv2[j] - meanKronrod));
+    }
+    resultAbs *= absHalfLength;
+    resultAsc *= absHalfLength;
+    error = fabs((resultKronrod - resultGauss) * halfLength);
+    if((resultAsc != 0) && (error != 0))
+    {
+        double scale = pow(200 * error / resultAsc, 1.5);
+        error = resultAsc * ((scale < 1) ? scale : 1);
+    }
+    double epsilon = std::numeric_limits<double>::epsilon();
+    if(resultAbs > std::numeric_limits<double>::min() / (50 * epsilon))
+    {
+        double roundOff = 50 * epsilon * resultAbs;
+        error = (roundOff > error) ? roundOff : error;
+    }
+    return resultKronrod * halfLength;
+}
+
+struct IntegrationInterval
+{
+    double start;
+    double end;
+    double value;
+    double error;
+    // Ordering by error makes the interval with the largest error the top of a heap.
+    bool operator<(const IntegrationInterval& other) const
+    {
+        return error < other.error;
+    }
+};
+
+// Adaptive integration over a finite interval: the interval with the largest error
+// estimate is repeatedly bisected until the total error satisfies the tolerances, or
+// the number of subintervals reaches maxIntervals.
+template <typename Function>
+IntegrationResult getAdaptiveFiniteIntegratedValue(const Function& func, double start, double end, double absTolerance, double relTolerance, size_t maxIntervals)
+{
+    assert(maxIntervals > 0);
+    std::vector<IntegrationInterval> heap = {};
+    heap.reserve(maxIntervals + 1);
+    IntegrationInterval whole = {start, end, 0, 0};
+    whole.value = getGaussKronrodValue(func, start, end, whole.error);
+    heap.push_back(whole);
+    double value = whole.value;
+    double error = whole.error;
+    size_t numEvaluations = 15;
+    while((error > std::max(absTolerance, relTolerance * fabs(value))) && (heap.size() < maxIntervals))
+    {
+        std::pop_heap(heap.begin(), heap.end());
+        IntegrationInterval worst = heap.back();
+        heap.pop_back();
+        double mid = 0.5 * (worst.start + worst.end);
+        // Stop if the interval can no longer be split in floating point.
+        if((mid == worst.start) || (mid == worst.end))
+        {
+            heap.push_back(worst);
+            std::push_heap(heap.begin(), heap.end());
+            break;
+        }
+        IntegrationInterval left = {worst.start, mid, 0, 0};
+        IntegrationInterval right = {mid, worst.end, 0, 0};
+        left.value = getGaussKronrodValue(func, left.start, left.end, left.error);
+        right.value = getGaussKronrodValue(func, right.start, right.end, right.error);
+        numEvaluations += 30;
+        value += (left.value + right.value - worst.value);
+        error += (left.error + right.error - worst.error);
+        heap.push_back(left);
+        std::push_heap(heap.begin(), heap.end());
+        heap.push_back(right);
+        std::push_heap(heap.begin(), heap.end());
+    }
+    // The running totals are only used to drive the loop; the final totals are summed
+    // afresh to avoid the drift of the repeated updates.
+    value = 0;
+    error = 0;
+    for(const auto& interval: heap)
+    {
+        value += interval.value;
+        error += interval.error;
+    }
+    bool converged = (error <= std::max(absTolerance, relTolerance * fabs(value)));
+    return {value, error, numEvaluations, converged};
+}
+
+// Adaptive Gauss-Kronrod (G7-K15) integration. Either (or both) of the limits may be
+// infinite, in which case the integral is mapped onto a finite interval through a
+// change of variables:
+//   [a, inf)   : x = a + t / (1 - t),     t in [0, 1)
+//   (-inf, b]  : x = b - (1 - t) / t,     t in (0, 1]
+//   (-inf, inf): x = t / (1 - t * t),     t in (-1, 1)
+// The Kronrod nodes are interior to each interval, so the singular end-points of the
+// transformations are never evaluated.
+template <typename Function>
+IntegrationResult getAdaptiveIntegratedValue(const Function& func, double start, double end, double absTolerance=1.e-10, double relTolerance=1.e-10, size_t maxIntervals=1000)
+{
+    bool startInfinite = std::isinf(start);
+    bool endInfinite = std::isinf(end);
+    if(!startInfinite && !endInfinite)
+    {
+        return getAdaptiveFiniteIntegratedValue(func, start, end, absTolerance, relTolerance, maxIntervals);
+    }
+    if(start > end)
+    {
+        IntegrationResult r = getAdaptiveIntegratedValue(func, end, start, absTolerance, relTolerance, maxIntervals);
+        r.value = -r.value;
+        return r;
+    }
+    if(startInfinite && endInfinite)
+    {
+        auto transformed = [&func](double t)
+        {
+            double d = 1 - t * t;
+            return func(t / d) * (1 + t * t) / (d * d);
+        };
+        return getAdaptiveFiniteIntegratedValue(transformed, -1, 1, absTolerance, relTolerance, maxIntervals);
+    }
+    if(endInfinite)
+    {
+        auto transformed = [&func, start](double t)
+        {
+            double d = 1 - t;
+            return func(start + t / d) / (d * d);
+        };
+        return getAdaptiveFiniteIntegratedValue(transformed, 0, 1, absTolerance, relTolerance, maxIntervals);
+    }
+    auto transformed = [&func, end](double t)
+    {
+        return func(end - (1 - t) / t) / (t * t);
+    };
+    return getAdaptiveFiniteIntegratedValue(transformed, 0, 1, absTolerance, relTolerance, maxIntervals);
+}
+
+// Romberg integration: trapezoid rules with 1, 2, 4, ... intervals, where every level
+// only evaluates the new midpoints and reuses the sum of the coarser levels, followed by
+// Richardson extrapolation of the sequence. For smooth integrands the extrapolated
+// estimates converge geometrically; the iteration stops as soon as two successive ones
+// agree within the tolerances (but not before 8 intervals, to avoid being fooled by
+// coarse grids which happen to hit special points), or after maxLevels levels.
+template <typename Function>
+IntegrationResult getRombergIntegratedValue(const Function& func, double start, double end, double absTolerance=1.e-10, double relTolerance=1.e-10, size_t maxLevels=20)
+{
+    assert((maxLevels > 0) && (maxLevels < 63));
+    // Only the last two rows of the Romberg tableau are kept.
+    std::vector<double> previous(maxLevels, 0);
+    std::vector<double> current(maxLevels, 0);
+    double h = end - start;
+    previous[0] = 0.5 * h * (func(start) + func(end));
+    IntegrationResult result = {previous[0], fabs(previous[0]), 2, false};
+    for(size_t k = 1; k < maxLevels; k++)
+    {
+        h *= 0.5;
+        size_t numNew = (size_t)1 << (k - 1);
+        CompensatedSum sum;
+        for(size_t i = 0; i < numNew; i++)
+        {
+            sum.add(func(start + (2 * i + 1) * h));
+        }
+        result.numEvaluations += numNew;
+        current[0] = 0.5 * previous[0] + h * sum.getSum();
+        double factor = 1;
+        for(size_t j = 1; j <= k; j++)
+        {
+            factor *= 4;
+            current[j] = current[j - 1] + (current[j - 1] - previous[j - 1]) / (factor - 1);
+        }
+        result.value = current[k];
+        result.errorEstimate = fabs(current[k] - previous[k - 1]);
+        double tolerance = std::max(absTolerance, relTolerance * fabs(result.value));
+        if((k >= 3) && (result.errorEstimate <= tolerance))
+        {
+            result.converged = true;
+            break;
+        }
+        std::swap(previous, current);
+    }
+    return result;
+}
+
 enum DifferentialEnum {BACKWARD, FORWARD, CENTRAL};
 double getDifferentiatedValue(double (*func)(double), double x, double dx, int mode=DifferentialEnum::CENTRAL);
 
+// Returns the offsets of the two points at which a mode evaluates the function: the
+// derivative is (func(x + forwardOffset) - func(x - backwardOffset)) / dx.
+void getDifferentialOffsets(double dx, int mode, double& forwardOffset, double& backwardOffset);
+
+// Overload of getDifferentiatedValue for any callable.
+template <typename Function>
+double getDifferentiatedValue(const Function& func, double x, double dx, int mode=DifferentialEnum::CENTRAL)
+{
+    double forwardOffset, backwardOffset;
+    getDifferentialOffsets(dx, mode, forwardOffset, backwardOffset);
+    return (func(x + forwardOffset) - func(x - backwardOffset)) / dx;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,182 @@
+#ifndef CUBATURE_HPP
+#define CUBATURE_HPP
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "calculus.hpp"
+#include "parallel.hpp"
+#include "vectr.hpp"
+
+// Integration over d-dimensional boxes by sampling.
+//   MONTE_CARLO: pseudo-random points; the error estimate is the standard error of
+//                the sample mean.
+//   HALTON, SOBOL: low-discrepancy (quasi-Monte Carlo) points, whose error decreases
+//                nearly as 1/N instead of 1/sqrt(N). Several independently randomized
+//                copies (replicates) of the sequence are used, and the error estimate
+//                is the standard error of the mean over the replicates.
+enum SamplingEnum {MONTE_CARLO, HALTON, SOBOL};
+
+// Count, mean and sum of squared deviations of a set of samples. Two sets can be
+// merged exactly, so that statistics computed per block can be combined in a fixed
+// order, independently of how the blocks were spread over threads.
+class RunningStatistics
+{
+    double m_count;
+    double m_mean;
+    double m_m2;
+public:
+    RunningStatistics(double count=0, double mean=0, double m2=0);
+    void merge(const RunningStatistics& s);
+    double getCount() const;
+    double getMean() const;
+    // Unbiased variance of the samples.
+    double getVariance() const;
+};
+
+// Points in the unit cube [0, 1)^d, for the samplings of SamplingEnum. A point is fully
+// determined by the seed, its replicate and its index, so blocks of points can be
+// generated in any order, on any thread.
+//
+// The Sobol direction numbers are built from primitive polynomials over GF(2), which
+// are found at construction time, so there is no limit on the dimension. The initial
+// direction numbers of every dimension are taken from a fixed pseudo-random stream
+// rather than from an optimized table (like that of Joe and Kuo); every such choice
+// gives a valid Sobol sequence, though some low-dimensional projections may be less
+// uniform than with tuned values. Replicates are randomized with a digital (XOR) shift
+// for SOBOL, and a random shift modulo 1 for HALTON.
+class PointSequence
+{
+    int m_sampling;
+    size_t m_dimension;
+    uint64_t m_seed;
+    std::vector<uint32_t> m_directions;
+    std::vector<uint32_t> m_primes;
+    std::vector<uint32_t> m_digitalShifts;
+    std::vector<double> m_shifts;
+public:
+    PointSequence(int sampling, size_t dimension, size_t numReplicates, uint64_t seed);
+    size_t getDimension() const;
+    // Writes the points with indices [first, first + count) of a replicate into
+    // points, which must have room for count * dimension values (row-major).
+    void getPoints(size_t replicate, size_t first, size_t count, double* points) const;
+};
+
+// Integrates a function which evaluates blocks of points: func(x, fx, count) must set
+// fx[k] to the value at the point x[k * d], ..., x[k * d + d - 1] for every k < count.
+// The number of points is doubled in rounds until the error estimate satisfies the
+// tolerances, or until maxEvaluations is reached. Blocks of points are evaluated on
+// numThreads threads (0 uses all the hardware threads), and their statistics are
+// merged in a fixed order, so the result depends on the seed but not on numThreads.
+template <typename BatchFunction>
+IntegrationResult getBatchCubatureValue(const BatchFunction& func, const Vector& lower, const Vector& upper, int sampling=SamplingEnum::SOBOL, double absTolerance=1.e-6, double relTolerance=1.e-4, size_t maxEvaluations=(1 << 22), uint64_t seed=0, size_t numThreads=0)
+{
+    assert(lower.size() == upper.size());
+    const size_t blockSize = 256;
+    size_t dimension = lower.size();
+    size_t numReplicates = (sampling == SamplingEnum::MONTE_CARLO) ? 1 : 8;
+    PointSequence sequence(sampling, dimension, numReplicates, seed);
+    double volume = 1;
+    for(size_t k = 0; k < dimension; k++)
+    {
+        volume *= (upper[k] - lower[k]);
+    }
+    std::vector<RunningStatistics> replicateStatistics(numReplicates);
+    IntegrationResult result = {0, 0, 0, false};
+    size_t pointsDone = 0;
+    size_t pointsTarget = 4 * blockSize;
+    size_t maxPoints = maxEvaluations / numReplicates;
+    size_t numChunks = getNumThreads(numThreads);
+    while(pointsDone < maxPoints)
+    {
+        pointsTarget = (pointsTarget < maxPoints) ? pointsTarget : maxPoints;
+        size_t blocksPerReplicate = (pointsTarget - pointsDone + blockSize - 1) / blockSize;
+        size_t numBlocks = blocksPerReplicate * numReplicates;
+        std::vector<RunningStatistics> blockStatistics(numBlocks);
+        size_t chunks = (numBlocks < numChunks) ? numBlocks : numChunks;
+        runInParallel(numBlocks, chunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+        {
+            // The buffers of a thread are reused for all its blocks.
+            std::vector<double> points(blockSize * dimension);
+            std::vector<double> values(blockSize);
+            for(size_t b = chunkStart; b < chunkEnd; b++)
+            {
+                size_t replicate = b / blocksPerReplicate;
+                size_t first = pointsDone + (b % blocksPerReplicate) * blockSize;
+                size_t count = ((pointsTarget - first) < blockSize) ? (pointsTarget - first) : blockSize;
+                sequence.getPoints(replicate, first, count, points.data());
+                for(size_t p = 0; p < count; p++)
+                {
+                    double* x = points.data() + p * dimension;
+                    for(size_t k = 0; k < dimension; k++)
+                    {
+                        x[k] = lower[k] + (upper[k] - lower[k]) * x[k];
+                    }
+                }
+                func(static_cast<const double*>(points.data()), values.data(), count);
+                // Two passes over the block give an accurate sum of squared deviations.
+                double mean = 0;
+                for(size_t p = 0; p < count; p++)
+                {
+                    mean += values[p];
+                }
+                mean /= count;
+                double m2 = 0;
+                for(size_t p = 0; p < count; p++)
+                {
+                    m2 += (values[p] - mean) * (values[p] - mean);
+                }
+                blockStatistics[b] = RunningStatistics(count, mean, m2);
+            }
+        });
+        for(size_t b = 0; b < numBlocks; b++)
+        {
+            replicateStatistics[b / blocksPerReplicate].merge(blockStatistics[b]);
+        }
+        result.numEvaluations += (pointsTarget - pointsDone) * numReplicates;
+        pointsDone = pointsTarget;
+        if(sampling == SamplingEnum::MONTE_CARLO)
+        {
+            const RunningStatistics& s = replicateStatistics[0];
+            result.value = volume * s.getMean();
+            result.errorEstimate = fabs(volume) * sqrt(s.getVariance() / s.getCount());
+        }
+        else
+        {
+            RunningStatistics means;
+            for(const auto& s: replicateStatistics)
+            {
+                means.merge(RunningStatistics(1, s.getMean(), 0));
+            }
+            result.value = volume * means.getMean();
+            result.errorEstimate = fabs(volume) * sqrt(means.getVariance() / numReplicates);
+        }
+        double tolerance = (absTolerance > relTolerance * fabs(result.value)) ? absTolerance : relTolerance * fabs(result.value);
+        result.converged = (result.errorEstimate <= tolerance);
+        if(result.converged)
+        {
+            break;
+        }
+        pointsTarget *= 2;
+    }
+    return result;
+}
+
+// Same as getBatchCubatureValue, for a function evaluating one point at a time:
+// func(x) returns the value at the point x[0], ..., x[d - 1].
+template <typename Function>
+IntegrationResult getCubatureValue(const Function& func, const Vector& lower, const Vector& upper, int sampling=SamplingEnum::SOBOL, double absTolerance=1.e-6, double relTolerance=1.e-4, size_t maxEvaluations=(1 << 22), uint64_t seed=0, size_t numThreads=0)
+{
+    size_t dimension = lower.size();
+    auto batchFunc = [&func, dimension](const double* x, double* fx, size_t count)
+    {
+        for(size_t p = 0; p < count; p++)
+        {
+            fx[p] = func(x + p * dimension);
+        }
+    };
+    return getBatchCubatureValue(batchFunc, lower, upper, sampling, absTolerance, relTolerance, maxEvaluations, seed, numThreads);
+}
+
+#endif
\ No newline at end of file
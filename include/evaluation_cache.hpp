@@ -0,0 +1,87 @@
+#ifndef EVALUATION_CACHE_HPP
+#define EVALUATION_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Bounded cache of the values of a function of one variable, keyed on the exact bit
+// pattern of x (so 0.0 and -0.0 are different keys). Entries are spread over shards by
+// a hash of the key; every shard has its own lock and evicts its least recently used
+// entry when it is full, so threads working on different points rarely contend.
+class EvaluationCache
+{
+    struct Shard
+    {
+        std::mutex mutex;
+        size_t capacity;
+        // Most recently used entries first.
+        std::list<std::pair<uint64_t, double> > entries;
+        std::unordered_map<uint64_t, std::list<std::pair<uint64_t, double> >::iterator> index;
+    };
+    std::vector<std::unique_ptr<Shard> > m_shards;
+    std::atomic<size_t> m_numHits;
+    std::atomic<size_t> m_numMisses;
+    Shard& getShard(uint64_t key);
+public:
+    // The capacity is split as evenly as possible over the shards, so it bounds the number
+    // of entries; there are never more shards than entries.
+    EvaluationCache(size_t capacity=65536, size_t numShards=16);
+    EvaluationCache(const EvaluationCache&) = delete;
+    EvaluationCache& operator=(const EvaluationCache&) = delete;
+    // Returns true, and sets fx, if x is in the cache.
+    bool find(double x, double& fx);
+    void insert(double x, double fx);
+    void clear();
+    size_t size();
+    size_t getNumHits() const;
+    size_t getNumMisses() const;
+};
+
+// Wraps a callable so that its values are looked up in (and added to) an
+// EvaluationCache. Copies of a CachedFunction share the same cache, so it can be passed
+// by value to the integration and differentiation routines. It is safe to call from
+// several threads if the wrapped callable is; two threads which miss on the same point
+// at the same time both evaluate it.
+template <typename Function>
+class CachedFunction
+{
+    Function m_func;
+    std::shared_ptr<EvaluationCache> m_cache;
+public:
+    CachedFunction(const Function& func, size_t capacity=65536, size_t numShards=16)
+    :m_func(func), m_cache(std::make_shared<EvaluationCache>(capacity, numShards))
+    {
+    }
+
+    double operator()(double x) const
+    {
+        double fx;
+        if(m_cache->find(x, fx))
+        {
+            return fx;
+        }
+        fx = m_func(x);
+        m_cache->insert(x, fx);
+        return fx;
+    }
+
+    EvaluationCache& getCache() const
+    {
+        return *m_cache;
+    }
+};
+
+template <typename Function>
+CachedFunction<Function> getCachedFunction(const Function& func, size_t capacity=65536, size_t numShards=16)
+{
+    return CachedFunction<Function>(func, capacity, numShards);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,464 @@
+#ifndef FIXED_MATRIX_HPP
+#define FIXED_MATRIX_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include "matrix.hpp"
+#include "vectr.hpp"
+
+// Small matrices and vectors whose dimensions are template parameters, for transforms
+// of a few elements (2x2 to 8x8). The elements live in the object itself, so they need
+// no heap allocation, and every loop has a compile-time length: the kernels below are
+// unrolled through index sequences, and all of them can be evaluated at compile time
+// (constexpr). The determinant and inverse have closed forms up to 4x4, and use Gaussian
+// elimination with partial pivoting for larger sizes.
+
+// Calls f(0), f(1), ..., f(N - 1), unrolled.
+template <typename Function, size_t... I>
+constexpr void unrollIndices(const Function& f, std::index_sequence<I...>)
+{
+    (f(I), ...);
+}
+
+template <size_t N, typename Function>
+constexpr void unroll(const Function& f)
+{
+    unrollIndices(f, std::make_index_sequence<N>());
+}
+
+template <size_t N, typename T=double>
+class FixedVector
+{
+    T m_data[N];
+public:
+    constexpr FixedVector()
+    :m_data()
+    {
+    }
+
+    constexpr FixedVector(std::initializer_list<T> values)
+    :m_data()
+    {
+        assert(values.size() == N);
+        size_t i = 0;
+        for(const T& x: values)
+        {
+            m_data[i++] = x;
+        }
+    }
+
+    explicit FixedVector(const BasicVector<T>& v)
+    :m_data()
+    {
+        assert(v.size() == N);
+        unroll<N>([&](size_t i) { m_data[i] = v[i]; });
+    }
+
+    constexpr T& operator[](size_t i)
+    {
+        return m_data[i];
+    }
+
+    constexpr const T& operator[](size_t i) const
+    {
+        return m_data[i];
+    }
+
+    constexpr size_t size() const
+    {
+        return N;
+    }
+
+    constexpr FixedVector operator+(const FixedVector& v) const
+    {
+        FixedVector r;
+        unroll<N>([&](size_t i) { r.m_data[i] = m_data[i] + v.m_data[i]; });
+        return r;
+    }
+
+    constexpr FixedVector operator-(const FixedVector& v) const
+    {
+        FixedVector r;
+        unroll<N>([&](size_t i) { r.m_data[i] = m_data[i] - v.m_data[i]; });
+        return r;
+    }
+
+    constexpr FixedVector operator*(T c) const
+    {
+        FixedVector r;
+        unroll<N>([&](size_t i) { r.m_data[i] = m_data[i] * c; });
+        return r;
+    }
+
+    constexpr T dot(const FixedVector& v) const
+    {
+        T sum = 0;
+        unroll<N>([&](size_t i) { sum += m_data[i] * v.m_data[i]; });
+        return sum;
+    }
+
+    constexpr T getSum() const
+    {
+        T sum = 0;
+        unroll<N>([&](size_t i) { sum += m_data[i]; });
+        return sum;
+    }
+
+    BasicVector<T> getVector() const
+    {
+        return BasicVector<T>(std::vector<T>(m_data, m_data + N));
+    }
+};
+
+template <size_t R, size_t C, typename T=double>
+class FixedMatrix
+{
+    T m_data[R][C];
+
+    static constexpr T getAbsolute(T x)
+    {
+        return (x < 0) ? -x : x;
+    }
+
+    // Gaussian elimination with partial pivoting on a copy of the matrix, which also
+    // applies the row operations to inverse if it is given. Returns the determinant.
+    constexpr T getEliminated(FixedMatrix* inverse) const
+    {
+        FixedMatrix a = (*this);
+        T determinant = 1;
+        for(size_t k = 0; k < R; k++)
+        {
+            size_t pivotRow = k;
+            for(size_t i = k + 1; i < R; i++)
+            {
+                pivotRow = (getAbsolute(a.m_data[i][k]) > getAbsolute(a.m_data[pivotRow][k])) ? i : pivotRow;
+            }
+            if(a.m_data[pivotRow][k] == 0)
+            {
+                return 0;
+            }
+            if(pivotRow != k)
+            {
+                determinant = -determinant;
+                for(size_t j = 0; j < C; j++)
+                {
+                    T x = a.m_data[k][j];
+                    a.m_data[k][j] = a.m_data[pivotRow][j];
+                    a.m_data[pivotRow][j] = x;
+                    if(inverse != nullptr)
+                    {
+                        x = inverse->m_data[k][j];
+                        inverse->m_data[k][j] = inverse->m_data[pivotRow][j];
+                        inverse->m_data[pivotRow][j] = x;
+                    }
+                }
+            }
+            T pivot = a.m_data[k][k];
+            determinant *= pivot;
+            for(size_t i = 0; i < R; i++)
+            {
+                // Below the pivot for the determinant, and above it as well for the inverse.
+                if((i == k) || ((i < k) && (inverse == nullptr)))
+                {
+                    continue;
+                }
+                T factor = a.m_data[i][k] / pivot;
+                for(size_t j = 0; j < C; j++)
+                {
+                    a.m_data[i][j] -= factor * a.m_data[k][j];
+                    if(inverse != nullptr)
+                    {
+                        inverse->m_data[i][j] -= factor * inverse->m_data[k][j];
+                    }
+                }
+            }
+        }
+        if(inverse != nullptr)
+        {
+            for(size_t i = 0; i < R; i++)
+            {
+                for(size_t j = 0; j < C; j++)
+                {
+                    inverse->m_data[i][j] /= a.m_data[i][i];
+                }
+            }
+        }
+        return determinant;
+    }
+public:
+    constexpr FixedMatrix()
+    :m_data()
+    {
+    }
+
+    // The elements by rows, e.g. {{1, 2}, {3, 4}}.
+    constexpr FixedMatrix(std::initializer_list<std::initializer_list<T> > rows)
+    :m_data()
+    {
+        assert(rows.size() == R);
+        size_t i = 0;
+        for(const auto& row: rows)
+        {
+            assert(row.size() == C);
+            size_t j = 0;
+            for(const T& x: row)
+            {
+                m_data[i][j++] = x;
+            }
+            i++;
+        }
+    }
+
+    explicit FixedMatrix(const BasicMatrix<T>& m)
+    :m_data()
+    {
+        assert((m.getNumRows() == R) && (m.getNumColumns() == C));
+        unroll<R>([&](size_t i)
+        {
+            unroll<C>([&](size_t j) { m_data[i][j] = m[i][j]; });
+        });
+    }
+
+    static constexpr FixedMatrix getIdentity()
+    {
+        static_assert(R == C, "The identity matrix is square");
+        FixedMatrix r;
+        unroll<R>([&](size_t i) { r.m_data[i][i] = 1; });
+        return r;
+    }
+
+    // Row i, so that elements are read and written as m[i][j].
+    constexpr T* operator[](size_t i)
+    {
+        return m_data[i];
+    }
+
+    constexpr const T* operator[](size_t i) const
+    {
+        return m_data[i];
+    }
+
+    constexpr size_t getNumRows() const
+    {
+        return R;
+    }
+
+    constexpr size_t getNumColumns() const
+    {
+        return C;
+    }
+
+    constexpr FixedMatrix operator+(const FixedMatrix& m) const
+    {
+        FixedMatrix r;
+        unroll<R>([&](size_t i)
+        {
+            unroll<C>([&](size_t j) { r.m_data[i][j] = m_data[i][j] + m.m_data[i][j]; });
+        });
+        return r;
+    }
+
+    constexpr FixedMatrix operator-(const FixedMatrix& m) const
+    {
+        FixedMatrix r;
+        unroll<R>([&](size_t i)
+        {
+            unroll<C>([&](size_t j) { r.m_data[i][j] = m_data[i][j] - m.m_data[i][j]; });
+        });
+        return r;
+    }
+
+    constexpr FixedMatrix operator*(T c) const
+    {
+        FixedMatrix r;
+        unroll<R>([&](size_t i)
+        {
+            unroll<C>([&](size_t j) { r.m_data[i][j] = m_data[i][j] * c; });
+        });
+        return r;
+    }
+
+    template <size_t K>
+    constexpr FixedMatrix<R, K, T> operator*(const FixedMatrix<C, K, T>& m) const
+    {
+        FixedMatrix<R, K, T> r;
+        unroll<R>([&](size_t i)
+        {
+            unroll<K>([&](size_t j)
+            {
+                T sum = 0;
+                unroll<C>([&](size_t k) { sum += m_data[i][k] * m[k][j]; });
+                r[i][j] = sum;
+            });
+        });
+        return r;
+    }
+
+    constexpr FixedVector<R, T> operator*(const FixedVector<C, T>& v) const
+    {
+        FixedVector<R, T> r;
+        unroll<R>([&](size_t i)
+        {
+            T sum = 0;
+            unroll<C>([&](size_t j) { sum += m_data[i][j] * v[j]; });
+            r[i] = sum;
+        });
+        return r;
+    }
+
+    constexpr FixedMatrix<C, R, T> getTranspose() const
+    {
+        FixedMatrix<C, R, T> r;
+        unroll<R>([&](size_t i)
+        {
+            unroll<C>([&](size_t j) { r[j][i] = m_data[i][j]; });
+        });
+        return r;
+    }
+
+    constexpr T getDeterminant() const
+    {
+        static_assert(R == C, "The determinant is defined for square matrices");
+        const auto& a = m_data;
+        if constexpr(R == 1)
+        {
+            return a[0][0];
+        }
+        else if constexpr(R == 2)
+        {
+            return a[0][0] * a[1][1] - a[0][1] * a[1][0];
+        }
+        else if constexpr(R == 3)
+        {
+            return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+                 - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+                 + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+        }
+        else if constexpr(R == 4)
+        {
+            // Laplace expansion by the 2x2 minors of the first two and last two rows.
+            T s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+            T s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+            T s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+            T s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+            T s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+            T s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+            T c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+            T c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+            T c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+            T c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+            T c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+            T c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+            return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        }
+        else
+        {
+            return getEliminated(nullptr);
+        }
+    }
+
+    // The matrix must not be singular.
+    constexpr FixedMatrix getInverse() const
+    {
+        static_assert(R == C, "The inverse is defined for square matrices");
+        const auto& a = m_data;
+        FixedMatrix r;
+        if constexpr(R == 1)
+        {
+            assert(a[0][0] != 0);
+            r.m_data[0][0] = 1 / a[0][0];
+        }
+        else if constexpr(R == 2)
+        {
+            T determinant = getDeterminant();
+            assert(determinant != 0);
+            r = FixedMatrix{{a[1][1], -a[0][1]}, {-a[1][0], a[0][0]}} * (1 / determinant);
+        }
+        else if constexpr(R == 3)
+        {
+            T determinant = getDeterminant();
+            assert(determinant != 0);
+            // The adjugate: the transposed cofactors.
+            unroll<3>([&](size_t i)
+            {
+                unroll<3>([&](size_t j)
+                {
+                    size_t i1 = (j + 1) % 3, i2 = (j + 2) % 3;
+                    size_t j1 = (i + 1) % 3, j2 = (i + 2) % 3;
+                    r.m_data[i][j] = (a[i1][j1] * a[i2][j2] - a[i1][j2] * a[i2][j1]) / determinant;
+                });
+            });
+        }
+        else if constexpr(R == 4)
+        {
+            // The adjugate from the same 2x2 minors as the determinant.
+            T s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+            T s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+            T s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+            T s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+            T s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+            T s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+            T c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+            T c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+            T c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+            T c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+            T c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+            T c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+            T determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+            assert(determinant != 0);
+            T d = 1 / determinant;
+            r.m_data[0][0] = (a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * d;
+            r.m_data[0][1] = (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * d;
+            r.m_data[0][2] = (a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * d;
+            r.m_data[0][3] = (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * d;
+            r.m_data[1][0] = (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * d;
+            r.m_data[1][1] = (a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * d;
+            r.m_data[1][2] = (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * d;
+            r.m_data[1][3] = (a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * d;
+            r.m_data[2][0] = (a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * d;
+            r.m_data[2][1] = (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * d;
+            r.m_data[2][2] = (a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * d;
+            r.m_data[2][3] = (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * d;
+            r.m_data[3][0] = (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * d;
+            r.m_data[3][1] = (a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * d;
+            r.m_data[3][2] = (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * d;
+            r.m_data[3][3] = (a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * d;
+        }
+        else
+        {
+            r = getIdentity();
+            T determinant = getEliminated(&r);
+            assert(determinant != 0);
+        }
+        return r;
+    }
+
+    BasicMatrix<T> getMatrix() const
+    {
+        std::vector<std::vector<T> > r(R);
+        for(size_t i = 0; i < R; i++)
+        {
+            r[i].assign(m_data[i], m_data[i] + C);
+        }
+        return BasicMatrix<T>(std::move(r));
+    }
+};
+
+// A row vector times a matrix, like Vector * Matrix.
+template <size_t R, size_t C, typename T>
+constexpr FixedVector<C, T> operator*(const FixedVector<R, T>& v, const FixedMatrix<R, C, T>& m)
+{
+    FixedVector<C, T> r;
+    unroll<C>([&](size_t j)
+    {
+        T sum = 0;
+        unroll<R>([&](size_t i) { sum += v[i] * m[i][j]; });
+        r[j] = sum;
+    });
+    return r;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,148 @@
+#ifndef LINALG_ALLOCATOR_HPP
+#define LINALG_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "arena.hpp"
+
+// Alignment of the element arrays of the linear algebra classes, enough for the widest
+// SIMD loads.
+const size_t LINALG_ALIGNMENT = 64;
+
+// Single objects up to this size, such as the nodes of the maps of the sparse classes,
+// come from per-thread free lists instead of separate heap allocations.
+const size_t LINALG_MAX_NODE_SIZE = 256;
+
+// Makes an arena the one from which the linear algebra objects created on the current
+// thread take their memory, until the scope ends. Everything allocated from it inside
+// the scope is then released at once, by rewinding the arena to where it was when the
+// scope started; its blocks are kept, so a loop whose body is a scope stops allocating
+// after the first iteration. Scopes can be nested, with different arenas or with the
+// same one; a scope inside another one of the same arena does not rewind it, because
+// objects of the outer scope may have grown into the arena in the meantime, so only the
+// outermost scope of each arena releases its memory. Scopes must end in the reverse
+// order in which they started.
+//
+// Objects created inside a scope must not be used after it ends. Assigning to a Vector
+// or Matrix created outside of it copies the elements into the memory of that object,
+// which is how results are kept, and elements added inside the scope to an object
+// created outside of it use the memory of that object. An arena must only be used by
+// the thread which opened the scope.
+class LinalgArenaScope
+{
+    Arena* m_arena;
+    LinalgArenaScope* m_previousScope;
+    ArenaMarker m_marker;
+    bool m_isOutermost;
+public:
+    LinalgArenaScope(Arena& arena);
+    LinalgArenaScope(const LinalgArenaScope&) = delete;
+    LinalgArenaScope& operator=(const LinalgArenaScope&) = delete;
+    ~LinalgArenaScope();
+    // The arena of the innermost scope on the current thread, or nullptr outside scopes.
+    static Arena* getCurrentArena();
+};
+
+// Memory from the arena if it is not nullptr, otherwise from the node pool of the
+// current thread or from the heap, depending on the size and alignment.
+void* allocateLinalgMemory(Arena* arena, size_t numBytes, size_t alignment);
+void deallocateLinalgMemory(Arena* arena, void* p, size_t numBytes, size_t alignment);
+
+// Allocator of the containers inside the linear algebra classes. It uses the arena of
+// the scope in which it was created, if any. A copy of a container gets the arena of
+// the scope in which it is made, while assignments keep the memory of the target.
+template <typename T>
+class LinalgAllocator
+{
+    Arena* m_arena;
+    template <typename U> friend class LinalgAllocator;
+
+    static constexpr size_t getAlignment(size_t n)
+    {
+        // Arrays are aligned for SIMD, single objects (map nodes) only as they need to be.
+        return ((n == 1) || (alignof(T) > LINALG_ALIGNMENT)) ? alignof(T) : LINALG_ALIGNMENT;
+    }
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    typedef std::false_type is_always_equal;
+
+    LinalgAllocator()
+    :m_arena(LinalgArenaScope::getCurrentArena())
+    {
+    }
+
+    explicit LinalgAllocator(Arena* arena)
+    :m_arena(arena)
+    {
+    }
+
+    template <typename U>
+    LinalgAllocator(const LinalgAllocator<U>& a)
+    :m_arena(a.m_arena)
+    {
+    }
+
+    Arena* getArena() const
+    {
+        return m_arena;
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(allocateLinalgMemory(m_arena, n * sizeof(T), getAlignment(n)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        deallocateLinalgMemory(m_arena, p, n * sizeof(T), getAlignment(n));
+    }
+
+    LinalgAllocator select_on_container_copy_construction() const
+    {
+        return LinalgAllocator();
+    }
+
+    // Containers of containers pass their arena on to the elements they construct, so
+    // the rows of a Matrix always live in the same memory as the Matrix itself.
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+        if constexpr(std::uses_allocator<U, LinalgAllocator>::value)
+        {
+            ::new(static_cast<void*>(p)) U(std::forward<Args>(args)..., typename U::allocator_type(*this));
+        }
+        else
+        {
+            ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const LinalgAllocator<U>& a) const
+    {
+        return m_arena == a.m_arena;
+    }
+
+    template <typename U>
+    bool operator!=(const LinalgAllocator<U>& a) const
+    {
+        return m_arena != a.m_arena;
+    }
+};
+
+// Storage of the linear algebra classes.
+template <typename T>
+using LinalgArray = std::vector<T, LinalgAllocator<T> >;
+
+template <typename T>
+using LinalgMap = std::map<size_t, T, std::less<size_t>, LinalgAllocator<std::pair<const size_t, T> > >;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef LINALG_FWD_HPP
+#define LINALG_FWD_HPP
+
+#include <complex>
+
+// Forward declarations of the linear algebra classes. They are templates over the type T
+// of their elements, explicitly instantiated for float, double and std::complex<double>;
+// the double versions keep the names the classes had before, so headers which only need
+// the names include this instead of declaring the classes.
+template <typename T> class BasicVector;
+template <typename T> class BasicMatrix;
+template <typename T> class BasicSparseVector;
+template <typename T> class BasicSparseMatrix;
+
+typedef BasicVector<double> Vector;
+typedef BasicMatrix<double> Matrix;
+typedef BasicSparseVector<double> SparseVector;
+typedef BasicSparseMatrix<double> SparseMatrix;
+
+typedef BasicVector<float> FloatVector;
+typedef BasicMatrix<float> FloatMatrix;
+typedef BasicSparseVector<float> FloatSparseVector;
+typedef BasicSparseMatrix<float> FloatSparseMatrix;
+
+typedef BasicVector<std::complex<double> > ComplexVector;
+typedef BasicMatrix<std::complex<double> > ComplexMatrix;
+typedef BasicSparseVector<std::complex<double> > ComplexSparseVector;
+typedef BasicSparseMatrix<std::complex<double> > ComplexSparseMatrix;
+
+// Views of parts of matrices (see matrix_view.hpp). The element type of a view of a
+// constant matrix is const.
+template <typename T> class BasicVectorView;
+template <typename T> class BasicMatrixView;
+template <typename T> class BasicSparseMatrixView;
+
+typedef BasicVectorView<double> VectorView;
+typedef BasicVectorView<const double> ConstVectorView;
+typedef BasicMatrixView<double> MatrixView;
+typedef BasicMatrixView<const double> ConstMatrixView;
+typedef BasicSparseMatrixView<double> SparseMatrixView;
+
+#endif
\ No newline at end of file
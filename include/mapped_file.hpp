@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// A whole file mapped into memory (POSIX mmap), read-only unless opened as writable, in
+// which case the changes go to the file itself. The pages are only read from disk when
+// they are first accessed, so opening even a very large file is immediate, and the
+// operating system may drop clean pages again under memory pressure. The mapping is
+// removed when the object is destroyed; it can be moved but not copied.
+class MappedFile
+{
+    const char* m_data;
+    size_t m_size;
+    bool m_isWritable;
+    std::string m_path;
+    void close();
+public:
+    MappedFile();
+    MappedFile(const std::string& path, bool writable=false);
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    // False if the file could not be opened or mapped.
+    bool isOpen() const;
+    bool isWritable() const;
+    const char* getData() const;
+    // Only for a writable mapping.
+    char* getWritableData() const;
+    size_t getSize() const;
+    const std::string& getPath() const;
+    // Hints that the given byte range will be read sequentially soon.
+    void prefetch(size_t offset, size_t length) const;
+    // Hints that the given byte range will not be needed soon, so that its pages can be
+    // dropped from the process (changes of a writable mapping are kept in the file).
+    void release(size_t offset, size_t length) const;
+    // Writes the changes of a writable mapping to disk; false if that fails.
+    bool sync() const;
+};
+
+#endif
\ No newline at end of file
@@ -1,48 +1,88 @@
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
+#include <initializer_list>
 #include <vector>
 #include <string>
+#include "linalg_allocator.hpp"
+#include "linalg_fwd.hpp"
 
-class Vector;
-class SparseMatrix;
-class SparseVector;
-
-class Matrix
+template <typename T>
+class BasicMatrix
 {
-    std::vector<std::vector<double> > m_data;
+    LinalgArray<LinalgArray<T> > m_data;
     size_t m_numRows;
     size_t m_numColumns;
     bool isDataValid() const;
+    template <typename U> friend class BasicMatrixView;
 public:
-    Matrix();
-    Matrix(const std::vector<std::vector<double> >& data);
-    std::vector<double>& operator[](size_t i);
-    const std::vector<double>& operator[](size_t i) const;
+    BasicMatrix();
+    BasicMatrix(const std::vector<std::vector<T> >& data);
+    BasicMatrix(std::initializer_list<std::initializer_list<T> > data);
+    BasicMatrix(LinalgArray<LinalgArray<T> >&& data);
+    // Explicit conversion from another element type, e.g. FloatMatrix to Matrix; there
+    // are no operations between different element types.
+    template <typename U>
+    explicit BasicMatrix(const BasicMatrix<U>& m)
+    {
+        m_numRows = m.getNumRows();
+        m_numColumns = m.getNumColumns();
+        m_data.resize(m_numRows);
+        for(size_t i = 0; i < m_numRows; i++)
+        {
+            for(const auto& x: m[i])
+            {
+                m_data[i].push_back(static_cast<T>(x));
+            }
+        }
+    }
+    LinalgArray<T>& operator[](size_t i);
+    const LinalgArray<T>& operator[](size_t i) const;
 
     // Addition and subtraction methods
-    Matrix operator+(double c) const;
-    Matrix operator-(double c) const;
-    Matrix operator+(const Matrix& m) const;
-    Matrix operator-(const Matrix& m) const;
-    Matrix operator+(const SparseMatrix& sm) const;
-    Matrix operator-(const SparseMatrix& sm) const;
+    BasicMatrix operator+(T c) const;
+    BasicMatrix operator-(T c) const;
+    BasicMatrix operator+(const BasicMatrix& m) const;
+    BasicMatrix operator-(const BasicMatrix& m) const;
+    BasicMatrix operator+(const BasicSparseMatrix<T>& sm) const;
+    BasicMatrix operator-(const BasicSparseMatrix<T>& sm) const;
+    BasicMatrix operator+(const BasicMatrixView<const T>& m) const;
+    BasicMatrix operator-(const BasicMatrixView<const T>& m) const;
 
     // Multiplication methods
-    Matrix operator*(double c) const;
-    Matrix operator*(const std::vector<std::vector<double> >& d) const;
-    Matrix operator*(const Matrix& m) const;
-    Matrix operator*(const SparseMatrix& sm) const;
-    Vector operator*(const std::vector<double>& d) const;
-    Vector operator*(const Vector& v) const;
-    Vector operator*(const SparseVector& sv) const;
+    BasicMatrix operator*(T c) const;
+    BasicMatrix operator*(const std::vector<std::vector<T> >& d) const;
+    BasicMatrix operator*(const BasicMatrix& m) const;
+    BasicMatrix operator*(const BasicSparseMatrix<T>& sm) const;
+    BasicVector<T> operator*(const std::vector<T>& d) const;
+    BasicVector<T> operator*(const BasicVector<T>& v) const;
+    BasicVector<T> operator*(const BasicSparseVector<T>& sv) const;
+    BasicMatrix operator*(const BasicMatrixView<const T>& m) const;
+    BasicVector<T> operator*(const BasicVectorView<const T>& v) const;
+
+    // Views which refer to parts of the matrix instead of copying them (see
+    // matrix_view.hpp); writing through the views of a matrix writes into it.
+    BasicMatrixView<T> getBlock(size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns);
+    BasicMatrixView<const T> getBlock(size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns) const;
+    BasicMatrixView<T> getRows(size_t firstRow, size_t numRows);
+    BasicMatrixView<const T> getRows(size_t firstRow, size_t numRows) const;
+    BasicMatrixView<T> getColumns(size_t firstColumn, size_t numColumns);
+    BasicMatrixView<const T> getColumns(size_t firstColumn, size_t numColumns) const;
+    BasicVectorView<T> getColumn(size_t j);
+    BasicVectorView<const T> getColumn(size_t j) const;
+    BasicVectorView<T> getDiagonal();
+    BasicVectorView<const T> getDiagonal() const;
 
-    const std::vector<std::vector<double> >& getData() const;
-    Matrix getInverse() const;
+    const LinalgArray<LinalgArray<T> >& getData() const;
+    BasicMatrix getInverse() const;
+    // Lower triangular L with L * L^T equal to this matrix, which must be symmetric
+    // positive definite (only its lower triangle is read). For complex elements the
+    // matrix must be Hermitian positive definite, and L * L^H is equal to it.
+    BasicMatrix getCholeskyFactor() const;
     // getTranspose() creates a completely new Matrix, whereas
     // T(i, j) can be used read an element from its transpose directly
-    Matrix getTranspose() const;
-    double t(size_t i, size_t j) const;
+    BasicMatrix getTranspose() const;
+    T t(size_t i, size_t j) const;
     size_t getNumRows() const;
     size_t getNumColumns() const;
     std::string getText() const;
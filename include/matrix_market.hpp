@@ -0,0 +1,30 @@
+#ifndef MATRIX_MARKET_HPP
+#define MATRIX_MARKET_HPP
+
+#include <cstddef>
+#include <string>
+#include "linalg_fwd.hpp"
+
+// Matrix Market exchange format, for sparse matrices in coordinate form: a banner
+//   %%MatrixMarket matrix coordinate <field> <symmetry>
+// then comment lines starting with %, a line with the number of rows, columns and
+// entries, and one line per entry with its 1-based row and column and, unless the field
+// is pattern, its value.
+
+// Reads a coordinate file with the field real, integer or pattern (whose entries are 1)
+// and the symmetry general, symmetric or skew-symmetric (whose entries are mirrored).
+// The file is mapped and split into numThreads chunks at line boundaries (0 uses all the
+// hardware threads), which are parsed and sorted in parallel; the sorted entries are
+// then passed to the bulk SparseMatrix constructor. Repeated entries are summed. If the
+// file cannot be read or is malformed, returns an empty SparseMatrix and sets error to a
+// description of the problem (error is cleared on success).
+SparseMatrix readMatrixMarketFile(const std::string& path, std::string& error, size_t numThreads=0);
+
+// Writes the stored elements as a real general coordinate file, formatting the numbers
+// into a fixed buffer which is written out as it fills up (the values are printed in the
+// shortest form which reads back to the same double). The matrix must have the default
+// value 0, which is implied for the elements missing from the file. Returns false if the
+// default value is not 0 or if the file cannot be written.
+bool writeMatrixMarketFile(const std::string& path, const SparseMatrix& sm);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,644 @@
+#ifndef MATRIX_VIEW_HPP
+#define MATRIX_VIEW_HPP
+
+#include <cassert>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "linalg_fwd.hpp"
+#include "matrix.hpp"
+#include "vectr.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+#include "templates_linalg.hpp"
+
+// Views refer to part of a matrix instead of copying it: a view of a Matrix is a block
+// of it, and a vector view is a row, column or diagonal of such a block. Writing through
+// a view writes into the matrix. A view of a constant matrix has a constant element type
+// (ConstMatrixView, ConstVectorView), and a view of a modifiable one converts to it.
+//
+// Views are cheap to copy, and stay valid as long as the matrix they refer to exists and
+// keeps its dimensions. The set...() methods write the result of a kernel into the view
+// and accept any vector or matrix like operand (including views and sparse objects), and
+// addProduct adds a product to what the view holds. The operands of a product must not
+// overlap the view written into, and the operands of the element-wise methods (assign,
+// setSum, setDifference, setScaled) must either be the view itself or not overlap it, as
+// elements shifted from their position would be read after being overwritten; either
+// fails an assertion when they are the same Matrix or views of it.
+
+// The rectangle of elements of a Matrix which an operand refers to, rows to endRow - 1
+// and columns to endColumn - 1 (the bounding rectangle for a column or a diagonal).
+// Operands which do not refer to a Matrix have no rows, and overlap nothing.
+struct MatrixViewExtent
+{
+    const void* rows;
+    size_t firstRow;
+    size_t endRow;
+    size_t firstColumn;
+    size_t endColumn;
+
+    bool overlaps(const MatrixViewExtent& e) const
+    {
+        return (rows != nullptr) && (rows == e.rows) && (firstRow < e.endRow) && (e.firstRow < endRow) &&
+               (firstColumn < e.endColumn) && (e.firstColumn < endColumn);
+    }
+
+    // Overlaps without being the same rectangle. For operands of the same size, which
+    // element-wise operations have, the same rectangle means the same elements.
+    bool overlapsShifted(const MatrixViewExtent& e) const
+    {
+        return overlaps(e) && ((firstRow != e.firstRow) || (endRow != e.endRow) || (firstColumn != e.firstColumn) || (endColumn != e.endColumn));
+    }
+};
+
+template <typename Operand>
+MatrixViewExtent getMatrixViewExtent(const Operand&)
+{
+    return MatrixViewExtent{nullptr, 0, 0, 0, 0};
+}
+
+template <typename T>
+MatrixViewExtent getMatrixViewExtent(const BasicMatrix<T>& m)
+{
+    return MatrixViewExtent{&m.getData(), 0, m.getNumRows(), 0, m.getNumColumns()};
+}
+
+template <typename T>
+MatrixViewExtent getMatrixViewExtent(const BasicMatrixView<T>& m)
+{
+    return m.getExtent();
+}
+
+template <typename T>
+MatrixViewExtent getMatrixViewExtent(const BasicVectorView<T>& v)
+{
+    return v.getExtent();
+}
+
+template <typename T>
+class BasicVectorView
+{
+    typedef typename std::remove_const<T>::type Element;
+    typedef typename std::conditional<std::is_const<T>::value, const LinalgArray<LinalgArray<Element> >, LinalgArray<LinalgArray<Element> > >::type Rows;
+    template <typename U> friend class BasicVectorView;
+
+    Rows* m_rows;
+    size_t m_firstRow;
+    size_t m_firstColumn;
+    size_t m_rowStep;
+    size_t m_columnStep;
+    size_t m_size;
+public:
+    // Element k is rows[firstRow + k * rowStep][firstColumn + k * columnStep], so the
+    // steps (0, 1), (1, 0) and (1, 1) give a row, a column and a diagonal.
+    BasicVectorView(Rows& rows, size_t firstRow, size_t firstColumn, size_t rowStep, size_t columnStep, size_t size)
+    :m_rows(&rows), m_firstRow(firstRow), m_firstColumn(firstColumn), m_rowStep(rowStep), m_columnStep(columnStep), m_size(size)
+    {
+    }
+
+    // Copy, or conversion of a view of a modifiable matrix to a constant view.
+    BasicVectorView(const BasicVectorView<Element>& v)
+    :m_rows(v.m_rows), m_firstRow(v.m_firstRow), m_firstColumn(v.m_firstColumn), m_rowStep(v.m_rowStep), m_columnStep(v.m_columnStep), m_size(v.m_size)
+    {
+    }
+
+    T& operator[](size_t k) const
+    {
+        return (*m_rows)[m_firstRow + k * m_rowStep][m_firstColumn + k * m_columnStep];
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    MatrixViewExtent getExtent() const
+    {
+        if(m_size == 0)
+        {
+            return MatrixViewExtent{m_rows, 0, 0, 0, 0};
+        }
+        return MatrixViewExtent{m_rows, m_firstRow, m_firstRow + (m_size - 1) * m_rowStep + 1, m_firstColumn, m_firstColumn + (m_size - 1) * m_columnStep + 1};
+    }
+
+    BasicVector<Element> getVector() const
+    {
+        LinalgArray<Element> r(m_size);
+        for(size_t k = 0; k < m_size; k++)
+        {
+            r[k] = (*this)[k];
+        }
+        return BasicVector<Element>(std::move(r));
+    }
+
+    std::string getText() const
+    {
+        return getVectorText(*this, m_size);
+    }
+
+    BasicVector<Element> operator+(const BasicVectorView<const Element>& v) const
+    {
+        assert(m_size == v.size());
+        return BasicVector<Element>(getVectorSum<Element>(*this, v, m_size));
+    }
+
+    BasicVector<Element> operator+(const BasicVector<Element>& v) const
+    {
+        assert(m_size == v.size());
+        return BasicVector<Element>(getVectorSum<Element>(*this, v, m_size));
+    }
+
+    BasicVector<Element> operator-(const BasicVectorView<const Element>& v) const
+    {
+        assert(m_size == v.size());
+        return BasicVector<Element>(getVectorDiff<Element>(*this, v, m_size));
+    }
+
+    BasicVector<Element> operator-(const BasicVector<Element>& v) const
+    {
+        assert(m_size == v.size());
+        return BasicVector<Element>(getVectorDiff<Element>(*this, v, m_size));
+    }
+
+    BasicVector<Element> operator*(Element c) const
+    {
+        LinalgArray<Element> r(m_size);
+        for(size_t k = 0; k < m_size; k++)
+        {
+            r[k] = (*this)[k] * c;
+        }
+        return BasicVector<Element>(std::move(r));
+    }
+
+    Element dot(const BasicVectorView<const Element>& v) const
+    {
+        assert(m_size == v.size());
+        return getDotProduct<Element>(*this, v, m_size);
+    }
+
+    Element dot(const BasicVector<Element>& v) const
+    {
+        assert(m_size == v.size());
+        return getDotProduct<Element>(*this, v, m_size);
+    }
+
+    // As a row vector being multiplied with a matrix.
+    BasicVector<Element> operator*(const BasicMatrixView<const Element>& m) const
+    {
+        assert(m_size == m.getNumRows());
+        return BasicVector<Element>(getVectorMatrixProduct<Element>(*this, m, m.getNumRows(), m.getNumColumns()));
+    }
+
+    template <typename VectorLike>
+    void assign(const VectorLike& v) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert(m_size == v.size());
+        assert(!getExtent().overlapsShifted(getMatrixViewExtent(v)));
+        for(size_t k = 0; k < m_size; k++)
+        {
+            (*this)[k] = v[k];
+        }
+    }
+
+    template <typename VectorLikeA, typename VectorLikeB>
+    void setSum(const VectorLikeA& a, const VectorLikeB& b) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_size == a.size()) && (m_size == b.size()));
+        assert(!getExtent().overlapsShifted(getMatrixViewExtent(a)) && !getExtent().overlapsShifted(getMatrixViewExtent(b)));
+        setVectorSum<Element>(*this, a, b, m_size);
+    }
+
+    template <typename VectorLikeA, typename VectorLikeB>
+    void setDifference(const VectorLikeA& a, const VectorLikeB& b) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_size == a.size()) && (m_size == b.size()));
+        assert(!getExtent().overlapsShifted(getMatrixViewExtent(a)) && !getExtent().overlapsShifted(getMatrixViewExtent(b)));
+        setVectorDiff<Element>(*this, a, b, m_size);
+    }
+
+    template <typename VectorLike>
+    void setScaled(const VectorLike& v, Element c) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert(m_size == v.size());
+        assert(!getExtent().overlapsShifted(getMatrixViewExtent(v)));
+        for(size_t k = 0; k < m_size; k++)
+        {
+            (*this)[k] = v[k] * c;
+        }
+    }
+
+    // m * v, with v as a column vector.
+    template <typename MatrixLike, typename VectorLike>
+    void setProduct(const MatrixLike& m, const VectorLike& v) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_size == m.getNumRows()) && (m.getNumColumns() == v.size()));
+        assert(!getExtent().overlaps(getMatrixViewExtent(m)) && !getExtent().overlaps(getMatrixViewExtent(v)));
+        setMatrixVectorProduct<Element>(*this, m, v, m.getNumRows(), m.getNumColumns());
+    }
+
+    // Adds c * m * v to the view; c = -1 subtracts the product.
+    template <typename MatrixLike, typename VectorLike>
+    void addProduct(const MatrixLike& m, const VectorLike& v, Element c=1) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_size == m.getNumRows()) && (m.getNumColumns() == v.size()));
+        assert(!getExtent().overlaps(getMatrixViewExtent(m)) && !getExtent().overlaps(getMatrixViewExtent(v)));
+        addMatrixVectorProduct<Element>(*this, m, v, m.getNumRows(), m.getNumColumns(), c);
+    }
+
+    // v * m, with v as a row vector.
+    template <typename VectorLike, typename MatrixLike>
+    void setLeftProduct(const VectorLike& v, const MatrixLike& m) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((v.size() == m.getNumRows()) && (m_size == m.getNumColumns()));
+        assert(!getExtent().overlaps(getMatrixViewExtent(v)) && !getExtent().overlaps(getMatrixViewExtent(m)));
+        setVectorMatrixProduct<Element>(*this, v, m, m.getNumRows(), m.getNumColumns());
+    }
+};
+
+template <typename T>
+class BasicMatrixView
+{
+    typedef typename std::remove_const<T>::type Element;
+    typedef typename std::conditional<std::is_const<T>::value, const LinalgArray<LinalgArray<Element> >, LinalgArray<LinalgArray<Element> > >::type Rows;
+    typedef typename std::conditional<std::is_const<T>::value, const BasicMatrix<Element>, BasicMatrix<Element> >::type MatrixType;
+    template <typename U> friend class BasicMatrixView;
+
+    Rows* m_rows;
+    size_t m_firstRow;
+    size_t m_firstColumn;
+    size_t m_numRows;
+    size_t m_numColumns;
+public:
+    // The whole matrix.
+    BasicMatrixView(MatrixType& m)
+    :m_rows(&m.m_data), m_firstRow(0), m_firstColumn(0), m_numRows(m.m_numRows), m_numColumns(m.m_numColumns)
+    {
+    }
+
+    BasicMatrixView(MatrixType& m, size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns)
+    :m_rows(&m.m_data), m_firstRow(firstRow), m_firstColumn(firstColumn), m_numRows(numRows), m_numColumns(numColumns)
+    {
+        assert((firstRow + numRows <= m.m_numRows) && (firstColumn + numColumns <= m.m_numColumns));
+    }
+
+    // Copy, or conversion of a view of a modifiable matrix to a constant view.
+    BasicMatrixView(const BasicMatrixView<Element>& m)
+    :m_rows(m.m_rows), m_firstRow(m.m_firstRow), m_firstColumn(m.m_firstColumn), m_numRows(m.m_numRows), m_numColumns(m.m_numColumns)
+    {
+    }
+
+    size_t getNumRows() const
+    {
+        return m_numRows;
+    }
+
+    size_t getNumColumns() const
+    {
+        return m_numColumns;
+    }
+
+    MatrixViewExtent getExtent() const
+    {
+        return MatrixViewExtent{m_rows, m_firstRow, m_firstRow + m_numRows, m_firstColumn, m_firstColumn + m_numColumns};
+    }
+
+    // The first element of row i of the view; the row continues contiguously.
+    T* operator[](size_t i) const
+    {
+        return (*m_rows)[m_firstRow + i].data() + m_firstColumn;
+    }
+
+    // Views of parts of this view, with positions relative to it.
+    BasicMatrixView getBlock(size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns) const
+    {
+        assert((firstRow + numRows <= m_numRows) && (firstColumn + numColumns <= m_numColumns));
+        BasicMatrixView r = (*this);
+        r.m_firstRow += firstRow;
+        r.m_firstColumn += firstColumn;
+        r.m_numRows = numRows;
+        r.m_numColumns = numColumns;
+        return r;
+    }
+
+    BasicMatrixView getRows(size_t firstRow, size_t numRows) const
+    {
+        return getBlock(firstRow, 0, numRows, m_numColumns);
+    }
+
+    BasicMatrixView getColumns(size_t firstColumn, size_t numColumns) const
+    {
+        return getBlock(0, firstColumn, m_numRows, numColumns);
+    }
+
+    BasicVectorView<T> getRow(size_t i) const
+    {
+        assert(i < m_numRows);
+        return BasicVectorView<T>(*m_rows, m_firstRow + i, m_firstColumn, 0, 1, m_numColumns);
+    }
+
+    BasicVectorView<T> getColumn(size_t j) const
+    {
+        assert(j < m_numColumns);
+        return BasicVectorView<T>(*m_rows, m_firstRow, m_firstColumn + j, 1, 0, m_numRows);
+    }
+
+    BasicVectorView<T> getDiagonal() const
+    {
+        size_t size = (m_numRows < m_numColumns) ? m_numRows : m_numColumns;
+        return BasicVectorView<T>(*m_rows, m_firstRow, m_firstColumn, 1, 1, size);
+    }
+
+    BasicMatrix<Element> getMatrix() const
+    {
+        LinalgArray<LinalgArray<Element> > r(m_numRows);
+        for(size_t i = 0; i < m_numRows; i++)
+        {
+            r[i].assign((*this)[i], (*this)[i] + m_numColumns);
+        }
+        return BasicMatrix<Element>(std::move(r));
+    }
+
+    std::string getText() const
+    {
+        return getMatrixText(*this, m_numRows, m_numColumns);
+    }
+
+    BasicMatrix<Element> operator+(const BasicMatrixView<const Element>& m) const
+    {
+        assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+        return BasicMatrix<Element>(getMatrixSum<Element>(*this, m, m_numRows, m_numColumns));
+    }
+
+    BasicMatrix<Element> operator-(const BasicMatrixView<const Element>& m) const
+    {
+        assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+        return BasicMatrix<Element>(getMatrixDiff<Element>(*this, m, m_numRows, m_numColumns));
+    }
+
+    BasicMatrix<Element> operator*(Element c) const
+    {
+        LinalgArray<LinalgArray<Element> > r(m_numRows, LinalgArray<Element>(m_numColumns));
+        for(size_t i = 0; i < m_numRows; i++)
+        {
+            const T* row = (*this)[i];
+            for(size_t j = 0; j < m_numColumns; j++)
+            {
+                r[i][j] = row[j] * c;
+            }
+        }
+        return BasicMatrix<Element>(std::move(r));
+    }
+
+    BasicMatrix<Element> operator*(const BasicMatrixView<const Element>& m) const
+    {
+        assert(m_numColumns == m.getNumRows());
+        return BasicMatrix<Element>(getMatrixMatrixProduct<Element>(*this, m, m_numRows, m_numColumns, m.getNumColumns()));
+    }
+
+    BasicVector<Element> operator*(const BasicVector<Element>& v) const
+    {
+        assert(m_numColumns == v.size());
+        return BasicVector<Element>(getMatrixVectorProduct<Element>(*this, v, m_numRows, m_numColumns));
+    }
+
+    BasicVector<Element> operator*(const BasicVectorView<const Element>& v) const
+    {
+        assert(m_numColumns == v.size());
+        return BasicVector<Element>(getMatrixVectorProduct<Element>(*this, v, m_numRows, m_numColumns));
+    }
+
+    template <typename MatrixLike>
+    void assign(const MatrixLike& m) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+        assert(!getExtent().overlapsShifted(getMatrixViewExtent(m)));
+        for(size_t i = 0; i < m_numRows; i++)
+        {
+            T* row = (*this)[i];
+            for(size_t j = 0; j < m_numColumns; j++)
+            {
+                row[j] = m[i][j];
+            }
+        }
+    }
+
+    template <typename MatrixLikeA, typename MatrixLikeB>
+    void setSum(const MatrixLikeA& a, const MatrixLikeB& b) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_numRows == a.getNumRows()) && (m_numColumns == a.getNumColumns()));
+        assert((m_numRows == b.getNumRows()) && (m_numColumns == b.getNumColumns()));
+        assert(!getExtent().overlapsShifted(getMatrixViewExtent(a)) && !getExtent().overlapsShifted(getMatrixViewExtent(b)));
+        setMatrixSum<Element>(*this, a, b, m_numRows, m_numColumns);
+    }
+
+    template <typename MatrixLikeA, typename MatrixLikeB>
+    void setDifference(const MatrixLikeA& a, const MatrixLikeB& b) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_numRows == a.getNumRows()) && (m_numColumns == a.getNumColumns()));
+        assert((m_numRows == b.getNumRows()) && (m_numColumns == b.getNumColumns()));
+        assert(!getExtent().overlapsShifted(getMatrixViewExtent(a)) && !getExtent().overlapsShifted(getMatrixViewExtent(b)));
+        setMatrixDiff<Element>(*this, a, b, m_numRows, m_numColumns);
+    }
+
+    template <typename MatrixLike>
+    void setScaled(const MatrixLike& m, Element c) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+        assert(!getExtent().overlapsShifted(getMatrixViewExtent(m)));
+        for(size_t i = 0; i < m_numRows; i++)
+        {
+            T* row = (*this)[i];
+            for(size_t j = 0; j < m_numColumns; j++)
+            {
+                row[j] = m[i][j] * c;
+            }
+        }
+    }
+
+    template <typename MatrixLikeA, typename MatrixLikeB>
+    void setProduct(const MatrixLikeA& a, const MatrixLikeB& b) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_numRows == a.getNumRows()) && (a.getNumColumns() == b.getNumRows()) && (m_numColumns == b.getNumColumns()));
+        assert(!getExtent().overlaps(getMatrixViewExtent(a)) && !getExtent().overlaps(getMatrixViewExtent(b)));
+        setMatrixMatrixProduct<Element>(*this, a, b, a.getNumRows(), a.getNumColumns(), b.getNumColumns());
+    }
+
+    // Adds c * a * b to the view, e.g. C -= A * B for blocks with c = -1.
+    template <typename MatrixLikeA, typename MatrixLikeB>
+    void addProduct(const MatrixLikeA& a, const MatrixLikeB& b, Element c=1) const
+    {
+        static_assert(!std::is_const<T>::value, "A view of a constant matrix cannot be written into");
+        assert((m_numRows == a.getNumRows()) && (a.getNumColumns() == b.getNumRows()) && (m_numColumns == b.getNumColumns()));
+        assert(!getExtent().overlaps(getMatrixViewExtent(a)) && !getExtent().overlaps(getMatrixViewExtent(b)));
+        addMatrixMatrixProduct<Element>(*this, a, b, a.getNumRows(), a.getNumColumns(), b.getNumColumns(), c);
+    }
+};
+
+// Read-only block of a SparseMatrix. Element (i, j) is looked up in the matrix, so the
+// view is an operand of the same kernels as the matrix itself.
+template <typename T>
+class BasicSparseMatrixView
+{
+    const BasicSparseMatrix<T>* m_matrix;
+    size_t m_firstRow;
+    size_t m_firstColumn;
+    size_t m_numRows;
+    size_t m_numColumns;
+public:
+    // Row of the view, shifted by its first column.
+    class Row
+    {
+        const BasicSparseVector<T>* m_row;
+        size_t m_firstColumn;
+    public:
+        Row(const BasicSparseVector<T>& row, size_t firstColumn)
+        :m_row(&row), m_firstColumn(firstColumn)
+        {
+        }
+
+        T operator[](size_t j) const
+        {
+            return (*m_row)[m_firstColumn + j];
+        }
+    };
+
+    BasicSparseMatrixView(const BasicSparseMatrix<T>& sm)
+    :m_matrix(&sm), m_firstRow(0), m_firstColumn(0), m_numRows(sm.getNumRows()), m_numColumns(sm.getNumColumns())
+    {
+    }
+
+    BasicSparseMatrixView(const BasicSparseMatrix<T>& sm, size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns)
+    :m_matrix(&sm), m_firstRow(firstRow), m_firstColumn(firstColumn), m_numRows(numRows), m_numColumns(numColumns)
+    {
+        assert((firstRow + numRows <= sm.getNumRows()) && (firstColumn + numColumns <= sm.getNumColumns()));
+    }
+
+    size_t getNumRows() const
+    {
+        return m_numRows;
+    }
+
+    size_t getNumColumns() const
+    {
+        return m_numColumns;
+    }
+
+    T getDefaultValue() const
+    {
+        return m_matrix->getDefaultValue();
+    }
+
+    Row operator[](size_t i) const
+    {
+        assert(i < m_numRows);
+        return Row((*m_matrix)[m_firstRow + i], m_firstColumn);
+    }
+
+    BasicSparseMatrixView getBlock(size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns) const
+    {
+        assert((firstRow + numRows <= m_numRows) && (firstColumn + numColumns <= m_numColumns));
+        return BasicSparseMatrixView(*m_matrix, m_firstRow + firstRow, m_firstColumn + firstColumn, numRows, numColumns);
+    }
+
+    // Copy of the stored elements inside the view, found by searching the rows of the
+    // matrix for the range of columns, so it takes time linear in their number.
+    BasicSparseMatrix<T> getSparseMatrix() const
+    {
+        std::vector<BasicSparseMatrixEntry<T> > entries = {};
+        const auto& rows = m_matrix->getData();
+        for(auto row = rows.lower_bound(m_firstRow); (row != rows.end()) && (row->first < m_firstRow + m_numRows); ++row)
+        {
+            const auto& data = row->second.getData();
+            for(auto e = data.lower_bound(m_firstColumn); (e != data.end()) && (e->first < m_firstColumn + m_numColumns); ++e)
+            {
+                entries.push_back(BasicSparseMatrixEntry<T>{row->first - m_firstRow, e->first - m_firstColumn, e->second});
+            }
+        }
+        return BasicSparseMatrix<T>(m_matrix->getDefaultValue(), m_numRows, m_numColumns, entries);
+    }
+
+    BasicMatrix<T> getMatrix() const
+    {
+        LinalgArray<LinalgArray<T> > r(m_numRows, LinalgArray<T>(m_numColumns));
+        for(size_t i = 0; i < m_numRows; i++)
+        {
+            Row row = (*this)[i];
+            for(size_t j = 0; j < m_numColumns; j++)
+            {
+                r[i][j] = row[j];
+            }
+        }
+        return BasicMatrix<T>(std::move(r));
+    }
+
+    BasicMatrix<T> operator+(const BasicMatrixView<const T>& m) const
+    {
+        assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+        return BasicMatrix<T>(getMatrixSum<T>(*this, m, m_numRows, m_numColumns));
+    }
+
+    BasicMatrix<T> operator-(const BasicMatrixView<const T>& m) const
+    {
+        assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+        return BasicMatrix<T>(getMatrixDiff<T>(*this, m, m_numRows, m_numColumns));
+    }
+
+    BasicSparseMatrix<T> operator+(const BasicSparseMatrixView& sm) const
+    {
+        return getSparseMatrix() + sm.getSparseMatrix();
+    }
+
+    BasicSparseMatrix<T> operator-(const BasicSparseMatrixView& sm) const
+    {
+        return getSparseMatrix() - sm.getSparseMatrix();
+    }
+
+    BasicSparseMatrix<T> operator*(T c) const
+    {
+        return getSparseMatrix() * c;
+    }
+
+    BasicMatrix<T> operator*(const BasicMatrixView<const T>& m) const
+    {
+        assert(m_numColumns == m.getNumRows());
+        return BasicMatrix<T>(getMatrixMatrixProduct<T>(*this, m, m_numRows, m_numColumns, m.getNumColumns()));
+    }
+
+    BasicMatrix<T> operator*(const BasicSparseMatrixView& sm) const
+    {
+        assert(m_numColumns == sm.getNumRows());
+        return BasicMatrix<T>(getMatrixMatrixProduct<T>(*this, sm, m_numRows, m_numColumns, sm.getNumColumns()));
+    }
+
+    BasicVector<T> operator*(const BasicVector<T>& v) const
+    {
+        assert(m_numColumns == v.size());
+        return BasicVector<T>(getMatrixVectorProduct<T>(*this, v, m_numRows, m_numColumns));
+    }
+
+    BasicVector<T> operator*(const BasicVectorView<const T>& v) const
+    {
+        assert(m_numColumns == v.size());
+        return BasicVector<T>(getMatrixVectorProduct<T>(*this, v, m_numRows, m_numColumns));
+    }
+
+    BasicVector<T> operator*(const BasicSparseVector<T>& sv) const
+    {
+        assert(m_numColumns == sv.size());
+        return BasicVector<T>(getMatrixVectorProduct<T>(*this, sv, m_numRows, m_numColumns));
+    }
+};
+
+#endif
\ No newline at end of file
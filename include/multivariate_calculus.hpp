@@ -0,0 +1,183 @@
+#ifndef MULTIVARIATE_CALCULUS_HPP
+#define MULTIVARIATE_CALCULUS_HPP
+
+#include <cassert>
+#include <vector>
+#include "calculus.hpp"
+#include "parallel.hpp"
+#include "vectr.hpp"
+#include "matrix.hpp"
+#include "sparse_matrix.hpp"
+
+// Finite difference gradients and Jacobians. The modes follow getDifferentiatedValue:
+// BACKWARD and FORWARD use the points x - dx and x + dx along with the base point x
+// (whose evaluation is shared by all the columns), and CENTRAL uses x - dx/2 and
+// x + dx/2. The perturbed points are evaluated on numThreads threads (0 uses all the
+// hardware threads), so the function must be safe to call concurrently.
+
+// Greedy distance-2 coloring of the columns of a sparsity pattern: two columns get
+// different colors whenever they have an explicitly stored (non-default) element in
+// the same row. Columns of the same color can thus be perturbed together, and their
+// derivatives separated again by row. Returns the color of every column, and sets
+// numColors.
+std::vector<size_t> getColumnColoring(const SparseMatrix& pattern, size_t& numColors);
+
+// Gradient of func: Vector -> double.
+template <typename Function>
+Vector getGradient(const Function& func, const Vector& x, double dx, int mode=DifferentialEnum::CENTRAL, size_t numThreads=0)
+{
+    double forwardOffset, backwardOffset;
+    getDifferentialOffsets(dx, mode, forwardOffset, backwardOffset);
+    size_t n = x.size();
+    double f0 = (mode == DifferentialEnum::CENTRAL) ? 0 : func(x);
+    std::vector<double> gradient(n, 0);
+    size_t numChunks = getNumThreads(numThreads);
+    numChunks = (n < numChunks) ? ((n > 0) ? n : 1) : numChunks;
+    runInParallel(n, numChunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        // Every thread perturbs its own copy of the point, one coordinate at a time.
+        Vector xp = x;
+        for(size_t j = chunkStart; j < chunkEnd; j++)
+        {
+            double fForward = f0, fBackward = f0;
+            if(forwardOffset != 0)
+            {
+                xp[j] = x[j] + forwardOffset;
+                fForward = func(xp);
+            }
+            if(backwardOffset != 0)
+            {
+                xp[j] = x[j] - backwardOffset;
+                fBackward = func(xp);
+            }
+            xp[j] = x[j];
+            gradient[j] = (fForward - fBackward) / dx;
+        }
+    });
+    return Vector(gradient);
+}
+
+// Jacobian of func: Vector -> Vector, as a Matrix with one row per output and one
+// column per input.
+template <typename Function>
+Matrix getJacobian(const Function& func, const Vector& x, double dx, int mode=DifferentialEnum::CENTRAL, size_t numThreads=0)
+{
+    double forwardOffset, backwardOffset;
+    getDifferentialOffsets(dx, mode, forwardOffset, backwardOffset);
+    size_t n = x.size();
+    // The base point is always evaluated once, as it also gives the number of outputs.
+    Vector f0 = func(x);
+    size_t m = f0.size();
+    std::vector<std::vector<double> > jacobian(m, std::vector<double>(n, 0));
+    size_t numChunks = getNumThreads(numThreads);
+    numChunks = (n < numChunks) ? ((n > 0) ? n : 1) : numChunks;
+    runInParallel(n, numChunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        Vector xp = x;
+        for(size_t j = chunkStart; j < chunkEnd; j++)
+        {
+            Vector fForward = f0, fBackward = f0;
+            if(forwardOffset != 0)
+            {
+                xp[j] = x[j] + forwardOffset;
+                fForward = func(xp);
+            }
+            if(backwardOffset != 0)
+            {
+                xp[j] = x[j] - backwardOffset;
+                fBackward = func(xp);
+            }
+            xp[j] = x[j];
+            assert((fForward.size() == m) && (fBackward.size() == m));
+            for(size_t i = 0; i < m; i++)
+            {
+                jacobian[i][j] = (fForward[i] - fBackward[i]) / dx;
+            }
+        }
+    });
+    return Matrix(jacobian);
+}
+
+// Jacobian of func: Vector -> Vector, whose sparsity pattern is given by the explicitly
+// stored elements of pattern (an m x n SparseMatrix, whose values are ignored). The
+// columns are colored (see getColumnColoring) and all the columns of a color are
+// perturbed at once, so the number of evaluations depends on the number of colors
+// rather than on n. Returns a SparseMatrix with default value 0.
+template <typename Function>
+SparseMatrix getSparseJacobian(const Function& func, const Vector& x, const SparseMatrix& pattern, double dx, int mode=DifferentialEnum::CENTRAL, size_t numThreads=0)
+{
+    assert(pattern.getNumColumns() == x.size());
+    double forwardOffset, backwardOffset;
+    getDifferentialOffsets(dx, mode, forwardOffset, backwardOffset);
+    size_t m = pattern.getNumRows();
+    size_t n = x.size();
+    size_t numColors = 0;
+    std::vector<size_t> colors = getColumnColoring(pattern, numColors);
+    std::vector<std::vector<size_t> > colorColumns(numColors);
+    for(size_t j = 0; j < n; j++)
+    {
+        colorColumns[colors[j]].push_back(j);
+    }
+    // Rows of the pattern which have an element in each column.
+    std::vector<std::vector<size_t> > columnRows(n);
+    for(size_t i = 0; i < m; i++)
+    {
+        for(const auto& e: pattern[i].getData())
+        {
+            columnRows[e.first].push_back(i);
+        }
+    }
+    Vector f0 = (mode == DifferentialEnum::CENTRAL) ? Vector() : func(x);
+    // Every color yields the derivatives of its columns, which are gathered in the
+    // results of the color and inserted into the SparseMatrix after the parallel part.
+    std::vector<std::vector<double> > colorValues(numColors);
+    size_t numChunks = getNumThreads(numThreads);
+    numChunks = (numColors < numChunks) ? ((numColors > 0) ? numColors : 1) : numChunks;
+    runInParallel(numColors, numChunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        Vector xp = x;
+        for(size_t c = chunkStart; c < chunkEnd; c++)
+        {
+            Vector fForward = f0, fBackward = f0;
+            if(forwardOffset != 0)
+            {
+                for(const auto& j: colorColumns[c])
+                {
+                    xp[j] = x[j] + forwardOffset;
+                }
+                fForward = func(xp);
+            }
+            if(backwardOffset != 0)
+            {
+                for(const auto& j: colorColumns[c])
+                {
+                    xp[j] = x[j] - backwardOffset;
+                }
+                fBackward = func(xp);
+            }
+            for(const auto& j: colorColumns[c])
+            {
+                xp[j] = x[j];
+                for(const auto& i: columnRows[j])
+                {
+                    colorValues[c].push_back((fForward[i] - fBackward[i]) / dx);
+                }
+            }
+        }
+    });
+    SparseMatrix jacobian(0, m, n);
+    for(size_t c = 0; c < numColors; c++)
+    {
+        size_t k = 0;
+        for(const auto& j: colorColumns[c])
+        {
+            for(const auto& i: columnRows[j])
+            {
+                jacobian[i][j] = colorValues[c][k++];
+            }
+        }
+    }
+    return jacobian;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,133 @@
+#ifndef NPY_IO_HPP
+#define NPY_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mapped_file.hpp"
+#include "linalg_fwd.hpp"
+
+// NumPy array files. A .npy file holds one array: the magic string "\x93NUMPY", the
+// format version, the length of the header and the header itself, a Python dictionary
+// literal such as
+//   {'descr': '<f8', 'fortran_order': False, 'shape': (3, 4), }
+// followed by the elements, by rows (C order) or by columns (Fortran order). A .npz file
+// (numpy.savez) is a zip archive with one .npy member per array.
+//
+// Only float32 and float64 arrays of up to 2 dimensions are supported, in either byte
+// order. The arrays are read in place from the mapped file, so opening them is
+// immediate and their elements are only read from disk when they are accessed.
+
+enum NpyDataTypeEnum {NPY_FLOAT32, NPY_FLOAT64};
+
+// A read-only view of an array in a mapped .npy or .npz file, which stays mapped as long
+// as any view of it does. A 1-dimensional array of n elements is seen as a 1 x n matrix,
+// and a 0-dimensional one as a 1 x 1 matrix.
+class NpyArray
+{
+    std::shared_ptr<MappedFile> m_file;
+    const char* m_data;
+    std::vector<size_t> m_shape;
+    NpyDataTypeEnum m_dataType;
+    bool m_isFortranOrder;
+    bool m_isByteSwapped;
+    size_t m_numRows;
+    size_t m_numColumns;
+public:
+    // Row i, whose element j is (i, j), so that the array can be used in place wherever
+    // a matrix is indexed as m[i][j] (the kernels of templates_linalg.hpp and the views).
+    class Row
+    {
+        const NpyArray* m_array;
+        size_t m_row;
+    public:
+        Row(const NpyArray& array, size_t row)
+        :m_array(&array), m_row(row)
+        {
+        }
+
+        double operator[](size_t j) const
+        {
+            return (*m_array)(m_row, j);
+        }
+    };
+
+    // An empty array.
+    NpyArray();
+    // Parses the .npy image of size bytes at data, which lies in file. If it is not a valid
+    // array of a supported kind, the array is left empty and error describes the problem
+    // (error is cleared on success).
+    NpyArray(const std::shared_ptr<MappedFile>& file, const char* data, size_t size, std::string& error);
+    const std::vector<size_t>& getShape() const;
+    size_t getNumDimensions() const;
+    size_t getNumRows() const;
+    size_t getNumColumns() const;
+    size_t size() const;
+    NpyDataTypeEnum getDataType() const;
+    bool isFortranOrder() const;
+    double operator()(size_t i, size_t j) const;
+    Row operator[](size_t i) const;
+    // Element k in the order of the file.
+    double getElement(size_t k) const;
+    // The elements in place, in the order of the file, if they have the given type, the
+    // byte order of this machine and a suitable alignment (members of a .npz file are
+    // not aligned); otherwise nullptr, and they have to be read one by one.
+    const double* getDoubleData() const;
+    const float* getFloatData() const;
+    // Copies the elements into a new Matrix (0 x 0 if the array has no rows), or into a
+    // Vector by rows.
+    Matrix getMatrix() const;
+    Vector getVector() const;
+};
+
+// Reads a .npy file. If it cannot be read or is not a supported array, returns an empty
+// array and sets error to a description of the problem (error is cleared on success).
+NpyArray readNpyFile(const std::string& path, std::string& error);
+// Writes a .npy file (format version 1.0), with the elements converted to the given type,
+// in C or Fortran order. A Vector is written as a 1-dimensional array. Returns false if
+// the file could not be written.
+bool writeNpyFile(const std::string& path, const Matrix& m, NpyDataTypeEnum dataType=NPY_FLOAT64, bool fortranOrder=false);
+bool writeNpyFile(const std::string& path, const Vector& v, NpyDataTypeEnum dataType=NPY_FLOAT64);
+
+// Reads the arrays of a .npz file, by name (without the .npy extension). The members
+// must be stored, as by numpy.savez; compressed ones (numpy.savez_compressed) cannot be
+// viewed in place and are reported as an error. On failure returns no arrays and sets
+// error to a description of the problem (error is cleared on success).
+std::map<std::string, NpyArray> readNpzFile(const std::string& path, std::string& error);
+
+// Writes a .npz file, one stored member per added array, like numpy.savez. The elements
+// are written as they are formatted, and the sizes and checksum of each member are
+// filled in afterwards. The archive is finished by close (or the destructor), which
+// returns false if anything could not be written. Members and archives of 4 GB or more
+// (which would need the zip64 extensions) are not supported, and make close fail.
+class NpzWriter
+{
+    struct Member
+    {
+        std::string name;
+        uint32_t crc;
+        uint64_t size;
+        uint64_t offset;
+    };
+    std::ofstream m_stream;
+    std::vector<Member> m_members;
+    bool m_isValid;
+    bool m_isClosed;
+    template <typename Getter>
+    bool add(const std::string& name, const std::vector<size_t>& shape, NpyDataTypeEnum dataType, bool fortranOrder, const Getter& getElement);
+public:
+    NpzWriter(const std::string& path);
+    NpzWriter(const NpzWriter&) = delete;
+    NpzWriter& operator=(const NpzWriter&) = delete;
+    ~NpzWriter();
+    // Adds the array name.npy; false if it could not be written.
+    bool add(const std::string& name, const Matrix& m, NpyDataTypeEnum dataType=NPY_FLOAT64, bool fortranOrder=false);
+    bool add(const std::string& name, const Vector& v, NpyDataTypeEnum dataType=NPY_FLOAT64);
+    bool close();
+};
+
+#endif
\ No newline at end of file
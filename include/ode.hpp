@@ -0,0 +1,396 @@
+#ifndef ODE_HPP
+#define ODE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "vectr.hpp"
+#include "matrix.hpp"
+
+// Explicit integrators for initial value problems dy/dt = f(t, y).
+//
+// For a single system, the state is a Vector and the right-hand side is evaluated as
+//   f(t, y, dydt)   with signature void(double, const Vector&, Vector&),
+// which must write the derivative into dydt (already sized) instead of returning a new
+// Vector. All the stage buffers are allocated once, when the integrator is created, so
+// taking a step does not allocate.
+//
+// The batched integrators advance numSystems independent systems of the same dimension
+// at once. Their state is a plain array in structure-of-arrays layout: component k of
+// system s is at y[k * numSystems + s], so each component of all the systems is
+// contiguous and the stage loops run over long unit-stride arrays. Their right-hand
+// side is evaluated as
+//   f(t, y, dydt, numSystems)   with signature void(double, const double*, double*, size_t).
+//
+// The Butcher tableau and step size control are implemented on raw arrays, and shared
+// by the single and batched versions.
+
+// out = y + h * sum_{j < s} a_{s, j} k_j, for the stages s = 1, ..., 6 of the
+// Dormand-Prince method; s = 6 gives the 5th order solution at t + h.
+void setDormandPrinceStage(size_t s, double* out, const double* y, double h, double* const* k, size_t n);
+double getDormandPrinceStageTime(size_t s);
+
+// Returns the largest, over the systems, of the RMS norm of the error estimate scaled by
+// absTolerance + relTolerance * max(|y|, |yNew|). errorSquares must have room for
+// numSystems values. A single system is the case numSystems = 1. A non-finite error
+// (an overflow, or a NaN returned by the system) gives an infinite norm, so the step is
+// rejected and retried with the smallest allowed step size; a step size too small to
+// advance t fails an assertion.
+double getDormandPrinceErrorNorm(const double* y, const double* yNew, double h, double* const* k, size_t dimension, size_t numSystems, double absTolerance, double relTolerance, double* errorSquares);
+
+// Sets up the 5 coefficient arrays of the 4th order continuous extension of an accepted
+// step from y to yNew, and evaluates it at the fraction theta of the step.
+void setDormandPrinceDenseOutput(double* dense, const double* y, const double* yNew, double h, double* const* k, size_t n);
+void getDormandPrinceDenseValue(double theta, const double* dense, double* out, size_t n);
+
+// Step size for the next attempt, from the current one and the error norm (1 meaning
+// exactly at the tolerance). The growth is limited after a rejected step.
+double getNextStepSize(double h, double errorNorm, bool rejected);
+double getInitialStepSize(const double* y, const double* dydt, size_t n, double absTolerance, double relTolerance);
+
+// Classical 4th order Runge-Kutta method with a fixed step size.
+class RK4Integrator
+{
+    size_t m_dimension;
+    Vector m_k1;
+    Vector m_k2;
+    Vector m_k3;
+    Vector m_k4;
+    Vector m_stage;
+public:
+    RK4Integrator(size_t dimension);
+
+    template <typename System>
+    void step(const System& f, double& t, Vector& y, double h)
+    {
+        assert(y.size() == m_dimension);
+        size_t n = m_dimension;
+        double* yp = &y[0];
+        double* stage = &m_stage[0];
+        const double* k1 = &m_k1[0];
+        const double* k2 = &m_k2[0];
+        const double* k3 = &m_k3[0];
+        const double* k4 = &m_k4[0];
+        f(t, static_cast<const Vector&>(y), m_k1);
+        for(size_t i = 0; i < n; i++)
+        {
+            stage[i] = yp[i] + 0.5 * h * k1[i];
+        }
+        f(t + 0.5 * h, static_cast<const Vector&>(m_stage), m_k2);
+        for(size_t i = 0; i < n; i++)
+        {
+            stage[i] = yp[i] + 0.5 * h * k2[i];
+        }
+        f(t + 0.5 * h, static_cast<const Vector&>(m_stage), m_k3);
+        for(size_t i = 0; i < n; i++)
+        {
+            stage[i] = yp[i] + h * k3[i];
+        }
+        f(t + h, static_cast<const Vector&>(m_stage), m_k4);
+        for(size_t i = 0; i < n; i++)
+        {
+            yp[i] += (h / 6) * (k1[i] + 2 * (k2[i] + k3[i]) + k4[i]);
+        }
+        t += h;
+    }
+
+    // Advances from t to tEnd in numSteps equal steps.
+    template <typename System>
+    void integrate(const System& f, double& t, Vector& y, double tEnd, size_t numSteps)
+    {
+        double t0 = t;
+        double h = (tEnd - t0) / numSteps;
+        for(size_t i = 0; i < numSteps; i++)
+        {
+            step(f, t, y, h);
+            // The time is recomputed from the step index so that it does not drift.
+            t = t0 + (i + 1) * h;
+        }
+    }
+};
+
+// Adaptive Dormand-Prince 5(4) method (as in Hairer's DOPRI5), with error control on
+// the 5th order solution and a 4th order dense output. The last stage of a step is the
+// first of the next one, so an accepted step costs 6 evaluations.
+class DormandPrinceIntegrator
+{
+    size_t m_dimension;
+    double m_absTolerance;
+    double m_relTolerance;
+    std::vector<Vector> m_k;
+    Vector m_stage;
+    Vector m_yNew;
+    std::vector<double> m_dense;
+    double m_tOld;
+    double m_h;
+    double m_hNext;
+    bool m_firstStageValid;
+    size_t m_numSteps;
+    size_t m_numRejectedSteps;
+    size_t m_numEvaluations;
+public:
+    DormandPrinceIntegrator(size_t dimension, double absTolerance=1.e-8, double relTolerance=1.e-8);
+    // Forgets the step size and the stored first stage; needed when y, t or f are
+    // changed between steps by anything other than the integrator.
+    void reset();
+
+    // Takes one accepted step from t, not going beyond tMax. Rejected attempts are
+    // retried with smaller steps.
+    template <typename System>
+    void step(const System& f, double& t, Vector& y, double tMax)
+    {
+        assert((y.size() == m_dimension) && (tMax > t));
+        size_t n = m_dimension;
+        double* k[7];
+        for(size_t s = 0; s < 7; s++)
+        {
+            k[s] = &m_k[s][0];
+        }
+        if(!m_firstStageValid)
+        {
+            f(t, static_cast<const Vector&>(y), m_k[0]);
+            m_numEvaluations++;
+            m_firstStageValid = true;
+        }
+        if(m_hNext <= 0)
+        {
+            m_hNext = getInitialStepSize(&y[0], k[0], n, m_absTolerance, m_relTolerance);
+        }
+        double* stage = &m_stage[0];
+        double* yNew = &m_yNew[0];
+        double errorSquare;
+        bool rejected = false;
+        while(true)
+        {
+            double h = (m_hNext < (tMax - t)) ? m_hNext : (tMax - t);
+            assert((t + h) != t);
+            for(size_t s = 1; s < 6; s++)
+            {
+                setDormandPrinceStage(s, stage, &y[0], h, k, n);
+                f(t + getDormandPrinceStageTime(s) * h, static_cast<const Vector&>(m_stage), m_k[s]);
+            }
+            setDormandPrinceStage(6, yNew, &y[0], h, k, n);
+            f(t + h, static_cast<const Vector&>(m_yNew), m_k[6]);
+            m_numEvaluations += 6;
+            double errorNorm = getDormandPrinceErrorNorm(&y[0], yNew, h, k, n, 1, m_absTolerance, m_relTolerance, &errorSquare);
+            if(errorNorm <= 1)
+            {
+                setDormandPrinceDenseOutput(m_dense.data(), &y[0], yNew, h, k, n);
+                m_tOld = t;
+                m_h = h;
+                t += h;
+                y = m_yNew;
+                // The derivative at the new point is the first stage of the next step.
+                std::swap(m_k[0], m_k[6]);
+                m_hNext = getNextStepSize(h, errorNorm, rejected);
+                m_numSteps++;
+                return;
+            }
+            m_numRejectedSteps++;
+            rejected = true;
+            m_hNext = getNextStepSize(h, errorNorm, rejected);
+        }
+    }
+
+    // Advances y from t to tEnd.
+    template <typename System>
+    void integrate(const System& f, double& t, Vector& y, double tEnd)
+    {
+        m_firstStageValid = false;
+        while(t < tEnd)
+        {
+            step(f, t, y, tEnd);
+        }
+    }
+
+    // Integrates from t0 and returns the solution at the (increasing) outputTimes as the
+    // rows of a Matrix. The outputs are interpolated with the dense output, so they do
+    // not restrict the step sizes.
+    template <typename System>
+    Matrix solve(const System& f, double t0, const Vector& y0, const std::vector<double>& outputTimes)
+    {
+        LinalgArray<LinalgArray<double> > r = {};
+        double t = t0;
+        Vector y = y0;
+        Vector yOut = y0;
+        size_t next = 0;
+        m_firstStageValid = false;
+        while((next < outputTimes.size()) && (outputTimes[next] <= t0))
+        {
+            r.push_back(y0.getData());
+            next++;
+        }
+        while(next < outputTimes.size())
+        {
+            step(f, t, y, outputTimes.back());
+            while((next < outputTimes.size()) && (outputTimes[next] <= t))
+            {
+                getDenseOutput(outputTimes[next], yOut);
+                r.push_back(yOut.getData());
+                next++;
+            }
+        }
+        return Matrix(std::move(r));
+    }
+
+    // Evaluates the continuous extension of the last accepted step at a time t within it.
+    void getDenseOutput(double t, Vector& y) const;
+    double getStepSize() const;
+    size_t getNumSteps() const;
+    size_t getNumRejectedSteps() const;
+    size_t getNumEvaluations() const;
+};
+
+// RK4 for numSystems systems in structure-of-arrays layout (see above).
+class BatchedRK4Integrator
+{
+    size_t m_dimension;
+    size_t m_numSystems;
+    std::vector<double> m_k;
+    std::vector<double> m_stage;
+public:
+    BatchedRK4Integrator(size_t dimension, size_t numSystems);
+
+    template <typename System>
+    void step(const System& f, double& t, double* y, double h)
+    {
+        size_t n = m_dimension * m_numSystems;
+        double* k1 = m_k.data();
+        double* k2 = k1 + n;
+        double* k3 = k2 + n;
+        double* k4 = k3 + n;
+        double* stage = m_stage.data();
+        f(t, static_cast<const double*>(y), k1, m_numSystems);
+        for(size_t i = 0; i < n; i++)
+        {
+            stage[i] = y[i] + 0.5 * h * k1[i];
+        }
+        f(t + 0.5 * h, static_cast<const double*>(stage), k2, m_numSystems);
+        for(size_t i = 0; i < n; i++)
+        {
+            stage[i] = y[i] + 0.5 * h * k2[i];
+        }
+        f(t + 0.5 * h, static_cast<const double*>(stage), k3, m_numSystems);
+        for(size_t i = 0; i < n; i++)
+        {
+            stage[i] = y[i] + h * k3[i];
+        }
+        f(t + h, static_cast<const double*>(stage), k4, m_numSystems);
+        for(size_t i = 0; i < n; i++)
+        {
+            y[i] += (h / 6) * (k1[i] + 2 * (k2[i] + k3[i]) + k4[i]);
+        }
+        t += h;
+    }
+
+    template <typename System>
+    void integrate(const System& f, double& t, double* y, double tEnd, size_t numSteps)
+    {
+        double t0 = t;
+        double h = (tEnd - t0) / numSteps;
+        for(size_t i = 0; i < numSteps; i++)
+        {
+            step(f, t, y, h);
+            t = t0 + (i + 1) * h;
+        }
+    }
+};
+
+// Dormand-Prince 5(4) for numSystems systems in structure-of-arrays layout. All the
+// systems share the time steps, whose size is controlled by the system with the largest
+// error, so every step is a set of whole-array operations.
+class BatchedDormandPrinceIntegrator
+{
+    size_t m_dimension;
+    size_t m_numSystems;
+    double m_absTolerance;
+    double m_relTolerance;
+    std::vector<double> m_k;
+    std::vector<double> m_stage;
+    std::vector<double> m_yNew;
+    std::vector<double> m_dense;
+    std::vector<double> m_errorSquares;
+    double m_tOld;
+    double m_h;
+    double m_hNext;
+    bool m_firstStageValid;
+    size_t m_numSteps;
+    size_t m_numRejectedSteps;
+public:
+    BatchedDormandPrinceIntegrator(size_t dimension, size_t numSystems, double absTolerance=1.e-8, double relTolerance=1.e-8);
+    void reset();
+
+    template <typename System>
+    void step(const System& f, double& t, double* y, double tMax)
+    {
+        assert(tMax > t);
+        size_t n = m_dimension * m_numSystems;
+        double* k[7];
+        for(size_t s = 0; s < 7; s++)
+        {
+            k[s] = m_k.data() + s * n;
+        }
+        if(!m_firstStageValid)
+        {
+            f(t, static_cast<const double*>(y), k[0], m_numSystems);
+            m_firstStageValid = true;
+        }
+        if(m_hNext <= 0)
+        {
+            m_hNext = getInitialStepSize(y, k[0], n, m_absTolerance, m_relTolerance);
+        }
+        bool rejected = false;
+        while(true)
+        {
+            double h = (m_hNext < (tMax - t)) ? m_hNext : (tMax - t);
+            assert((t + h) != t);
+            for(size_t s = 1; s < 6; s++)
+            {
+                setDormandPrinceStage(s, m_stage.data(), y, h, k, n);
+                f(t + getDormandPrinceStageTime(s) * h, static_cast<const double*>(m_stage.data()), k[s], m_numSystems);
+            }
+            setDormandPrinceStage(6, m_yNew.data(), y, h, k, n);
+            f(t + h, static_cast<const double*>(m_yNew.data()), k[6], m_numSystems);
+            double errorNorm = getDormandPrinceErrorNorm(y, m_yNew.data(), h, k, m_dimension, m_numSystems, m_absTolerance, m_relTolerance, m_errorSquares.data());
+            if(errorNorm <= 1)
+            {
+                setDormandPrinceDenseOutput(m_dense.data(), y, m_yNew.data(), h, k, n);
+                m_tOld = t;
+                m_h = h;
+                t += h;
+                for(size_t i = 0; i < n; i++)
+                {
+                    y[i] = m_yNew[i];
+                }
+                // FSAL: the last stage becomes the first stage of the next step.
+                for(size_t i = 0; i < n; i++)
+                {
+                    k[0][i] = k[6][i];
+                }
+                m_hNext = getNextStepSize(h, errorNorm, rejected);
+                m_numSteps++;
+                return;
+            }
+            m_numRejectedSteps++;
+            rejected = true;
+            m_hNext = getNextStepSize(h, errorNorm, rejected);
+        }
+    }
+
+    template <typename System>
+    void integrate(const System& f, double& t, double* y, double tEnd)
+    {
+        m_firstStageValid = false;
+        while(t < tEnd)
+        {
+            step(f, t, y, tEnd);
+        }
+    }
+
+    void getDenseOutput(double t, double* y) const;
+    size_t getNumSteps() const;
+    size_t getNumRejectedSteps() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,530 @@
+#ifndef OPTIMIZATION_HPP
+#define OPTIMIZATION_HPP
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "calculus.hpp"
+#include "multivariate_calculus.hpp"
+#include "vectr.hpp"
+
+// Root finding in one variable, and unconstrained minimization of smooth functions of a
+// Vector.
+//
+// The minimizers take the objective as a callable
+//   func(x, gradient)   with signature double(const Vector&, Vector&),
+// which returns the value at x and writes the gradient into the given (already sized)
+// Vector, so that an analytic or automatic gradient can be supplied; a function without
+// a gradient can be wrapped with getFiniteDifferenceObjective. The point x is improved
+// in place. All the vectors used by a minimizer live in a workspace, which is allocated
+// once and can be reused by later minimizations of the same dimension, so the iterations
+// (line searches included) do not allocate.
+
+struct RootFindingResult
+{
+    double root;
+    double value;
+    size_t numIterations;
+    bool converged;
+};
+
+struct OptimizationResult
+{
+    double value;
+    double gradientNorm;
+    size_t numIterations;
+    size_t numEvaluations;
+    bool converged;
+};
+
+// Minimizer of the cubic which interpolates the values and slopes (f0, d0) at a0 and
+// (f1, d1) at a1, kept at least a tenth of the interval away from either end; falls back
+// to the midpoint when the cubic has no minimizer.
+double getCubicStepLength(double a0, double f0, double d0, double a1, double f1, double d1);
+
+// y += a * x
+void addScaledVector(Vector& y, double a, const Vector& x);
+double getMaxNorm(const Vector& v);
+
+// Brent's method: inverse quadratic interpolation and secant steps, safeguarded by
+// bisection, on an interval [a, b] where func changes sign. Converges when the
+// bracketing interval is smaller than about 2 * tolerance.
+template <typename Function>
+RootFindingResult getBrentRoot(const Function& func, double a, double b, double tolerance=1.e-12, size_t maxIterations=100)
+{
+    double fa = func(a);
+    double fb = func(b);
+    assert(((fa <= 0) && (fb >= 0)) || ((fa >= 0) && (fb <= 0)));
+    double eps = std::numeric_limits<double>::epsilon();
+    double c = b, fc = fb;
+    double d = b - a, e = d;
+    for(size_t iteration = 0; iteration < maxIterations; iteration++)
+    {
+        if(((fb > 0) && (fc > 0)) || ((fb < 0) && (fc < 0)))
+        {
+            // Keep the root between b and c.
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if(fabs(fc) < fabs(fb))
+        {
+            // b is the best estimate so far.
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+        double tolerance1 = 2 * eps * fabs(b) + 0.5 * tolerance;
+        double xm = 0.5 * (c - b);
+        if((fabs(xm) <= tolerance1) || (fb == 0))
+        {
+            return {b, fb, iteration, true};
+        }
+        if((fabs(e) >= tolerance1) && (fabs(fa) > fabs(fb)))
+        {
+            double s = fb / fa;
+            double p, q;
+            if(a == c)
+            {
+                // Secant step.
+                p = 2 * xm * s;
+                q = 1 - s;
+            }
+            else
+            {
+                // Inverse quadratic interpolation.
+                double r = fb / fc;
+                q = fa / fc;
+                p = s * (2 * xm * q * (q - r) - (b - a) * (r - 1));
+                q = (q - 1) * (r - 1) * (s - 1);
+            }
+            if(p > 0)
+            {
+                q = -q;
+            }
+            p = fabs(p);
+            double bound1 = 3 * xm * q - fabs(tolerance1 * q);
+            double bound2 = fabs(e * q);
+            if(2 * p < ((bound1 < bound2) ? bound1 : bound2))
+            {
+                e = d;
+                d = p / q;
+            }
+            else
+            {
+                d = xm;
+                e = d;
+            }
+        }
+        else
+        {
+            d = xm;
+            e = d;
+        }
+        a = b;
+        fa = fb;
+        b += (fabs(d) > tolerance1) ? d : ((xm > 0) ? tolerance1 : -tolerance1);
+        fb = func(b);
+    }
+    return {b, fb, maxIterations, false};
+}
+
+// Newton's method with the given derivative. Converges when a step is smaller than
+// tolerance * (1 + |x|); stops without convergence if the derivative vanishes.
+template <typename Function, typename Derivative>
+RootFindingResult getNewtonRoot(const Function& func, const Derivative& derivative, double x, double tolerance=1.e-12, size_t maxIterations=100)
+{
+    double fx = func(x);
+    for(size_t iteration = 0; iteration < maxIterations; iteration++)
+    {
+        if(fx == 0)
+        {
+            return {x, fx, iteration, true};
+        }
+        double dfx = derivative(x);
+        if(dfx == 0)
+        {
+            return {x, fx, iteration, false};
+        }
+        double step = fx / dfx;
+        x -= step;
+        fx = func(x);
+        if(fabs(step) <= tolerance * (1 + fabs(x)))
+        {
+            return {x, fx, iteration + 1, true};
+        }
+    }
+    return {x, fx, maxIterations, false};
+}
+
+// Newton's method with the derivative approximated by central differences with step dx.
+template <typename Function>
+RootFindingResult getFiniteDifferenceNewtonRoot(const Function& func, double x, double dx=1.e-6, double tolerance=1.e-12, size_t maxIterations=100)
+{
+    auto derivative = [&func, dx](double t)
+    {
+        return getDifferentiatedValue(func, t, dx, DifferentialEnum::CENTRAL);
+    };
+    return getNewtonRoot(func, derivative, x, tolerance, maxIterations);
+}
+
+// Objective whose gradient is computed by finite differences of a function
+// double(const Vector&) (see getGradient). Unlike the minimizers, every evaluation
+// allocates the gradient it computes.
+template <typename Function>
+class FiniteDifferenceObjective
+{
+    Function m_func;
+    double m_dx;
+    size_t m_numThreads;
+public:
+    FiniteDifferenceObjective(const Function& func, double dx, size_t numThreads)
+    :m_func(func), m_dx(dx), m_numThreads(numThreads)
+    {
+    }
+
+    double operator()(const Vector& x, Vector& gradient) const
+    {
+        gradient = getGradient(m_func, x, m_dx, DifferentialEnum::CENTRAL, m_numThreads);
+        return m_func(x);
+    }
+};
+
+template <typename Function>
+FiniteDifferenceObjective<Function> getFiniteDifferenceObjective(const Function& func, double dx=1.e-6, size_t numThreads=1)
+{
+    return FiniteDifferenceObjective<Function>(func, dx, numThreads);
+}
+
+// Line search along direction from x, where the objective has the value fx and the
+// directional derivative slope (< 0), for a step length satisfying the strong Wolfe
+// conditions with constants c1 and c2 (bracketing, then zooming in with safeguarded cubic
+// interpolation). On success, returns the step length and leaves the accepted point, its
+// gradient and value in xTrial, gradientTrial and fTrial; returns 0 if no step is found
+// within maxEvaluations evaluations.
+template <typename Objective>
+double getWolfeStepLength(const Objective& func, const Vector& x, double fx, double slope, const Vector& direction, Vector& xTrial, Vector& gradientTrial, double& fTrial, double initialStep, size_t& numEvaluations, double c1=1.e-4, double c2=0.9, size_t maxEvaluations=40)
+{
+    size_t n = x.size();
+    auto evaluate = [&](double step)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            xTrial[i] = x[i] + step * direction[i];
+        }
+        fTrial = func(static_cast<const Vector&>(xTrial), gradientTrial);
+        numEvaluations++;
+        return gradientTrial.dot(direction);
+    };
+    // The interval [low, high] brackets acceptable steps once found; low always has the
+    // lowest value among the steps tried that satisfy the sufficient decrease condition.
+    double low = 0, fLow = fx, slopeLow = slope;
+    double high = 0, fHigh = fx, slopeHigh = slope;
+    bool bracketed = false;
+    double step = initialStep;
+    for(size_t evaluation = 0; evaluation < maxEvaluations; evaluation++)
+    {
+        if(bracketed)
+        {
+            step = getCubicStepLength(low, fLow, slopeLow, high, fHigh, slopeHigh);
+        }
+        double slopeTrial = evaluate(step);
+        if(!std::isfinite(fTrial) || (fTrial > fx + c1 * step * slope) || (fTrial >= fLow))
+        {
+            high = step;
+            fHigh = std::isfinite(fTrial) ? fTrial : std::numeric_limits<double>::max();
+            slopeHigh = std::isfinite(slopeTrial) ? slopeTrial : 0;
+            bracketed = true;
+            continue;
+        }
+        if(fabs(slopeTrial) <= -c2 * slope)
+        {
+            return step;
+        }
+        if(bracketed)
+        {
+            if(slopeTrial * (high - low) >= 0)
+            {
+                high = low;
+                fHigh = fLow;
+                slopeHigh = slopeLow;
+            }
+        }
+        else if(slopeTrial >= 0)
+        {
+            high = low;
+            fHigh = fLow;
+            slopeHigh = slopeLow;
+            bracketed = true;
+        }
+        low = step;
+        fLow = fTrial;
+        slopeLow = slopeTrial;
+        if(!bracketed)
+        {
+            step *= 2;
+        }
+    }
+    return 0;
+}
+
+struct LBFGSWorkspace
+{
+    // The last numCorrections steps s and gradient changes y, in a circular buffer.
+    std::vector<Vector> s;
+    std::vector<Vector> y;
+    std::vector<double> rho;
+    std::vector<double> alpha;
+    Vector gradient;
+    Vector direction;
+    Vector xTrial;
+    Vector gradientTrial;
+    LBFGSWorkspace(size_t dimension, size_t numCorrections=10);
+    size_t getDimension() const;
+};
+
+// Stores the curvature pair s = xNew - x, y = gradientNew - gradient in the slot after
+// newest, overwriting the oldest pair once numStored pairs fill the buffer, and updates
+// newest and numStored. A pair whose curvature s.y is not positive (up to round-off) is
+// not stored, and leaves the stored pairs as they were. Returns whether it was stored.
+bool addLBFGSCorrection(LBFGSWorkspace& workspace, const Vector& x, const Vector& xNew, const Vector& gradient, const Vector& gradientNew, size_t& newest, size_t& numStored);
+
+// Limited memory BFGS: the inverse Hessian is approximated from the last numCorrections
+// steps (two-loop recursion), and every step is taken by a Wolfe line search. Converges
+// when the largest component of the gradient is at most gradientTolerance.
+template <typename Objective>
+OptimizationResult getLBFGSMinimum(const Objective& func, Vector& x, LBFGSWorkspace& workspace, double gradientTolerance=1.e-8, size_t maxIterations=1000)
+{
+    size_t n = x.size();
+    assert(workspace.getDimension() == n);
+    size_t m = workspace.s.size();
+    Vector& gradient = workspace.gradient;
+    Vector& direction = workspace.direction;
+    OptimizationResult result = {func(static_cast<const Vector&>(x), gradient), 0, 0, 1, false};
+    size_t numStored = 0, newest = 0;
+    for(size_t iteration = 0; iteration < maxIterations; iteration++)
+    {
+        result.numIterations = iteration;
+        result.gradientNorm = getMaxNorm(gradient);
+        if(result.gradientNorm <= gradientTolerance)
+        {
+            result.converged = true;
+            return result;
+        }
+        // Two-loop recursion for direction = -H * gradient.
+        direction = gradient;
+        for(size_t k = 0; k < numStored; k++)
+        {
+            size_t i = (newest + m - k) % m;
+            workspace.alpha[i] = workspace.rho[i] * workspace.s[i].dot(direction);
+            addScaledVector(direction, -workspace.alpha[i], workspace.y[i]);
+        }
+        if(numStored > 0)
+        {
+            // Initial Hessian approximation gamma * I, from the newest pair.
+            double gamma = workspace.s[newest].dot(workspace.y[newest]) / workspace.y[newest].dot(workspace.y[newest]);
+            for(size_t i = 0; i < n; i++)
+            {
+                direction[i] *= gamma;
+            }
+        }
+        for(size_t k = numStored; k > 0; k--)
+        {
+            size_t i = (newest + m - k + 1) % m;
+            double beta = workspace.rho[i] * workspace.y[i].dot(direction);
+            addScaledVector(direction, workspace.alpha[i] - beta, workspace.s[i]);
+        }
+        for(size_t i = 0; i < n; i++)
+        {
+            direction[i] = -direction[i];
+        }
+        double slope = gradient.dot(direction);
+        if(!(slope < 0))
+        {
+            // Not a descent direction (round-off): restart from steepest descent.
+            numStored = 0;
+            for(size_t i = 0; i < n; i++)
+            {
+                direction[i] = -gradient[i];
+            }
+            slope = -gradient.dot(gradient);
+        }
+        double initialStep = (numStored == 0) ? ((result.gradientNorm > 1) ? 1 / result.gradientNorm : 1.0) : 1.0;
+        double fTrial;
+        double step = getWolfeStepLength(func, x, result.value, slope, direction, workspace.xTrial, workspace.gradientTrial, fTrial, initialStep, result.numEvaluations);
+        if(step == 0)
+        {
+            if(numStored == 0)
+            {
+                return result;
+            }
+            // Discard the curvature pairs and retry from steepest descent.
+            numStored = 0;
+            continue;
+        }
+        addLBFGSCorrection(workspace, x, workspace.xTrial, gradient, workspace.gradientTrial, newest, numStored);
+        x = workspace.xTrial;
+        gradient = workspace.gradientTrial;
+        result.value = fTrial;
+    }
+    result.numIterations = maxIterations;
+    result.gradientNorm = getMaxNorm(gradient);
+    result.converged = (result.gradientNorm <= gradientTolerance);
+    return result;
+}
+
+template <typename Objective>
+OptimizationResult getLBFGSMinimum(const Objective& func, Vector& x, double gradientTolerance=1.e-8, size_t maxIterations=1000)
+{
+    LBFGSWorkspace workspace(x.size());
+    return getLBFGSMinimum(func, x, workspace, gradientTolerance, maxIterations);
+}
+
+struct NewtonCGWorkspace
+{
+    Vector gradient;
+    Vector direction;
+    Vector residual;
+    Vector conjugate;
+    Vector hessianConjugate;
+    Vector xTrial;
+    Vector gradientTrial;
+    NewtonCGWorkspace(size_t dimension);
+    size_t getDimension() const;
+};
+
+// Truncated Newton method: the Newton step is solved for approximately by conjugate
+// gradients, with the relative tolerance min(0.5, |g|) * |g|, stopping early at
+// directions of negative curvature, and taken by a Wolfe line search. The Hessian is
+// only used through products
+//   hessianProduct(x, v, hv)   with signature void(const Vector&, const Vector&, Vector&),
+// which must write the Hessian at x times v into hv. Converges when the largest
+// component of the gradient is at most gradientTolerance.
+template <typename Objective, typename HessianProduct>
+OptimizationResult getNewtonCGMinimum(const Objective& func, const HessianProduct& hessianProduct, Vector& x, NewtonCGWorkspace& workspace, double gradientTolerance=1.e-8, size_t maxIterations=1000)
+{
+    size_t n = x.size();
+    assert(workspace.getDimension() == n);
+    Vector& gradient = workspace.gradient;
+    Vector& direction = workspace.direction;
+    Vector& residual = workspace.residual;
+    Vector& conjugate = workspace.conjugate;
+    Vector& hessianConjugate = workspace.hessianConjugate;
+    OptimizationResult result = {func(static_cast<const Vector&>(x), gradient), 0, 0, 1, false};
+    for(size_t iteration = 0; iteration < maxIterations; iteration++)
+    {
+        result.numIterations = iteration;
+        result.gradientNorm = getMaxNorm(gradient);
+        if(result.gradientNorm <= gradientTolerance)
+        {
+            result.converged = true;
+            return result;
+        }
+        // Conjugate gradients for hessian * direction = -gradient, from direction = 0.
+        double gradientSquare = gradient.dot(gradient);
+        // The forcing term min(0.5, |g|) tightens the tolerance as the gradient vanishes,
+        // which gives quadratic convergence near the minimum.
+        double forcing = sqrt(gradientSquare);
+        forcing = (forcing < 0.5) ? forcing : 0.5;
+        double residualTolerance = forcing * forcing * gradientSquare;
+        for(size_t i = 0; i < n; i++)
+        {
+            direction[i] = 0;
+            residual[i] = -gradient[i];
+            conjugate[i] = -gradient[i];
+        }
+        double residualSquare = gradientSquare;
+        for(size_t cgIteration = 0; cgIteration < 2 * n; cgIteration++)
+        {
+            hessianProduct(static_cast<const Vector&>(x), static_cast<const Vector&>(conjugate), hessianConjugate);
+            double curvature = conjugate.dot(hessianConjugate);
+            if(curvature <= 0)
+            {
+                if(cgIteration == 0)
+                {
+                    direction = conjugate;
+                }
+                break;
+            }
+            double a = residualSquare / curvature;
+            addScaledVector(direction, a, conjugate);
+            addScaledVector(residual, -a, hessianConjugate);
+            double newResidualSquare = residual.dot(residual);
+            if(newResidualSquare <= residualTolerance)
+            {
+                break;
+            }
+            double b = newResidualSquare / residualSquare;
+            residualSquare = newResidualSquare;
+            for(size_t i = 0; i < n; i++)
+            {
+                conjugate[i] = residual[i] + b * conjugate[i];
+            }
+        }
+        double slope = gradient.dot(direction);
+        if(!(slope < 0))
+        {
+            for(size_t i = 0; i < n; i++)
+            {
+                direction[i] = -gradient[i];
+            }
+            slope = -gradientSquare;
+        }
+        double fTrial;
+        double step = getWolfeStepLength(func, x, result.value, slope, direction, workspace.xTrial, workspace.gradientTrial, fTrial, 1.0, result.numEvaluations);
+        if(step == 0)
+        {
+            return result;
+        }
+        x = workspace.xTrial;
+        gradient = workspace.gradientTrial;
+        result.value = fTrial;
+    }
+    result.numIterations = maxIterations;
+    result.gradientNorm = getMaxNorm(gradient);
+    result.converged = (result.gradientNorm <= gradientTolerance);
+    return result;
+}
+
+// Truncated Newton method with Hessian products approximated by forward differences of
+// the gradient, (g(x + h v) - g(x)) / h, which cost one evaluation of the objective each.
+template <typename Objective>
+OptimizationResult getNewtonCGMinimum(const Objective& func, Vector& x, NewtonCGWorkspace& workspace, double gradientTolerance=1.e-8, size_t maxIterations=1000)
+{
+    size_t n = x.size();
+    // The gradient at x is in workspace.gradient whenever a product is needed, and the
+    // trial buffers are free until the line search.
+    size_t numProducts = 0;
+    auto hessianProduct = [&](const Vector& point, const Vector& v, Vector& hv)
+    {
+        double vNorm = sqrt(v.dot(v));
+        double h = sqrt(std::numeric_limits<double>::epsilon()) * (1 + sqrt(point.dot(point))) / vNorm;
+        for(size_t i = 0; i < n; i++)
+        {
+            workspace.xTrial[i] = point[i] + h * v[i];
+        }
+        func(static_cast<const Vector&>(workspace.xTrial), workspace.gradientTrial);
+        numProducts++;
+        for(size_t i = 0; i < n; i++)
+        {
+            hv[i] = (workspace.gradientTrial[i] - workspace.gradient[i]) / h;
+        }
+    };
+    OptimizationResult result = getNewtonCGMinimum(func, hessianProduct, x, workspace, gradientTolerance, maxIterations);
+    result.numEvaluations += numProducts;
+    return result;
+}
+
+template <typename Objective>
+OptimizationResult getNewtonCGMinimum(const Objective& func, Vector& x, double gradientTolerance=1.e-8, size_t maxIterations=1000)
+{
+    NewtonCGWorkspace workspace(x.size());
+    return getNewtonCGMinimum(func, x, workspace, gradientTolerance, maxIterations);
+}
+
+#endif
\ No newline at end of file
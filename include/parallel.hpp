@@ -0,0 +1,42 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Returns numThreads itself, or the number of hardware threads if numThreads is 0.
+size_t getNumThreads(size_t numThreads=0);
+
+// Returns the start of the chunk with index chunkIndex, when the range [0, numItems)
+// is split into numChunks contiguous chunks of (nearly) equal sizes.
+size_t getChunkStart(size_t numItems, size_t numChunks, size_t chunkIndex);
+
+// Splits the range [0, numItems) into numChunks contiguous chunks and calls
+// func(chunkIndex, chunkStart, chunkEnd) for every chunk, each on its own thread.
+// The partitioning depends only on numItems and numChunks, so a caller which combines
+// the per-chunk results in chunk order gets the same result on every run.
+template <typename Function>
+void runInParallel(size_t numItems, size_t numChunks, const Function& func)
+{
+    if(numChunks == 0)
+    {
+        return;
+    }
+    std::vector<std::thread> threads = {};
+    threads.reserve(numChunks - 1);
+    for(size_t c = 1; c < numChunks; c++)
+    {
+        size_t chunkStart = getChunkStart(numItems, numChunks, c);
+        size_t chunkEnd = getChunkStart(numItems, numChunks, c + 1);
+        threads.push_back(std::thread([&func, c, chunkStart, chunkEnd]() { func(c, chunkStart, chunkEnd); }));
+    }
+    // The first chunk is processed on the calling thread.
+    func(0, 0, getChunkStart(numItems, numChunks, 1));
+    for(auto& t: threads)
+    {
+        t.join();
+    }
+}
+
+#endif
\ No newline at end of file
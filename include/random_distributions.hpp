@@ -0,0 +1,60 @@
+#ifndef RANDOM_DISTRIBUTIONS_HPP
+#define RANDOM_DISTRIBUTIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "linalg_fwd.hpp"
+
+class RandomStream;
+
+// Bulk sampling of non-uniform distributions from the counter-based streams of
+// random_generator.hpp. Every sample is a fixed function of its index in the stream (the
+// samples with indices 2k and 2k + 1 of a normal distribution are the two outputs of one
+// Box-Muller transform, for example), so the samples can be generated in any order and
+// split between any number of threads without changing them.
+
+enum DistributionEnum {UNIFORM, NORMAL, LOG_NORMAL, EXPONENTIAL, GAMMA, BERNOULLI};
+
+class RandomDistribution
+{
+    DistributionEnum m_type;
+    double m_a;
+    double m_b;
+    RandomDistribution(DistributionEnum type, double a, double b);
+    // Index of the first sample whose positions in the stream are all unused, and
+    // advancing the stream past count samples from there.
+    uint64_t getFirstIndex(const RandomStream& stream) const;
+    void skip(RandomStream& stream, uint64_t first, uint64_t count) const;
+public:
+    static RandomDistribution getUniform(double start=0, double end=1);
+    static RandomDistribution getNormal(double mean=0, double standardDeviation=1);
+    // exp(X), where X is normal with the given mean and standard deviation.
+    static RandomDistribution getLogNormal(double mean=0, double standardDeviation=1);
+    static RandomDistribution getExponential(double rate=1);
+    static RandomDistribution getGamma(double shape, double scale=1);
+    // 1 with probability p, else 0.
+    static RandomDistribution getBernoulli(double p);
+    DistributionEnum getType() const;
+    // Number of stream positions reserved for each sample.
+    uint64_t getStride() const;
+
+    // Fills out[0], ..., out[count - 1] with the samples with indices first, ...,
+    // first + count - 1 of the given stream.
+    void fill(uint64_t seed, uint64_t stream, uint64_t first, double* out, size_t count) const;
+    // Fills with the next count samples of the stream, on numThreads threads (0 uses all
+    // the hardware threads), and advances the stream past them.
+    void fill(RandomStream& stream, double* out, size_t count, size_t numThreads=1) const;
+    // Fills an existing Vector, or Matrix in row-major order.
+    void fill(RandomStream& stream, Vector& v, size_t numThreads=0) const;
+    void fill(RandomStream& stream, Matrix& m, size_t numThreads=0) const;
+};
+
+Vector getRandomVector(size_t vectorSize, const RandomDistribution& distribution, RandomStream& stream, size_t numThreads=0);
+Matrix getRandomMatrix(size_t numRows, size_t numColumns, const RandomDistribution& distribution, RandomStream& stream, size_t numThreads=0);
+
+// numSamples samples (one per row) of the multivariate normal distribution with the given
+// mean and the covariance L * L^T, where L is the lower triangular choleskyFactor (see
+// Matrix::getCholeskyFactor).
+Matrix getMultivariateNormalMatrix(size_t numSamples, const Vector& mean, const Matrix& choleskyFactor, RandomStream& stream, size_t numThreads=0);
+
+#endif
\ No newline at end of file
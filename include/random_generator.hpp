@@ -0,0 +1,72 @@
+#ifndef RANDOM_GENERATOR_HPP
+#define RANDOM_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Counter-based pseudo-random numbers (Philox4x32-10). The numbers are not produced by
+// advancing a hidden state: the i-th 64-bit word of a stream is a fixed function of the
+// seed, the stream number and i. Any range of a stream can therefore be generated
+// independently of the others, so a stream can be split between any number of threads
+// and still give the same numbers, and different streams (one per thread, say) never
+// overlap.
+
+// Philox4x32 with 10 rounds: encrypts the 128-bit counter with the 64-bit key.
+void getPhiloxBlock(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+// Fills out[0], ..., out[count - 1] with the words position, ..., position + count - 1 of
+// the given stream, as doubles uniformly distributed in [start, end) (53 random bits
+// each).
+void fillUniform(uint64_t seed, uint64_t stream, uint64_t position, double* out, size_t count, double start=0, double end=1);
+
+// A stream of random numbers, identified by a seed and a stream number, together with the
+// position of its next word. It also meets the requirements of a uniform random bit
+// generator, so it can drive the distributions of <random>.
+class RandomStream
+{
+    uint64_t m_seed;
+    uint64_t m_stream;
+    uint64_t m_position;
+    // The block containing the words m_bufferBlock * 2 and m_bufferBlock * 2 + 1.
+    uint64_t m_bufferBlock;
+    uint64_t m_buffer[2];
+    uint64_t getWord();
+public:
+    typedef uint64_t result_type;
+    RandomStream(uint64_t seed=0, uint64_t stream=0);
+
+    // Uniform in [0, 1), or in [start, end).
+    double getUniform();
+    double getUniform(double start, double end);
+    // Uniform 64-bit integers.
+    uint64_t getInteger();
+    uint64_t operator()();
+    static constexpr uint64_t min()
+    {
+        return 0;
+    }
+    static constexpr uint64_t max()
+    {
+        return UINT64_MAX;
+    }
+
+    // Bulk generation of the next count numbers, uniform in [start, end), on numThreads
+    // threads (0 uses all the hardware threads). The result does not depend on the number
+    // of threads, and is the same as count calls of getUniform(start, end).
+    void fill(double* out, size_t count, double start=0, double end=1, size_t numThreads=1);
+
+    uint64_t getSeed() const;
+    uint64_t getStream() const;
+    uint64_t getPosition() const;
+    void setPosition(uint64_t position);
+    void skip(uint64_t count);
+};
+
+// Sets the seed of the streams used by getRandom. Every thread draws from its own stream,
+// numbered in the order in which the threads first call getRandom after the seed is set.
+void setRandomSeed(uint64_t seed);
+uint64_t getRandomSeed();
+// The stream used by getRandom on the calling thread.
+RandomStream& getThreadRandomStream();
+
+#endif
\ No newline at end of file
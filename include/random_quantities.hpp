@@ -2,12 +2,45 @@
 #define RANDOM_QUANTITIES_HPP
 
 #include <cstddef>
+#include "linalg_fwd.hpp"
 
-class Matrix;
-class Vector;
+class RandomStream;
 
+// Uniform in [start, end), from the random stream of the calling thread (see
+// random_generator.hpp).
 double getRandom(double start=0, double end=1);
+
+// Random matrices and vectors, uniform in [start, end), generated on numThreads threads
+// (0 uses all the hardware threads). The elements are taken, in row-major order, from
+// the next numbers of the given stream, which is advanced past them; every thread
+// generates its own rows directly from their positions in the stream, so the result
+// depends only on the stream and not on the number of threads. The overloads without
+// a stream use the stream of the calling thread.
+Matrix getRandomMatrix(size_t numRows, size_t numColumns, double start, double end, RandomStream& stream, size_t numThreads=0);
+Vector getRandomVector(size_t vectorSize, double start, double end, RandomStream& stream, size_t numThreads=0);
 Matrix getRandomMatrix(size_t numRows, size_t numColumns, double start=0, double end=1);
 Vector getRandomVector(size_t vectorSize, double start=0, double end=1);
 
+// Random sparse vectors and matrices with the given default value, whose explicitly
+// stored elements are uniform in [start, end). They are built directly from sorted
+// entries, rather than by inserting element by element. As above, the rows are generated
+// in parallel from their own ranges of the stream, so the result depends only on the
+// stream.
+
+// Every element is stored with the same probability, so that numNonDefault elements are
+// stored on average.
+SparseVector getRandomSparseVector(size_t vectorSize, size_t numNonDefault, double defaultValue, double start, double end, RandomStream& stream);
+SparseMatrix getRandomSparseMatrix(size_t numRows, size_t numColumns, size_t numNonDefault, double defaultValue, double start, double end, RandomStream& stream, size_t numThreads=0);
+// All the elements (i, j) with i - lowerBandwidth <= j <= i + upperBandwidth are stored.
+SparseMatrix getRandomBandedMatrix(size_t numRows, size_t numColumns, size_t lowerBandwidth, size_t upperBandwidth, double defaultValue, double start, double end, RandomStream& stream, size_t numThreads=0);
+// Recursive matrix (R-MAT) model of power-law graphs: a 2^scale x 2^scale matrix with
+// numEdges elements, each placed by recursively choosing one of the 4 quadrants with
+// probabilities a, b, c and 1 - a - b - c. Edges which land on the same element are
+// stored once, so there may be slightly fewer than numEdges elements.
+SparseMatrix getRMATMatrix(size_t scale, size_t numEdges, double a, double b, double c, double defaultValue, double start, double end, RandomStream& stream, size_t numThreads=0);
+// Symmetric positive definite matrix with default value 0 and about numNonDefault stored
+// elements: random symmetric off-diagonal elements, and a diagonal which makes every row
+// strictly diagonally dominant.
+SparseMatrix getRandomSPDMatrix(size_t size, size_t numNonDefault, double start, double end, RandomStream& stream, size_t numThreads=0);
+
 #endif
\ No newline at end of file
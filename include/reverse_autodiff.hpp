@@ -0,0 +1,153 @@
+#ifndef REVERSE_AUTODIFF_HPP
+#define REVERSE_AUTODIFF_HPP
+
+#include <cstddef>
+#include <vector>
+#include "arena.hpp"
+#include "linalg_fwd.hpp"
+
+class AdTape;
+
+// Scalar variable recorded on a tape. It only holds the index of its value (and
+// adjoint) in the tape, so it is cheap to copy.
+class AdVar
+{
+    AdTape* m_tape;
+    size_t m_index;
+public:
+    AdVar(AdTape* tape=nullptr, size_t index=0);
+    AdTape* getTape() const;
+    size_t getIndex() const;
+    double getValue() const;
+    double getAdjoint() const;
+
+    AdVar operator-() const;
+    AdVar operator+(const AdVar& v) const;
+    AdVar operator-(const AdVar& v) const;
+    AdVar operator*(const AdVar& v) const;
+    AdVar operator/(const AdVar& v) const;
+    AdVar operator+(double c) const;
+    AdVar operator-(double c) const;
+    AdVar operator*(double c) const;
+    AdVar operator/(double c) const;
+};
+
+AdVar operator+(double c, const AdVar& v);
+AdVar operator-(double c, const AdVar& v);
+AdVar operator*(double c, const AdVar& v);
+AdVar operator/(double c, const AdVar& v);
+AdVar sin(const AdVar& v);
+AdVar cos(const AdVar& v);
+AdVar exp(const AdVar& v);
+AdVar log(const AdVar& v);
+AdVar sqrt(const AdVar& v);
+AdVar tanh(const AdVar& v);
+AdVar pow(const AdVar& v, double p);
+
+// Vector of variables stored contiguously on a tape.
+class AdVector
+{
+    AdTape* m_tape;
+    size_t m_offset;
+    size_t m_size;
+public:
+    AdVector(AdTape* tape=nullptr, size_t offset=0, size_t size=0);
+    AdVar operator[](size_t i) const;
+    AdTape* getTape() const;
+    size_t size() const;
+    size_t getOffset() const;
+    Vector getValue() const;
+    Vector getGradient() const;
+
+    // Addition and subtraction methods
+    AdVector operator+(const AdVector& v) const;
+    AdVector operator-(const AdVector& v) const;
+    AdVector operator+(const Vector& v) const;
+    AdVector operator-(const Vector& v) const;
+
+    // Multiplication methods
+    AdVector operator*(double c) const;
+    AdVar dot(const AdVector& v) const;
+    AdVar dot(const Vector& v) const;
+    AdVar getSum() const;
+};
+
+// Element-wise functions of vectors, which record a single operation for the whole
+// vector instead of one per element.
+AdVector exp(const AdVector& v);
+AdVector tanh(const AdVector& v);
+
+// Row-major matrix of variables stored contiguously on a tape.
+class AdMatrix
+{
+    AdTape* m_tape;
+    size_t m_offset;
+    size_t m_numRows;
+    size_t m_numColumns;
+public:
+    AdMatrix(AdTape* tape=nullptr, size_t offset=0, size_t numRows=0, size_t numColumns=0);
+    AdVar operator()(size_t i, size_t j) const;
+    AdTape* getTape() const;
+    size_t getNumRows() const;
+    size_t getNumColumns() const;
+    size_t getOffset() const;
+    Matrix getValue() const;
+    Matrix getGradient() const;
+
+    AdMatrix operator*(const AdMatrix& m) const;
+    AdVector operator*(const AdVector& v) const;
+};
+
+AdVector operator*(const Matrix& m, const AdVector& v);
+
+// Records the operations performed on its variables, and computes the adjoints of all
+// the variables with respect to one output in a single reverse sweep. Operations on
+// vectors and matrices (dot, matrix-vector and matrix-matrix products) are recorded
+// as single entries whose adjoints are computed with whole-array loops, so the reverse
+// sweep costs a small constant multiple of the forward evaluation.
+//
+// A tape is meant to be reused: clear() forgets the recorded operations but keeps all
+// the memory, so repeated evaluations (e.g. the iterations of a training loop) do not
+// allocate once the tape has grown to its working size.
+class AdTape
+{
+public:
+    // backward(data, values, adjoints) propagates the adjoints of an operation's
+    // results to its operands.
+    typedef void (*BackwardFunction)(const void* data, const double* values, double* adjoints);
+private:
+    struct Operation
+    {
+        BackwardFunction backward;
+        const void* data;
+    };
+    Arena m_arena;
+    std::vector<double> m_values;
+    std::vector<double> m_adjoints;
+    std::vector<Operation> m_operations;
+public:
+    AdTape();
+    AdTape(const AdTape&) = delete;
+    AdTape& operator=(const AdTape&) = delete;
+
+    AdVar newVariable(double value);
+    AdVector newVector(const Vector& v);
+    AdMatrix newMatrix(const Matrix& m);
+
+    // Adds n variables (with uninitialized values) and returns the first index.
+    size_t addVariables(size_t n);
+    // The pointer stays valid only until variables are added to the tape.
+    double* getValues();
+    double getAdjoint(size_t i) const;
+    Arena& getArena();
+    void record(BackwardFunction backward, const void* data);
+
+    // Sets the adjoint of output to 1, and propagates it to all the variables which
+    // it depends on.
+    void computeGradient(const AdVar& output);
+    void clear();
+    size_t getNumVariables() const;
+    size_t getNumOperations() const;
+};
+
+#endif
\ No newline at end of file
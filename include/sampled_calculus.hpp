@@ -0,0 +1,67 @@
+#ifndef SAMPLED_CALCULUS_HPP
+#define SAMPLED_CALCULUS_HPP
+
+#include <cstddef>
+#include <string>
+#include "vectr.hpp"
+#include "summation.hpp"
+
+// Integration and differentiation of tabulated values y[i] = f(x[i]), when only the
+// samples are available. The samples are either uniformly spaced, with spacing dx, or
+// given together with their (strictly increasing) abscissas x.
+//
+// The kernels work on raw arrays in unit-stride loops with independent partial sums, so
+// that the compiler can vectorize them. Long uniform traces can also be integrated in
+// chunks, with StreamingIntegrator, or straight from a file of raw doubles, without
+// ever holding all the samples in memory.
+
+enum QuadratureRuleEnum {TRAPEZOID, SIMPSON};
+
+// Sums of the values at the even and at the odd indices of y[0], ..., y[n - 1].
+void getAlternatingSums(const double* y, size_t n, double& evenSum, double& oddSum);
+
+// Integral over uniformly spaced samples, which are fed in consecutive chunks of any
+// size. Simpson's rule is exact for cubics when the number of intervals is even; when it
+// is odd, the last interval is integrated with the quadratic through the last 3 samples,
+// so the rule remains exact for quadratics. The running sums are compensated, so the
+// accuracy does not degrade with the number of samples.
+class StreamingIntegrator
+{
+    double m_dx;
+    QuadratureRuleEnum m_rule;
+    size_t m_numSamples;
+    CompensatedSum m_evenSum;
+    CompensatedSum m_oddSum;
+    double m_first;
+    // The last 3 samples, the latest one last.
+    double m_last[3];
+public:
+    StreamingIntegrator(double dx, QuadratureRuleEnum rule=SIMPSON);
+    void addSamples(const double* y, size_t count);
+    void addSamples(const Vector& y);
+    double getValue() const;
+    size_t getNumSamples() const;
+};
+
+double getTrapezoidValue(const Vector& y, double dx);
+double getTrapezoidValue(const Vector& x, const Vector& y);
+double getSimpsonValue(const Vector& y, double dx);
+double getSimpsonValue(const Vector& x, const Vector& y);
+
+// Running integral by the trapezoid rule: the i-th entry is the integral from the first
+// sample to the i-th one (so the first entry is 0).
+Vector getCumulativeIntegral(const Vector& y, double dx);
+Vector getCumulativeIntegral(const Vector& x, const Vector& y);
+
+// Derivative at every sample, by second order central differences in the interior and
+// second order one-sided differences at the two ends (first order, if there are only 2
+// samples).
+Vector getSampledGradient(const Vector& y, double dx);
+Vector getSampledGradient(const Vector& x, const Vector& y);
+
+// Integral of the uniformly spaced samples stored in a file as raw doubles (in the byte
+// order of this machine), read chunkSize values at a time. A file which cannot be opened,
+// or whose size is not a multiple of sizeof(double), fails an assertion.
+double getSampledFileIntegratedValue(const std::string& fileName, double dx, QuadratureRuleEnum rule=SIMPSON, size_t chunkSize=1048576);
+
+#endif
\ No newline at end of file
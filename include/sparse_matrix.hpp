@@ -5,42 +5,78 @@
 #include <vector>
 #include "sparse_vector.hpp"
 #include <string>
+#include "linalg_fwd.hpp"
 
-class Matrix;
-class Vector;
+template <typename T>
+struct BasicSparseMatrixEntry
+{
+    size_t row;
+    size_t column;
+    T value;
+};
 
-class SparseMatrix
+typedef BasicSparseMatrixEntry<double> SparseMatrixEntry;
+
+template <typename T>
+class BasicSparseMatrix
 {
-    std::map<size_t, SparseVector> m_data;
-    double m_defaultValue;
+    LinalgMap<BasicSparseVector<T> > m_data;
+    T m_defaultValue;
     size_t m_numRows;
     size_t m_numColumns;
-    const SparseVector m_defaultRowVector;
+    const BasicSparseVector<T> m_defaultRowVector;
 public:
-    SparseMatrix(double defaultValue=0, size_t numRows=0, size_t numColumns=0);
+    BasicSparseMatrix(T defaultValue=0, size_t numRows=0, size_t numColumns=0);
+    // Builds the matrix directly from entries sorted by row, and by column within a row
+    // (without repetitions), in time linear in their number.
+    BasicSparseMatrix(T defaultValue, size_t numRows, size_t numColumns, const std::vector<BasicSparseMatrixEntry<T> >& entries);
+    // Explicit conversion from another element type; there are no operations between
+    // different element types.
+    template <typename U>
+    explicit BasicSparseMatrix(const BasicSparseMatrix<U>& sm)
+    :m_defaultRowVector(static_cast<T>(sm.getDefaultValue()), sm.getNumColumns())
+    {
+        m_defaultValue = static_cast<T>(sm.getDefaultValue());
+        m_numRows = sm.getNumRows();
+        m_numColumns = sm.getNumColumns();
+        for(const auto& e: sm.getData())
+        {
+            m_data.emplace_hint(m_data.end(), e.first, BasicSparseVector<T>(e.second));
+        }
+    }
     size_t getNumRows() const;
     size_t getNumColumns() const;
-    const SparseVector& operator[](size_t i) const;
-    SparseVector& operator[](size_t i);
+    size_t getNumStoredElements() const;
+    T getDefaultValue() const;
+    const BasicSparseVector<T>& operator[](size_t i) const;
+    BasicSparseVector<T>& operator[](size_t i);
 
     // Addition and subtraction methods
-    SparseMatrix operator+(double c) const;
-    SparseMatrix operator-(double c) const;
-    Matrix operator+(const Matrix& m) const;
-    Matrix operator-(const Matrix& m) const;
-    SparseMatrix operator+(const SparseMatrix& sm) const;
-    SparseMatrix operator-(const SparseMatrix& sm) const;
+    BasicSparseMatrix operator+(T c) const;
+    BasicSparseMatrix operator-(T c) const;
+    BasicMatrix<T> operator+(const BasicMatrix<T>& m) const;
+    BasicMatrix<T> operator-(const BasicMatrix<T>& m) const;
+    BasicSparseMatrix operator+(const BasicSparseMatrix& sm) const;
+    BasicSparseMatrix operator-(const BasicSparseMatrix& sm) const;
+    BasicMatrix<T> operator+(const BasicMatrixView<const T>& m) const;
+    BasicMatrix<T> operator-(const BasicMatrixView<const T>& m) const;
 
     // Multiplication methods
-    SparseMatrix operator*(double c) const;
-    Matrix operator*(const std::vector<std::vector<double> >& d) const;
-    Matrix operator*(const Matrix& m) const;
-    Matrix operator*(const SparseMatrix& sm) const;
-    Vector operator*(const std::vector<double>& d) const;
-    Vector operator*(const Vector& v) const;
-    Vector operator*(const SparseVector& sv) const;
-
-    Matrix getFullMatrix() const;
+    BasicSparseMatrix operator*(T c) const;
+    BasicMatrix<T> operator*(const std::vector<std::vector<T> >& d) const;
+    BasicMatrix<T> operator*(const BasicMatrix<T>& m) const;
+    BasicMatrix<T> operator*(const BasicSparseMatrix& sm) const;
+    BasicVector<T> operator*(const std::vector<T>& d) const;
+    BasicVector<T> operator*(const BasicVector<T>& v) const;
+    BasicVector<T> operator*(const BasicSparseVector<T>& sv) const;
+    BasicMatrix<T> operator*(const BasicMatrixView<const T>& m) const;
+    BasicVector<T> operator*(const BasicVectorView<const T>& v) const;
+
+    // The rows with stored elements.
+    const LinalgMap<BasicSparseVector<T> >& getData() const;
+    BasicMatrix<T> getFullMatrix() const;
+    // Read-only view of a block of the matrix (see matrix_view.hpp).
+    BasicSparseMatrixView<T> getBlock(size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns) const;
     std::string getText() const;
 };
 
@@ -3,42 +3,76 @@
 
 #include <map>
 #include <string>
+#include <vector>
+#include "linalg_allocator.hpp"
+#include "linalg_fwd.hpp"
 
-class Vector;
-class Matrix;
-class SparseMatrix;
+template <typename T>
+struct BasicSparseVectorEntry
+{
+    size_t index;
+    T value;
+};
+
+typedef BasicSparseVectorEntry<double> SparseVectorEntry;
 
-class SparseVector
+template <typename T>
+class BasicSparseVector
 {
-    std::map<size_t, double> m_data;
+    LinalgMap<T> m_data;
     size_t m_size;
-    double m_defaultValue;
+    T m_defaultValue;
 public:
-    SparseVector(double defaultValue=0, size_t size=0);
-    const double& operator[](size_t i) const;
-    double& operator[](size_t i);
+    BasicSparseVector(T defaultValue=0, size_t size=0);
+    // Builds the vector directly from entries sorted by strictly increasing index.
+    BasicSparseVector(T defaultValue, size_t size, const std::vector<BasicSparseVectorEntry<T> >& entries);
+    // Copy whose elements are stored in the memory of the given allocator, such as that
+    // of the matrix the copy becomes a row of.
+    BasicSparseVector(const BasicSparseVector& sv, const LinalgAllocator<T>& allocator);
+    // Explicit conversion from another element type; there are no operations between
+    // different element types.
+    template <typename U>
+    explicit BasicSparseVector(const BasicSparseVector<U>& sv)
+    {
+        m_defaultValue = static_cast<T>(sv.getDefaultValue());
+        m_size = sv.size();
+        for(const auto& e: sv.getData())
+        {
+            m_data.emplace_hint(m_data.end(), e.first, static_cast<T>(e.second));
+        }
+    }
+    const T& operator[](size_t i) const;
+    T& operator[](size_t i);
     size_t size() const;
+    T getDefaultValue() const;
+    // Stores an element whose index is larger than those of all the stored elements, in
+    // constant time.
+    void pushBack(size_t i, T value);
 
     // Addition and subtraction methods
-    SparseVector operator+(double c) const;
-    SparseVector operator-(double c) const;
-    Vector operator+(const Vector& v) const;
-    Vector operator-(const Vector& v) const;
-    SparseVector operator+(const SparseVector& sv) const;
-    SparseVector operator-(const SparseVector& sv) const;
+    BasicSparseVector operator+(T c) const;
+    BasicSparseVector operator-(T c) const;
+    BasicVector<T> operator+(const BasicVector<T>& v) const;
+    BasicVector<T> operator-(const BasicVector<T>& v) const;
+    BasicVector<T> operator+(const BasicVectorView<const T>& v) const;
+    BasicVector<T> operator-(const BasicVectorView<const T>& v) const;
+    BasicSparseVector operator+(const BasicSparseVector& sv) const;
+    BasicSparseVector operator-(const BasicSparseVector& sv) const;
 
     // Multiplication methods
-    SparseVector operator*(double c) const;
-    double dot(const Vector& v) const;
-    double dot(const SparseVector& sv) const;
-    Vector operator*(const Matrix& m) const;
-    Vector operator*(const SparseMatrix& sm) const;
+    BasicSparseVector operator*(T c) const;
+    T dot(const BasicVector<T>& v) const;
+    T dot(const BasicSparseVector& sv) const;
+    T dot(const BasicVectorView<const T>& v) const;
+    BasicVector<T> operator*(const BasicMatrix<T>& m) const;
+    BasicVector<T> operator*(const BasicMatrixView<const T>& m) const;
+    BasicVector<T> operator*(const BasicSparseMatrix<T>& sm) const;
 
-    const std::map<size_t, double>& getData() const;
+    const LinalgMap<T>& getData() const;
     std::string getText() const;
-    double getSum() const;
-    double getMin() const;
-    double getMax() const;
+    T getSum() const;
+    T getMin() const;
+    T getMax() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef SUMMATION_HPP
+#define SUMMATION_HPP
+
+#include <cstddef>
+#include <cmath>
+
+// Compensated (Kahan-Babuska / Neumaier) summation: the rounding error of every
+// addition is accumulated separately and added back when the sum is read, so the
+// error does not grow with the number of terms.
+class CompensatedSum
+{
+    double m_sum;
+    double m_compensation;
+public:
+    CompensatedSum()
+    {
+        m_sum = 0;
+        m_compensation = 0;
+    }
+
+    void add(double x)
+    {
+        double t = m_sum + x;
+        if(fabs(m_sum) >= fabs(x))
+        {
+            m_compensation += ((m_sum - t) + x);
+        }
+        else
+        {
+            m_compensation += ((x - t) + m_sum);
+        }
+        m_sum = t;
+    }
+
+    double getSum() const
+    {
+        return m_sum + m_compensation;
+    }
+};
+
+#endif
\ No newline at end of file
@@ -1,146 +1,265 @@
 #ifndef TEMPLATES_LINALG_HPP
 #define TEMPLATES_LINALG_HPP
 
+#include <complex>
+#include <string>
 #include <vector>
+#include "linalg_allocator.hpp"
+#include "text_writer.hpp"
 
-template <typename VectorLikeA, typename VectorLikeB>
-std::vector<double> getVectorSum(const VectorLikeA& va, const VectorLikeB& vb, size_t size)
+// The first template parameter of the functions below is the element type T of the
+// result, which the arguments are expected to share.
+
+// Complex numbers are ordered by their real parts, and then by their imaginary parts
+// (as NumPy sorts them), so that minima and maxima are defined for every element type.
+template <typename T>
+bool isLess(const T& a, const T& b)
+{
+    return a < b;
+}
+
+template <typename T>
+bool isLess(const std::complex<T>& a, const std::complex<T>& b)
+{
+    return (a.real() < b.real()) || ((a.real() == b.real()) && (a.imag() < b.imag()));
+}
+
+template <typename T>
+T getConjugate(const T& x)
+{
+    return x;
+}
+
+template <typename T>
+std::complex<T> getConjugate(const std::complex<T>& x)
+{
+    return std::conj(x);
+}
+
+template <typename T>
+T getRealPart(const T& x)
+{
+    return x;
+}
+
+template <typename T>
+T getRealPart(const std::complex<T>& x)
+{
+    return x.real();
+}
+
+// The set...() functions write their result into r, which can be any vector or matrix
+// like object of the right size, such as a view of part of a larger matrix. The result
+// of a product must not overlap its operands; sums and differences are element-wise, so
+// r may be one of the operands, but must not overlap one at a shifted position (element
+// i of r being another element of the operand, which would be read after being written).
+template <typename T, typename VectorLikeR, typename VectorLikeA, typename VectorLikeB>
+void setVectorSum(VectorLikeR& r, const VectorLikeA& va, const VectorLikeB& vb, size_t size)
 {
-    std::vector<double> r = {};
     for(size_t i = 0; i < size; i++)
     {
-        r.push_back(va[i] + vb[i]);
+        r[i] = va[i] + vb[i];
     }
-    return r;
 }
 
-template <typename VectorLikeA, typename VectorLikeB>
-std::vector<double> getVectorDiff(const VectorLikeA& va, const VectorLikeB& vb, size_t size)
+template <typename T, typename VectorLikeR, typename VectorLikeA, typename VectorLikeB>
+void setVectorDiff(VectorLikeR& r, const VectorLikeA& va, const VectorLikeB& vb, size_t size)
 {
-    std::vector<double> r = {};
     for(size_t i = 0; i < size; i++)
     {
-        r.push_back(va[i] - vb[i]);
+        r[i] = va[i] - vb[i];
     }
-    return r;
 }
 
-template <typename MatrixLikeA, typename MatrixLikeB>
-std::vector<std::vector<double> > getMatrixSum(const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRows, size_t numColumns)
+template <typename T, typename MatrixLikeR, typename MatrixLikeA, typename MatrixLikeB>
+void setMatrixSum(MatrixLikeR& r, const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRows, size_t numColumns)
 {
-    std::vector<std::vector<double> > r = {};
     for(size_t i = 0; i < numRows; i++)
     {
-        r.push_back({});
+        auto&& ri = r[i];
         for(size_t j = 0; j < numColumns; j++)
         {
-            r[i].push_back(ma[i][j] + mb[i][j]);
+            ri[j] = ma[i][j] + mb[i][j];
         }
     }
-    return r;
 }
 
-template <typename MatrixLikeA, typename MatrixLikeB>
-std::vector<std::vector<double> > getMatrixDiff(const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRows, size_t numColumns)
+template <typename T, typename MatrixLikeR, typename MatrixLikeA, typename MatrixLikeB>
+void setMatrixDiff(MatrixLikeR& r, const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRows, size_t numColumns)
 {
-    std::vector<std::vector<double> > r = {};
     for(size_t i = 0; i < numRows; i++)
     {
-        r.push_back({});
+        auto&& ri = r[i];
         for(size_t j = 0; j < numColumns; j++)
         {
-            r[i].push_back(ma[i][j] - mb[i][j]);
+            ri[j] = ma[i][j] - mb[i][j];
         }
     }
-    return r;
 }
 
-template <typename MatrixLikeA, typename MatrixLikeB>
-std::vector<std::vector<double> > getMatrixMatrixProduct(const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRowsA, size_t numColumnsA, size_t numColumnsB)
+template <typename T, typename MatrixLikeR, typename MatrixLikeA, typename MatrixLikeB>
+void setMatrixMatrixProduct(MatrixLikeR& r, const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRowsA, size_t numColumnsA, size_t numColumnsB)
 {
-    std::vector<std::vector<double> > r = {};
+    // The rows of mb are scaled and accumulated into the rows of r, which reads every
+    // operand row by row; each element still sums its terms in the order of k.
     for(size_t i = 0; i < numRowsA; i++)
     {
-        r.push_back({});
+        auto&& ri = r[i];
         for(size_t j = 0; j < numColumnsB; j++)
         {
-            double sum = 0;
-            for(size_t k = 0; k < numColumnsA; k++)
+            ri[j] = 0;
+        }
+        for(size_t k = 0; k < numColumnsA; k++)
+        {
+            T aik = ma[i][k];
+            auto&& bk = mb[k];
+            for(size_t j = 0; j < numColumnsB; j++)
             {
-                sum += (ma[i][k] * mb[k][j]);
+                ri[j] += (aik * bk[j]);
             }
-            r[i].push_back(sum);
         }
     }
-    return r;
 }
 
-template <typename MatrixLike, typename VectorLike>
-std::vector<double> getMatrixVectorProduct(const MatrixLike& m, const VectorLike& v, size_t numRows, size_t numColumns)
+template <typename T, typename VectorLikeR, typename MatrixLike, typename VectorLike>
+void setMatrixVectorProduct(VectorLikeR& r, const MatrixLike& m, const VectorLike& v, size_t numRows, size_t numColumns)
 {
-    std::vector<double> r = {};
     for(size_t i = 0; i < numRows; i++)
     {
-        double sum = 0;
+        auto&& mi = m[i];
+        T sum = 0;
         for(size_t j = 0; j < numColumns; j++)
         {
-            sum += (m[i][j] * v[j]);
+            sum += (mi[j] * v[j]);
         }
-        r.push_back(sum);
+        r[i] = sum;
     }
-    return r;
 }
 
-template <typename VectorLike, typename MatrixLike>
-std::vector<double> getVectorMatrixProduct(const VectorLike& v, const MatrixLike& m, size_t numRows, size_t numColumns)
+template <typename T, typename VectorLikeR, typename VectorLike, typename MatrixLike>
+void setVectorMatrixProduct(VectorLikeR& r, const VectorLike& v, const MatrixLike& m, size_t numRows, size_t numColumns)
 {
-    std::vector<double> r = {};
     for(size_t j = 0; j < numColumns; j++)
     {
-        double sum = 0;
-        for(size_t k = 0; k < numRows; k++)
+        r[j] = 0;
+    }
+    for(size_t k = 0; k < numRows; k++)
+    {
+        T vk = v[k];
+        auto&& mk = m[k];
+        for(size_t j = 0; j < numColumns; j++)
         {
-            sum += (v[k] * m[k][j]);
+            r[j] += (vk * mk[j]);
         }
-        r.push_back(sum);
     }
-    return r;
 }
 
-template <typename MatrixLike>
-std::string getMatrixText(const MatrixLike& m, size_t numRows, size_t numColumns)
+// r += c * ma * mb and r += c * m * v, adding to r instead of overwriting it; c = -1
+// subtracts the product, as in the update of the trailing block of a factorization.
+template <typename T, typename MatrixLikeR, typename MatrixLikeA, typename MatrixLikeB>
+void addMatrixMatrixProduct(MatrixLikeR& r, const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRowsA, size_t numColumnsA, size_t numColumnsB, T c)
 {
-    size_t maxLen = 0;
-    std::vector<std::vector<std::string> > matStr = {};
-    // Determine the maximum length of an element's string representation.
-    for(size_t i = 0; i < numRows; i++)
+    for(size_t i = 0; i < numRowsA; i++)
     {
-        matStr.push_back({});
-        for(size_t j = 0; j < numColumns; j++)
+        auto&& ri = r[i];
+        for(size_t k = 0; k < numColumnsA; k++)
         {
-            std::string elemStr = std::to_string(m[i][j]);
-            matStr[i].push_back(elemStr);
-            maxLen = (maxLen < elemStr.length()) ? elemStr.length() : maxLen;
+            T aik = c * ma[i][k];
+            auto&& bk = mb[k];
+            for(size_t j = 0; j < numColumnsB; j++)
+            {
+                ri[j] += (aik * bk[j]);
+            }
         }
     }
-    std::string matText = "";
+}
+
+template <typename T, typename VectorLikeR, typename MatrixLike, typename VectorLike>
+void addMatrixVectorProduct(VectorLikeR& r, const MatrixLike& m, const VectorLike& v, size_t numRows, size_t numColumns, T c)
+{
     for(size_t i = 0; i < numRows; i++)
     {
+        auto&& mi = m[i];
+        T sum = 0;
         for(size_t j = 0; j < numColumns; j++)
         {
-            size_t lenDiff = maxLen - matStr[i][j].length();
-            std::string paddedElemStr = matStr[i][j] + ((lenDiff > 0) ? std::string(lenDiff, ' ') : "");
-            matText += (paddedElemStr + " ");
+            sum += (mi[j] * v[j]);
         }
-        matText += "\n";
+        r[i] += c * sum;
+    }
+}
+
+template <typename T, typename VectorLikeA, typename VectorLikeB>
+LinalgArray<T> getVectorSum(const VectorLikeA& va, const VectorLikeB& vb, size_t size)
+{
+    LinalgArray<T> r(size);
+    setVectorSum<T>(r, va, vb, size);
+    return r;
+}
+
+template <typename T, typename VectorLikeA, typename VectorLikeB>
+LinalgArray<T> getVectorDiff(const VectorLikeA& va, const VectorLikeB& vb, size_t size)
+{
+    LinalgArray<T> r(size);
+    setVectorDiff<T>(r, va, vb, size);
+    return r;
+}
+
+template <typename T, typename MatrixLikeA, typename MatrixLikeB>
+LinalgArray<LinalgArray<T> > getMatrixSum(const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRows, size_t numColumns)
+{
+    LinalgArray<LinalgArray<T> > r(numRows, LinalgArray<T>(numColumns));
+    setMatrixSum<T>(r, ma, mb, numRows, numColumns);
+    return r;
+}
+
+template <typename T, typename MatrixLikeA, typename MatrixLikeB>
+LinalgArray<LinalgArray<T> > getMatrixDiff(const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRows, size_t numColumns)
+{
+    LinalgArray<LinalgArray<T> > r(numRows, LinalgArray<T>(numColumns));
+    setMatrixDiff<T>(r, ma, mb, numRows, numColumns);
+    return r;
+}
+
+template <typename T, typename MatrixLikeA, typename MatrixLikeB>
+LinalgArray<LinalgArray<T> > getMatrixMatrixProduct(const MatrixLikeA& ma, const MatrixLikeB& mb, size_t numRowsA, size_t numColumnsA, size_t numColumnsB)
+{
+    LinalgArray<LinalgArray<T> > r(numRowsA, LinalgArray<T>(numColumnsB));
+    setMatrixMatrixProduct<T>(r, ma, mb, numRowsA, numColumnsA, numColumnsB);
+    return r;
+}
+
+template <typename T, typename MatrixLike, typename VectorLike>
+LinalgArray<T> getMatrixVectorProduct(const MatrixLike& m, const VectorLike& v, size_t numRows, size_t numColumns)
+{
+    LinalgArray<T> r(numRows);
+    setMatrixVectorProduct<T>(r, m, v, numRows, numColumns);
+    return r;
+}
+
+template <typename T, typename VectorLike, typename MatrixLike>
+LinalgArray<T> getVectorMatrixProduct(const VectorLike& v, const MatrixLike& m, size_t numRows, size_t numColumns)
+{
+    LinalgArray<T> r(numColumns);
+    setVectorMatrixProduct<T>(r, v, m, numRows, numColumns);
+    return r;
+}
+
+template <typename MatrixLike>
+std::string getMatrixText(const MatrixLike& m, size_t numRows, size_t numColumns)
+{
+    std::string matText;
+    {
+        TextWriter writer(matText);
+        writeMatrixText(writer, m, numRows, numColumns);
     }
     return matText;
 }
 
-template <typename VectorLikeA, typename VectorLikeB>
-double getDotProduct(const VectorLikeA& va, const VectorLikeB& vb, size_t n)
+template <typename T, typename VectorLikeA, typename VectorLikeB>
+T getDotProduct(const VectorLikeA& va, const VectorLikeB& vb, size_t n)
 {
-    double sum = 0;
+    T sum = 0;
     for(size_t i = 0; i < n; i++)
     {
         sum += (va[i] * vb[i]);
@@ -151,20 +270,10 @@ double getDotProduct(const VectorLikeA& va, const VectorLikeB& vb, size_t n)
 template <typename VectorLike>
 std::string getVectorText(const VectorLike& v, size_t n)
 {
-    size_t maxLen = 0;
-    std::vector<std::string> vecStr = {};
-    for(size_t i = 0; i < n; i++)
-    {
-        std::string elemStr = std::to_string(v[i]);
-        maxLen = (maxLen < elemStr.length()) ? elemStr.length() : maxLen;
-        vecStr.push_back(elemStr);
-    }
-    std::string vecText = "";
-    for(size_t i = 0; i < n; i++)
+    std::string vecText;
     {
-        size_t lenDiff = maxLen - vecStr[i].length();
-        std::string paddedElemStr = vecStr[i] + ((lenDiff > 0) ? std::string(lenDiff, ' ') : "");
-        vecText += (paddedElemStr + " ");
+        TextWriter writer(vecText);
+        writeVectorText(writer, v, n);
     }
     return vecText;
 }
@@ -0,0 +1,97 @@
+#ifndef TEXT_WRITER_HPP
+#define TEXT_WRITER_HPP
+
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "linalg_fwd.hpp"
+
+// Formats numbers in fixed notation with to_chars into a buffer of chunkSize bytes,
+// which is passed to the sink (or written to the stream, or appended to the string)
+// whenever it fills up and when the writer is flushed or destroyed. With the default
+// precision the numbers are formatted like std::to_string. Complex numbers are written
+// as (real,imaginary), like the stream operator of std::complex.
+class TextWriter
+{
+    std::function<void(const char*, size_t)> m_sink;
+    std::vector<char> m_buffer;
+    size_t m_size;
+    int m_precision;
+    std::vector<char> m_valueBuffer;
+    size_t formatValue(double value);
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 65536;
+    TextWriter(const std::function<void(const char*, size_t)>& sink, int precision=6, size_t chunkSize=DEFAULT_CHUNK_SIZE);
+    TextWriter(std::ostream& stream, int precision=6, size_t chunkSize=DEFAULT_CHUNK_SIZE);
+    TextWriter(std::string& text, int precision=6, size_t chunkSize=DEFAULT_CHUNK_SIZE);
+    TextWriter(const TextWriter& writer) = delete;
+    TextWriter& operator=(const TextWriter& writer) = delete;
+    ~TextWriter();
+    int getPrecision() const;
+    // The number of characters of the formatted value.
+    size_t getLength(double value);
+    size_t getLength(const std::complex<double>& value);
+    void write(const char* data, size_t count);
+    void write(char c);
+    // Writes the value left-aligned in a field of the given width, followed by a space.
+    void writeValue(double value, size_t width);
+    void writeValue(const std::complex<double>& value, size_t width);
+    void flush();
+};
+
+// Each element is written padded to the length of the longest one and followed by a
+// space, and each row of a matrix is followed by a newline. The widths are computed in a
+// first pass over the elements, so no per-element strings are kept.
+template <typename MatrixLike>
+void writeMatrixText(TextWriter& writer, const MatrixLike& m, size_t numRows, size_t numColumns)
+{
+    size_t width = 0;
+    for(size_t i = 0; i < numRows; i++)
+    {
+        for(size_t j = 0; j < numColumns; j++)
+        {
+            size_t length = writer.getLength(m[i][j]);
+            width = (width < length) ? length : width;
+        }
+    }
+    for(size_t i = 0; i < numRows; i++)
+    {
+        for(size_t j = 0; j < numColumns; j++)
+        {
+            writer.writeValue(m[i][j], width);
+        }
+        writer.write('\n');
+    }
+}
+
+template <typename VectorLike>
+void writeVectorText(TextWriter& writer, const VectorLike& v, size_t n)
+{
+    size_t width = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        size_t length = writer.getLength(v[i]);
+        width = (width < length) ? length : width;
+    }
+    for(size_t i = 0; i < n; i++)
+    {
+        writer.writeValue(v[i], width);
+    }
+}
+
+// These are instantiated for the element types of the linear algebra classes.
+template <typename T>
+void writeText(TextWriter& writer, const BasicMatrix<T>& m);
+template <typename T>
+void writeText(TextWriter& writer, const BasicVector<T>& v);
+// The sparse versions only visit the stored elements, writing the padded default value
+// for the runs of elements in between.
+template <typename T>
+void writeText(TextWriter& writer, const BasicSparseMatrix<T>& sm);
+template <typename T>
+void writeText(TextWriter& writer, const BasicSparseVector<T>& sv);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+#ifndef TILED_MATRIX_HPP
+#define TILED_MATRIX_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "mapped_file.hpp"
+#include "linalg_fwd.hpp"
+
+// A dense matrix which lives in a writable mapped file (the TILED_MATRIX object of
+// binary_io.hpp), for matrices larger than the memory. The elements are stored in square
+// tiles of tileSize x tileSize, each one contiguous in the file, so that a tile can be
+// read or written with a single sequential transfer. The tiles at the right and bottom
+// edges are padded with zeros.
+//
+// The operations below stream the tiles they need through a few in-memory buffers: the
+// tiles of the next step are copied from the mapping on another thread while the current
+// step is computed, and the pages of the mapping are released as soon as the tiles have
+// been copied, so the memory used is a small multiple of the tile size, whatever the
+// size of the matrix. The changes are written to the file by the operating system, or
+// by sync().
+class TiledMatrix
+{
+    MappedFile m_file;
+    double* m_data;
+    size_t m_numRows;
+    size_t m_numColumns;
+    size_t m_tileSize;
+    size_t m_numTileRows;
+    size_t m_numTileColumns;
+    size_t getTileOffset(size_t tileRow, size_t tileColumn) const;
+    bool open(std::string& error);
+public:
+    static const size_t DEFAULT_TILE_SIZE = 512;
+    // Creates (or overwrites) the file, with all the elements 0.
+    TiledMatrix(const std::string& path, size_t numRows, size_t numColumns, size_t tileSize=DEFAULT_TILE_SIZE);
+    // Creates (or overwrites) the file, with the elements of m.
+    TiledMatrix(const std::string& path, const Matrix& m, size_t tileSize=DEFAULT_TILE_SIZE);
+    // Opens an existing file. Opening a file which is not a valid tiled matrix file fails
+    // an assertion.
+    TiledMatrix(const std::string& path);
+    // Opens a file which may not be valid: if it is not a valid tiled matrix file, the
+    // matrix is left empty (0 x 0, with no tiles), isValid() returns false and error
+    // describes the problem (error is cleared on success).
+    TiledMatrix(const std::string& path, std::string& error);
+    bool isValid() const;
+    size_t getNumRows() const;
+    size_t getNumColumns() const;
+    size_t getTileSize() const;
+    size_t getNumTileRows() const;
+    size_t getNumTileColumns() const;
+    // The numbers of rows and columns of a tile which lie inside the matrix.
+    size_t getTileNumRows(size_t tileRow) const;
+    size_t getTileNumColumns(size_t tileColumn) const;
+    const std::string& getPath() const;
+
+    double operator()(size_t i, size_t j) const;
+    void set(size_t i, size_t j, double value);
+
+    // The tileSize * tileSize elements of a tile, by rows, straight from the mapping.
+    const double* getTileData(size_t tileRow, size_t tileColumn) const;
+    double* getTileData(size_t tileRow, size_t tileColumn);
+    // Copy a whole tile (tileSize * tileSize elements, by rows) out of or into the file,
+    // releasing the pages of the mapping afterwards.
+    void readTile(size_t tileRow, size_t tileColumn, double* buffer) const;
+    void writeTile(size_t tileRow, size_t tileColumn, const double* buffer);
+    // Hints that a tile will be read soon.
+    void prefetchTile(size_t tileRow, size_t tileColumn) const;
+    // The part of a tile inside the matrix, as a Matrix, and the reverse (the matrix must
+    // have the dimensions given by getTileNumRows and getTileNumColumns).
+    Matrix getTile(size_t tileRow, size_t tileColumn) const;
+    void setTile(size_t tileRow, size_t tileColumn, const Matrix& m);
+    // Copies the whole matrix into memory.
+    Matrix getMatrix() const;
+    // Writes the changes to disk; false if that fails.
+    bool sync() const;
+};
+
+// Out-of-core operations. All the tiled matrices involved must have the same tile size,
+// and an output matrix must not be one of the inputs. numThreads is the number of threads
+// of the tile products (0 uses all the hardware threads).
+
+// Stores a * b in c, which must already have the right dimensions.
+void getTiledProduct(const TiledMatrix& a, const TiledMatrix& b, TiledMatrix& c, size_t numThreads=0);
+// a * v, with v (and the result) in memory.
+Vector getTiledProduct(const TiledMatrix& a, const Vector& v);
+// Stores the transpose of a in t, which must already have the right dimensions.
+void getTiledTranspose(const TiledMatrix& a, TiledMatrix& t);
+// Replaces the square matrix a by the LU factorization of P * a, in place: U in the upper
+// triangle and the diagonal, and L, whose diagonal elements are 1, below it. P is the
+// permutation of partial pivoting, chosen over whole tile columns: the tiles of column k,
+// from the diagonal one down, are copied into memory together (so the memory used grows
+// with the number of rows times the tile size) and the row exchanges are then applied to
+// the other tile columns. Returns the exchanges: row i was exchanged with row
+// pivots[i] >= i, for i = 0, 1, ... in order. A singular matrix fails an assertion.
+std::vector<size_t> getTiledLUFactorization(TiledMatrix& a, size_t numThreads=0);
+// Solves a * x = b, given the factorization of a and the pivots from getTiledLUFactorization.
+Vector getTiledLUSolution(const TiledMatrix& lu, const std::vector<size_t>& pivots, const Vector& b);
+
+#endif
\ No newline at end of file
@@ -1,45 +1,63 @@
 #ifndef VECTR_HPP
 #define VECTR_HPP
 
+#include <initializer_list>
 #include <vector>
 #include <string>
+#include "linalg_allocator.hpp"
+#include "linalg_fwd.hpp"
 
-class Matrix;
-class SparseMatrix;
-class SparseVector;
-
-class Vector
+template <typename T>
+class BasicVector
 {
-    std::vector<double> m_data;
+    LinalgArray<T> m_data;
 public:
-    Vector();
-    Vector(const std::vector<double>& data);
-    double& operator[](size_t i);
-    const double& operator[](size_t i) const;
+    BasicVector();
+    BasicVector(const std::vector<T>& data);
+    BasicVector(std::initializer_list<T> data);
+    BasicVector(LinalgArray<T>&& data);
+    // Explicit conversion from another element type, e.g. FloatVector to Vector; there
+    // are no operations between different element types.
+    template <typename U>
+    explicit BasicVector(const BasicVector<U>& v)
+    {
+        for(const auto& x: v.getData())
+        {
+            m_data.push_back(static_cast<T>(x));
+        }
+    }
+    T& operator[](size_t i);
+    const T& operator[](size_t i) const;
 
     // Addition and subtraction methods
-    Vector operator+(double c) const;
-    Vector operator-(double c) const;
-    Vector operator+(const Vector& v) const;
-    Vector operator-(const Vector& v) const;
-    Vector operator+(const SparseVector& sv) const;
-    Vector operator-(const SparseVector& sv) const;
+    BasicVector operator+(T c) const;
+    BasicVector operator-(T c) const;
+    BasicVector operator+(const BasicVector& v) const;
+    BasicVector operator-(const BasicVector& v) const;
+    BasicVector operator+(const BasicSparseVector<T>& sv) const;
+    BasicVector operator-(const BasicSparseVector<T>& sv) const;
+    BasicVector operator+(const BasicVectorView<const T>& v) const;
+    BasicVector operator-(const BasicVectorView<const T>& v) const;
 
     // Multiplication methods
-    Vector operator*(double c) const;
-    double dot(const Vector& v) const;
-    double dot(const SparseVector& sv) const;
+    BasicVector operator*(T c) const;
+    // The dot products do not conjugate complex elements.
+    T dot(const BasicVector& v) const;
+    T dot(const BasicSparseVector<T>& sv) const;
+    T dot(const BasicVectorView<const T>& v) const;
     // intended use for the following multiplication with Matrix object:
     // as a row-vector being multiplied with a matrix
-    Vector operator*(const Matrix& m) const;
-    Vector operator*(const SparseMatrix& sm) const;
+    BasicVector operator*(const BasicMatrix<T>& m) const;
+    BasicVector operator*(const BasicSparseMatrix<T>& sm) const;
+    BasicVector operator*(const BasicMatrixView<const T>& m) const;
 
-    const std::vector<double>& getData() const;
+    const LinalgArray<T>& getData() const;
     std::string getText() const;
     size_t size() const;
-    double getSum() const;
-    double getMin() const;
-    double getMax() const;
+    T getSum() const;
+    // Complex elements are ordered by their real parts, and then by their imaginary parts.
+    T getMin() const;
+    T getMax() const;
 };
 
 #endif
\ No newline at end of file
@@ -18,22 +18,26 @@ double getIntegratedValue(double (*func)(double), double start, double end, int
 
 double getDifferentiatedValue(double (*func)(double), double x, double dx, int mode)
 {
-    double fxForward, fxBackward;
+    return getDifferentiatedValue<double (*)(double)>(func, x, dx, mode);
+}
+
+void getDifferentialOffsets(double dx, int mode, double& forwardOffset, double& backwardOffset)
+{
     switch(mode)
     {
         case DifferentialEnum::BACKWARD:
-        fxForward = func(x);
-        fxBackward = func(x - dx);
+        forwardOffset = 0;
+        backwardOffset = dx;
         break;
 
         case DifferentialEnum::FORWARD:
-        fxForward = func(x + dx);
-        fxBackward = func(x);
+        forwardOffset = dx;
+        backwardOffset = 0;
         break;
 
         case DifferentialEnum::CENTRAL:
-        fxForward = func(x + 0.5 * dx);
-        fxBackward = func(x - 0.5 * dx);
+        forwardOffset = 0.5 * dx;
+        backwardOffset = 0.5 * dx;
         break;
 
         default:
@@ -41,5 +45,4 @@ double getDifferentiatedValue(double (*func)(double), double x, double dx, int m
         assert(false);
         break;
     }
-    return (fxForward - fxBackward) / dx;
 }
\ No newline at end of file
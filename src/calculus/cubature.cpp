@@ -0,0 +1,297 @@
+#include "cubature.hpp"
+#include <cassert>
+
+namespace
+{
+    // SplitMix64: a small, fast generator whose output is a bijective hash of its
+    // state. It is used for the Monte Carlo points, and for the randomization of the
+    // quasi-Monte Carlo sequences.
+    uint64_t getSplitMix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    double getUniformFromBits(uint64_t bits)
+    {
+        // The top 53 bits give a double in [0, 1).
+        return (bits >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Polynomials over GF(2) are stored as bit masks, bit i being the coefficient of x^i.
+    uint64_t getPolynomialProduct(uint64_t a, uint64_t b, uint64_t modulus, size_t degree)
+    {
+        uint64_t r = 0;
+        while(b != 0)
+        {
+            if(b & 1)
+            {
+                r ^= a;
+            }
+            b >>= 1;
+            a <<= 1;
+            if(a & (1ULL << degree))
+            {
+                a ^= modulus;
+            }
+        }
+        return r;
+    }
+
+    // Returns x^e modulo the polynomial modulus of the given degree.
+    uint64_t getPolynomialPowerOfX(uint64_t e, uint64_t modulus, size_t degree)
+    {
+        uint64_t r = 1;
+        uint64_t base = (degree > 1) ? 2 : (2 ^ modulus);
+        while(e != 0)
+        {
+            if(e & 1)
+            {
+                r = getPolynomialProduct(r, base, modulus, degree);
+            }
+            base = getPolynomialProduct(base, base, modulus, degree);
+            e >>= 1;
+        }
+        return r;
+    }
+
+    // A polynomial of degree s is primitive when x has order 2^s - 1 modulo it.
+    bool isPrimitivePolynomial(uint64_t p, size_t degree)
+    {
+        uint64_t order = (1ULL << degree) - 1;
+        if(getPolynomialPowerOfX(order, p, degree) != 1)
+        {
+            return false;
+        }
+        // x^(order / q) must differ from 1 for every prime factor q of the order.
+        uint64_t rest = order;
+        for(uint64_t q = 2; q * q <= rest; q++)
+        {
+            if(rest % q != 0)
+            {
+                continue;
+            }
+            if(getPolynomialPowerOfX(order / q, p, degree) == 1)
+            {
+                return false;
+            }
+            while(rest % q == 0)
+            {
+                rest /= q;
+            }
+        }
+        return (rest == 1) || (getPolynomialPowerOfX(order / rest, p, degree) != 1);
+    }
+
+    // Returns the first count primitive polynomials, by increasing degree.
+    std::vector<uint64_t> getPrimitivePolynomials(size_t count, std::vector<size_t>& degrees)
+    {
+        std::vector<uint64_t> polynomials = {};
+        degrees = {};
+        for(size_t degree = 1; polynomials.size() < count; degree++)
+        {
+            assert(degree < 32);
+            // Only polynomials with a non-zero constant term can be primitive.
+            for(uint64_t p = (1ULL << degree) | 1; (p < (1ULL << (degree + 1))) && (polynomials.size() < count); p += 2)
+            {
+                if(isPrimitivePolynomial(p, degree))
+                {
+                    polynomials.push_back(p);
+                    degrees.push_back(degree);
+                }
+            }
+        }
+        return polynomials;
+    }
+}
+
+RunningStatistics::RunningStatistics(double count, double mean, double m2)
+{
+    m_count = count;
+    m_mean = mean;
+    m_m2 = m2;
+}
+
+void RunningStatistics::merge(const RunningStatistics& s)
+{
+    if(s.m_count == 0)
+    {
+        return;
+    }
+    double count = m_count + s.m_count;
+    double delta = s.m_mean - m_mean;
+    m_mean += delta * (s.m_count / count);
+    m_m2 += s.m_m2 + delta * delta * (m_count * s.m_count / count);
+    m_count = count;
+}
+
+double RunningStatistics::getCount() const
+{
+    return m_count;
+}
+
+double RunningStatistics::getMean() const
+{
+    return m_mean;
+}
+
+double RunningStatistics::getVariance() const
+{
+    return (m_count > 1) ? (m_m2 / (m_count - 1)) : 0;
+}
+
+PointSequence::PointSequence(int sampling, size_t dimension, size_t numReplicates, uint64_t seed)
+{
+    m_sampling = sampling;
+    m_dimension = dimension;
+    m_seed = seed;
+    uint64_t state = seed;
+    if(sampling == SamplingEnum::SOBOL)
+    {
+        m_directions.assign(32 * dimension, 0);
+        std::vector<size_t> degrees = {};
+        std::vector<uint64_t> polynomials = getPrimitivePolynomials((dimension > 1) ? (dimension - 1) : 0, degrees);
+        // The initial direction numbers come from a fixed stream, so the (unshifted)
+        // sequence is the same for every seed.
+        uint64_t directionState = 0x5eed5eed5eed5eedULL;
+        for(size_t d = 0; d < dimension; d++)
+        {
+            uint32_t* v = m_directions.data() + 32 * d;
+            if(d == 0)
+            {
+                // The first dimension is the van der Corput sequence in base 2.
+                for(size_t j = 0; j < 32; j++)
+                {
+                    v[j] = 1U << (31 - j);
+                }
+                continue;
+            }
+            uint64_t p = polynomials[d - 1];
+            size_t s = degrees[d - 1];
+            for(size_t j = 0; j < 32; j++)
+            {
+                if(j < s)
+                {
+                    // Odd m_j < 2^(j + 1).
+                    uint32_t m = (uint32_t)(getSplitMix64(directionState) & ((1ULL << (j + 1)) - 1)) | 1U;
+                    v[j] = m << (31 - j);
+                    continue;
+                }
+                v[j] = v[j - s] ^ (v[j - s] >> s);
+                for(size_t i = 1; i < s; i++)
+                {
+                    if((p >> (s - i)) & 1)
+                    {
+                        v[j] ^= v[j - i];
+                    }
+                }
+            }
+        }
+        for(size_t k = 0; k < numReplicates * dimension; k++)
+        {
+            m_digitalShifts.push_back((uint32_t)(getSplitMix64(state) >> 32));
+        }
+    }
+    else if(sampling == SamplingEnum::HALTON)
+    {
+        for(uint32_t candidate = 2; m_primes.size() < dimension; candidate++)
+        {
+            bool isPrime = true;
+            for(const auto& q: m_primes)
+            {
+                if(q * q > candidate)
+                {
+                    break;
+                }
+                if(candidate % q == 0)
+                {
+                    isPrime = false;
+                    break;
+                }
+            }
+            if(isPrime)
+            {
+                m_primes.push_back(candidate);
+            }
+        }
+        for(size_t k = 0; k < numReplicates * dimension; k++)
+        {
+            m_shifts.push_back(getUniformFromBits(getSplitMix64(state)));
+        }
+    }
+}
+
+size_t PointSequence::getDimension() const
+{
+    return m_dimension;
+}
+
+void PointSequence::getPoints(size_t replicate, size_t first, size_t count, double* points) const
+{
+    if(m_sampling == SamplingEnum::SOBOL)
+    {
+        const uint32_t* shifts = m_digitalShifts.data() + replicate * m_dimension;
+        for(size_t d = 0; d < m_dimension; d++)
+        {
+            const uint32_t* v = m_directions.data() + 32 * d;
+            // Points are taken in Gray code order: the first one is computed directly,
+            // and each following one differs from it in a single direction number.
+            uint64_t gray = first ^ (first >> 1);
+            uint32_t x = 0;
+            for(size_t j = 0; gray != 0; j++, gray >>= 1)
+            {
+                x ^= ((gray & 1) ? v[j] : 0);
+            }
+            for(size_t p = 0; p < count; p++)
+            {
+                points[p * m_dimension + d] = (x ^ shifts[d]) * (1.0 / 4294967296.0);
+                uint64_t next = first + p + 1;
+                size_t j = 0;
+                while((next & 1) == 0)
+                {
+                    next >>= 1;
+                    j++;
+                }
+                x ^= v[j];
+            }
+        }
+    }
+    else if(m_sampling == SamplingEnum::HALTON)
+    {
+        const double* shifts = m_shifts.data() + replicate * m_dimension;
+        for(size_t p = 0; p < count; p++)
+        {
+            for(size_t d = 0; d < m_dimension; d++)
+            {
+                // Radical inverse of the index (counted from 1) in the base of the
+                // dimension's prime, shifted modulo 1.
+                uint64_t n = first + p + 1;
+                double base = m_primes[d];
+                double f = 1 / base;
+                double r = 0;
+                while(n != 0)
+                {
+                    r += f * (n % m_primes[d]);
+                    n /= m_primes[d];
+                    f /= base;
+                }
+                r += shifts[d];
+                points[p * m_dimension + d] = (r >= 1) ? (r - 1) : r;
+            }
+        }
+    }
+    else
+    {
+        // Every block gets its own stream, derived from the seed, the replicate and the
+        // index of the first point.
+        uint64_t state = m_seed ^ (0x9e3779b97f4a7c15ULL * (replicate + 1));
+        state += 0xd1b54a32d192ed03ULL * first;
+        state = getSplitMix64(state);
+        for(size_t k = 0; k < count * m_dimension; k++)
+        {
+            points[k] = getUniformFromBits(getSplitMix64(state));
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "evaluation_cache.hpp"
+#include <cassert>
+#include <cstring>
+
+EvaluationCache::EvaluationCache(size_t capacity, size_t numShards)
+{
+    assert((capacity > 0) && (numShards > 0));
+    numShards = (numShards < capacity) ? numShards : capacity;
+    for(size_t i = 0; i < numShards; i++)
+    {
+        m_shards.push_back(std::unique_ptr<Shard>(new Shard()));
+        // The first (capacity % numShards) shards hold one extra entry each.
+        m_shards.back()->capacity = capacity / numShards + ((i < capacity % numShards) ? 1 : 0);
+    }
+    m_numHits = 0;
+    m_numMisses = 0;
+}
+
+EvaluationCache::Shard& EvaluationCache::getShard(uint64_t key)
+{
+    // Neighbouring values of x differ only in their low bits, so the key is mixed
+    // before choosing the shard.
+    uint64_t h = key;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h ^= (h >> 31);
+    return *m_shards[h % m_shards.size()];
+}
+
+bool EvaluationCache::find(double x, double& fx)
+{
+    uint64_t key;
+    memcpy(&key, &x, sizeof(double));
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if(it == shard.index.end())
+    {
+        m_numMisses++;
+        return false;
+    }
+    // Move the entry to the front, as the most recently used one.
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    fx = it->second->second;
+    m_numHits++;
+    return true;
+}
+
+void EvaluationCache::insert(double x, double fx)
+{
+    uint64_t key;
+    memcpy(&key, &x, sizeof(double));
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if(it != shard.index.end())
+    {
+        it->second->second = fx;
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return;
+    }
+    if(shard.entries.size() >= shard.capacity)
+    {
+        // Evict the least recently used entry, reusing its list node.
+        auto last = std::prev(shard.entries.end());
+        shard.index.erase(last->first);
+        last->first = key;
+        last->second = fx;
+        shard.entries.splice(shard.entries.begin(), shard.entries, last);
+    }
+    else
+    {
+        shard.entries.push_front({key, fx});
+    }
+    shard.index[key] = shard.entries.begin();
+}
+
+void EvaluationCache::clear()
+{
+    for(auto& shard: m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->entries.clear();
+        shard->index.clear();
+    }
+    m_numHits = 0;
+    m_numMisses = 0;
+}
+
+size_t EvaluationCache::size()
+{
+    size_t count = 0;
+    for(auto& shard: m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        count += shard->entries.size();
+    }
+    return count;
+}
+
+size_t EvaluationCache::getNumHits() const
+{
+    return m_numHits;
+}
+
+size_t EvaluationCache::getNumMisses() const
+{
+    return m_numMisses;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "multivariate_calculus.hpp"
+#include <cassert>
+
+std::vector<size_t> getColumnColoring(const SparseMatrix& pattern, size_t& numColors)
+{
+    size_t m = pattern.getNumRows();
+    size_t n = pattern.getNumColumns();
+    std::vector<std::vector<size_t> > rowColumns(m);
+    std::vector<std::vector<size_t> > columnRows(n);
+    for(size_t i = 0; i < m; i++)
+    {
+        for(const auto& e: pattern[i].getData())
+        {
+            rowColumns[i].push_back(e.first);
+            columnRows[e.first].push_back(i);
+        }
+    }
+    const size_t uncolored = n;
+    std::vector<size_t> colors(n, uncolored);
+    // forbidden[c] == j marks color c as already used by a neighbour of column j. This
+    // avoids clearing the array for every column.
+    std::vector<size_t> forbidden(n + 1, uncolored);
+    numColors = 0;
+    for(size_t j = 0; j < n; j++)
+    {
+        for(const auto& i: columnRows[j])
+        {
+            for(const auto& j2: rowColumns[i])
+            {
+                if(colors[j2] != uncolored)
+                {
+                    forbidden[colors[j2]] = j;
+                }
+            }
+        }
+        size_t c = 0;
+        while(forbidden[c] == j)
+        {
+            c++;
+        }
+        colors[j] = c;
+        numColors = (c + 1 > numColors) ? (c + 1) : numColors;
+    }
+    return colors;
+}
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "ode.hpp"
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+    // Dormand-Prince 5(4) coefficients. Row s of A holds the weights of the stages
+    // j < s; the last row is the 5th order solution, whose stage is evaluated at t + h.
+    const double c[7] = {0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1, 1};
+    const double a[7][6] = {
+        {0, 0, 0, 0, 0, 0},
+        {1.0 / 5, 0, 0, 0, 0, 0},
+        {3.0 / 40, 9.0 / 40, 0, 0, 0, 0},
+        {44.0 / 45, -56.0 / 15, 32.0 / 9, 0, 0, 0},
+        {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729, 0, 0},
+        {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656, 0},
+        {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84}
+    };
+    // Difference between the 5th and the 4th order weights, for all the 7 stages.
+    const double e[7] = {71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40};
+    // Weights of the dense output (Hairer, Norsett and Wanner).
+    const double d[7] = {
+        -12715105075.0 / 11282082432.0, 0, 87487479700.0 / 32700410799.0, -10690763975.0 / 1880347072.0,
+        701980252875.0 / 199316789632.0, -1453857185.0 / 822651844.0, 69997945.0 / 29380423.0
+    };
+}
+
+void setDormandPrinceStage(size_t s, double* out, const double* y, double h, double* const* k, size_t n)
+{
+    assert((s >= 1) && (s <= 6));
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = y[i];
+    }
+    for(size_t j = 0; j < s; j++)
+    {
+        double w = h * a[s][j];
+        if(w == 0)
+        {
+            continue;
+        }
+        const double* kj = k[j];
+        for(size_t i = 0; i < n; i++)
+        {
+            out[i] += w * kj[i];
+        }
+    }
+}
+
+double getDormandPrinceStageTime(size_t s)
+{
+    return c[s];
+}
+
+double getDormandPrinceErrorNorm(const double* y, const double* yNew, double h, double* const* k, size_t dimension, size_t numSystems, double absTolerance, double relTolerance, double* errorSquares)
+{
+    for(size_t sys = 0; sys < numSystems; sys++)
+    {
+        errorSquares[sys] = 0;
+    }
+    // In structure-of-arrays layout, the inner loop runs over the systems for each
+    // component, which is contiguous.
+    for(size_t comp = 0; comp < dimension; comp++)
+    {
+        size_t offset = comp * numSystems;
+        for(size_t sys = 0; sys < numSystems; sys++)
+        {
+            size_t i = offset + sys;
+            double error = 0;
+            for(size_t j = 0; j < 7; j++)
+            {
+                error += e[j] * k[j][i];
+            }
+            error *= h;
+            double yMax = (fabs(y[i]) > fabs(yNew[i])) ? fabs(y[i]) : fabs(yNew[i]);
+            double scaled = error / (absTolerance + relTolerance * yMax);
+            errorSquares[sys] += scaled * scaled;
+        }
+    }
+    double maxSquare = 0;
+    for(size_t sys = 0; sys < numSystems; sys++)
+    {
+        // A NaN would lose every comparison and pass as no error at all, so a step which
+        // overflowed, or where f is not defined, is rejected as infinitely wrong.
+        if(!std::isfinite(errorSquares[sys]))
+        {
+            return INFINITY;
+        }
+        maxSquare = (errorSquares[sys] > maxSquare) ? errorSquares[sys] : maxSquare;
+    }
+    return sqrt(maxSquare / dimension);
+}
+
+void setDormandPrinceDenseOutput(double* dense, const double* y, const double* yNew, double h, double* const* k, size_t n)
+{
+    double* r1 = dense;
+    double* r2 = r1 + n;
+    double* r3 = r2 + n;
+    double* r4 = r3 + n;
+    double* r5 = r4 + n;
+    for(size_t i = 0; i < n; i++)
+    {
+        double yDiff = yNew[i] - y[i];
+        double bSpline = h * k[0][i] - yDiff;
+        r1[i] = y[i];
+        r2[i] = yDiff;
+        r3[i] = bSpline;
+        r4[i] = yDiff - h * k[6][i] - bSpline;
+        r5[i] = h * (d[0] * k[0][i] + d[2] * k[2][i] + d[3] * k[3][i] + d[4] * k[4][i] + d[5] * k[5][i] + d[6] * k[6][i]);
+    }
+}
+
+void getDormandPrinceDenseValue(double theta, const double* dense, double* out, size_t n)
+{
+    const double* r1 = dense;
+    const double* r2 = r1 + n;
+    const double* r3 = r2 + n;
+    const double* r4 = r3 + n;
+    const double* r5 = r4 + n;
+    double theta1 = 1 - theta;
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = r1[i] + theta * (r2[i] + theta1 * (r3[i] + theta * (r4[i] + theta1 * r5[i])));
+    }
+}
+
+double getNextStepSize(double h, double errorNorm, bool rejected)
+{
+    // Standard controller for a 5th order method, with a safety factor of 0.9, and the
+    // change limited to the range [0.2, 10] (or [0.2, 1] after a rejection).
+    double maxFactor = rejected ? 1 : 10;
+    double factor = (errorNorm > 0) ? (0.9 * pow(errorNorm, -0.2)) : maxFactor;
+    factor = (factor < 0.2) ? 0.2 : ((factor > maxFactor) ? maxFactor : factor);
+    return h * factor;
+}
+
+double getInitialStepSize(const double* y, const double* dydt, size_t n, double absTolerance, double relTolerance)
+{
+    // A step which changes y by about 1% of its (scaled) size.
+    double yNorm = 0;
+    double dydtNorm = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        double scale = absTolerance + relTolerance * fabs(y[i]);
+        yNorm += (y[i] / scale) * (y[i] / scale);
+        dydtNorm += (dydt[i] / scale) * (dydt[i] / scale);
+    }
+    yNorm = sqrt(yNorm / n);
+    dydtNorm = sqrt(dydtNorm / n);
+    return ((yNorm < 1.e-5) || (dydtNorm < 1.e-5)) ? 1.e-6 : (0.01 * yNorm / dydtNorm);
+}
+
+RK4Integrator::RK4Integrator(size_t dimension)
+{
+    assert(dimension > 0);
+    m_dimension = dimension;
+    std::vector<double> zeros(dimension, 0);
+    m_k1 = zeros;
+    m_k2 = zeros;
+    m_k3 = zeros;
+    m_k4 = zeros;
+    m_stage = zeros;
+}
+
+DormandPrinceIntegrator::DormandPrinceIntegrator(size_t dimension, double absTolerance, double relTolerance)
+{
+    assert(dimension > 0);
+    m_dimension = dimension;
+    m_absTolerance = absTolerance;
+    m_relTolerance = relTolerance;
+    std::vector<double> zeros(dimension, 0);
+    m_k = std::vector<Vector>(7, Vector(zeros));
+    m_stage = zeros;
+    m_yNew = zeros;
+    m_dense = std::vector<double>(5 * dimension, 0);
+    m_numSteps = 0;
+    m_numRejectedSteps = 0;
+    m_numEvaluations = 0;
+    reset();
+}
+
+void DormandPrinceIntegrator::reset()
+{
+    m_tOld = 0;
+    m_h = 0;
+    m_hNext = 0;
+    m_firstStageValid = false;
+}
+
+void DormandPrinceIntegrator::getDenseOutput(double t, Vector& y) const
+{
+    assert(y.size() == m_dimension);
+    assert(m_h > 0);
+    getDormandPrinceDenseValue((t - m_tOld) / m_h, m_dense.data(), &y[0], m_dimension);
+}
+
+double DormandPrinceIntegrator::getStepSize() const
+{
+    return m_h;
+}
+
+size_t DormandPrinceIntegrator::getNumSteps() const
+{
+    return m_numSteps;
+}
+
+size_t DormandPrinceIntegrator::getNumRejectedSteps() const
+{
+    return m_numRejectedSteps;
+}
+
+size_t DormandPrinceIntegrator::getNumEvaluations() const
+{
+    return m_numEvaluations;
+}
+
+BatchedRK4Integrator::BatchedRK4Integrator(size_t dimension, size_t numSystems)
+{
+    m_dimension = dimension;
+    m_numSystems = numSystems;
+    m_k = std::vector<double>(4 * dimension * numSystems, 0);
+    m_stage = std::vector<double>(dimension * numSystems, 0);
+}
+
+BatchedDormandPrinceIntegrator::BatchedDormandPrinceIntegrator(size_t dimension, size_t numSystems, double absTolerance, double relTolerance)
+{
+    assert((dimension > 0) && (numSystems > 0));
+    m_dimension = dimension;
+    m_numSystems = numSystems;
+    m_absTolerance = absTolerance;
+    m_relTolerance = relTolerance;
+    size_t n = dimension * numSystems;
+    m_k = std::vector<double>(7 * n, 0);
+    m_stage = std::vector<double>(n, 0);
+    m_yNew = std::vector<double>(n, 0);
+    m_dense = std::vector<double>(5 * n, 0);
+    m_errorSquares = std::vector<double>(numSystems, 0);
+    m_numSteps = 0;
+    m_numRejectedSteps = 0;
+    reset();
+}
+
+void BatchedDormandPrinceIntegrator::reset()
+{
+    m_tOld = 0;
+    m_h = 0;
+    m_hNext = 0;
+    m_firstStageValid = false;
+}
+
+void BatchedDormandPrinceIntegrator::getDenseOutput(double t, double* y) const
+{
+    assert(m_h > 0);
+    getDormandPrinceDenseValue((t - m_tOld) / m_h, m_dense.data(), y, m_dimension * m_numSystems);
+}
+
+size_t BatchedDormandPrinceIntegrator::getNumSteps() const
+{
+    return m_numSteps;
+}
+
+size_t BatchedDormandPrinceIntegrator::getNumRejectedSteps() const
+{
+    return m_numRejectedSteps;
+}
\ No newline at end of file
@@ -0,0 +1,798 @@
+#include "reverse_autodiff.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include "vectr.hpp"
+#include "matrix.hpp"
+
+// Data of the recorded operations, along with their backward functions. Every operand
+// and result is referred to by its index on the tape, because the arrays of values and
+// adjoints may be reallocated while recording.
+namespace
+{
+    struct ScalarData
+    {
+        size_t result;
+        size_t a;
+        size_t b;
+        double da;
+        double db;
+    };
+
+    void backwardScalar(const void* data, const double*, double* adjoints)
+    {
+        const ScalarData& d = *static_cast<const ScalarData*>(data);
+        double adj = adjoints[d.result];
+        adjoints[d.a] += d.da * adj;
+        adjoints[d.b] += d.db * adj;
+    }
+
+    struct VectorSumData
+    {
+        size_t result;
+        size_t a;
+        size_t b;
+        size_t n;
+        double signB;
+    };
+
+    void backwardVectorSum(const void* data, const double*, double* adjoints)
+    {
+        const VectorSumData& d = *static_cast<const VectorSumData*>(data);
+        const double* adjR = adjoints + d.result;
+        double* adjA = adjoints + d.a;
+        double* adjB = adjoints + d.b;
+        for(size_t i = 0; i < d.n; i++)
+        {
+            adjA[i] += adjR[i];
+        }
+        for(size_t i = 0; i < d.n; i++)
+        {
+            adjB[i] += d.signB * adjR[i];
+        }
+    }
+
+    // Covers the operations whose result is a scaled copy of one operand, plus
+    // constants: v * c, v + w and v - w (w being a constant Vector).
+    struct VectorScaleData
+    {
+        size_t result;
+        size_t a;
+        size_t n;
+        double scale;
+    };
+
+    void backwardVectorScale(const void* data, const double*, double* adjoints)
+    {
+        const VectorScaleData& d = *static_cast<const VectorScaleData*>(data);
+        const double* adjR = adjoints + d.result;
+        double* adjA = adjoints + d.a;
+        for(size_t i = 0; i < d.n; i++)
+        {
+            adjA[i] += d.scale * adjR[i];
+        }
+    }
+
+    struct ElementwiseData
+    {
+        size_t result;
+        size_t a;
+        size_t n;
+        // Derivatives of the function at every element, computed in the forward pass.
+        const double* derivatives;
+    };
+
+    void backwardElementwise(const void* data, const double*, double* adjoints)
+    {
+        const ElementwiseData& d = *static_cast<const ElementwiseData*>(data);
+        const double* adjR = adjoints + d.result;
+        double* adjA = adjoints + d.a;
+        for(size_t i = 0; i < d.n; i++)
+        {
+            adjA[i] += d.derivatives[i] * adjR[i];
+        }
+    }
+
+    struct DotData
+    {
+        size_t result;
+        size_t a;
+        size_t b;
+        size_t n;
+    };
+
+    void backwardDot(const void* data, const double* values, double* adjoints)
+    {
+        const DotData& d = *static_cast<const DotData*>(data);
+        double adj = adjoints[d.result];
+        for(size_t i = 0; i < d.n; i++)
+        {
+            adjoints[d.a + i] += values[d.b + i] * adj;
+        }
+        for(size_t i = 0; i < d.n; i++)
+        {
+            adjoints[d.b + i] += values[d.a + i] * adj;
+        }
+    }
+
+    struct ConstantDotData
+    {
+        size_t result;
+        size_t a;
+        size_t n;
+        const double* c;
+    };
+
+    void backwardConstantDot(const void* data, const double*, double* adjoints)
+    {
+        const ConstantDotData& d = *static_cast<const ConstantDotData*>(data);
+        double adj = adjoints[d.result];
+        double* adjA = adjoints + d.a;
+        for(size_t i = 0; i < d.n; i++)
+        {
+            adjA[i] += d.c[i] * adj;
+        }
+    }
+
+    struct SumData
+    {
+        size_t result;
+        size_t a;
+        size_t n;
+    };
+
+    void backwardSum(const void* data, const double*, double* adjoints)
+    {
+        const SumData& d = *static_cast<const SumData*>(data);
+        double adj = adjoints[d.result];
+        double* adjA = adjoints + d.a;
+        for(size_t i = 0; i < d.n; i++)
+        {
+            adjA[i] += adj;
+        }
+    }
+
+    // r = A x, for an A on the tape (if a is valid) or a constant matrix c.
+    struct MatrixVectorData
+    {
+        size_t result;
+        size_t a;
+        size_t x;
+        size_t numRows;
+        size_t numColumns;
+        const double* c;
+    };
+
+    void backwardMatrixVector(const void* data, const double* values, double* adjoints)
+    {
+        const MatrixVectorData& d = *static_cast<const MatrixVectorData*>(data);
+        const double* adjR = adjoints + d.result;
+        const double* m = (d.c != nullptr) ? d.c : (values + d.a);
+        const double* x = values + d.x;
+        double* adjX = adjoints + d.x;
+        // adj(x) += A^T adj(r) and adj(A) += adj(r) x^T, row by row.
+        for(size_t i = 0; i < d.numRows; i++)
+        {
+            const double* row = m + i * d.numColumns;
+            double adj = adjR[i];
+            for(size_t j = 0; j < d.numColumns; j++)
+            {
+                adjX[j] += row[j] * adj;
+            }
+            if(d.c == nullptr)
+            {
+                double* adjRow = adjoints + d.a + i * d.numColumns;
+                for(size_t j = 0; j < d.numColumns; j++)
+                {
+                    adjRow[j] += adj * x[j];
+                }
+            }
+        }
+    }
+
+    // C = A B, A being m x k and B being k x n.
+    struct MatrixProductData
+    {
+        size_t result;
+        size_t a;
+        size_t b;
+        size_t m;
+        size_t k;
+        size_t n;
+    };
+
+    void backwardMatrixProduct(const void* data, const double* values, double* adjoints)
+    {
+        const MatrixProductData& d = *static_cast<const MatrixProductData*>(data);
+        const double* a = values + d.a;
+        const double* b = values + d.b;
+        const double* adjC = adjoints + d.result;
+        double* adjA = adjoints + d.a;
+        double* adjB = adjoints + d.b;
+        // adj(A) += adj(C) B^T and adj(B) += A^T adj(C). Both are accumulated in the same
+        // pass, with the innermost loops running along contiguous rows.
+        for(size_t i = 0; i < d.m; i++)
+        {
+            const double* adjCRow = adjC + i * d.n;
+            for(size_t l = 0; l < d.k; l++)
+            {
+                const double* bRow = b + l * d.n;
+                double* adjBRow = adjB + l * d.n;
+                double ail = a[i * d.k + l];
+                double sum = 0;
+                for(size_t j = 0; j < d.n; j++)
+                {
+                    sum += adjCRow[j] * bRow[j];
+                    adjBRow[j] += ail * adjCRow[j];
+                }
+                adjA[i * d.k + l] += sum;
+            }
+        }
+    }
+
+    AdVar recordScalar(AdTape* tape, double value, size_t a, double da, size_t b, double db)
+    {
+        size_t r = tape->addVariables(1);
+        tape->getValues()[r] = value;
+        tape->record(backwardScalar, tape->getArena().create(ScalarData{r, a, b, da, db}));
+        return AdVar(tape, r);
+    }
+
+    AdVar recordUnary(const AdVar& v, double value, double derivative)
+    {
+        return recordScalar(v.getTape(), value, v.getIndex(), derivative, v.getIndex(), 0);
+    }
+
+    AdVector recordElementwise(const AdVector& v, double (*func)(double), double (*derivative)(double, double))
+    {
+        AdTape* tape = v.getTape();
+        size_t n = v.size();
+        size_t r = tape->addVariables(n);
+        double* values = tape->getValues();
+        double* derivatives = tape->getArena().allocateArray<double>(n);
+        for(size_t i = 0; i < n; i++)
+        {
+            double x = values[v.getOffset() + i];
+            values[r + i] = func(x);
+            derivatives[i] = derivative(x, values[r + i]);
+        }
+        tape->record(backwardElementwise, tape->getArena().create(ElementwiseData{r, v.getOffset(), n, derivatives}));
+        return AdVector(tape, r, n);
+    }
+
+    // Records r = scale * v + sign * c, where c is an optional constant Vector.
+    AdVector recordVectorScale(const AdVector& v, double scale, const Vector* c, double sign)
+    {
+        AdTape* tape = v.getTape();
+        size_t n = v.size();
+        size_t r = tape->addVariables(n);
+        double* values = tape->getValues();
+        for(size_t i = 0; i < n; i++)
+        {
+            values[r + i] = scale * values[v.getOffset() + i] + ((c != nullptr) ? (sign * (*c)[i]) : 0);
+        }
+        tape->record(backwardVectorScale, tape->getArena().create(VectorScaleData{r, v.getOffset(), n, scale}));
+        return AdVector(tape, r, n);
+    }
+}
+
+AdVar::AdVar(AdTape* tape, size_t index)
+{
+    m_tape = tape;
+    m_index = index;
+}
+
+AdTape* AdVar::getTape() const
+{
+    return m_tape;
+}
+
+size_t AdVar::getIndex() const
+{
+    return m_index;
+}
+
+double AdVar::getValue() const
+{
+    return m_tape->getValues()[m_index];
+}
+
+double AdVar::getAdjoint() const
+{
+    return m_tape->getAdjoint(m_index);
+}
+
+AdVar AdVar::operator-() const
+{
+    return recordUnary((*this), -getValue(), -1);
+}
+
+AdVar AdVar::operator+(const AdVar& v) const
+{
+    assert(m_tape == v.m_tape);
+    return recordScalar(m_tape, getValue() + v.getValue(), m_index, 1, v.m_index, 1);
+}
+
+AdVar AdVar::operator-(const AdVar& v) const
+{
+    assert(m_tape == v.m_tape);
+    return recordScalar(m_tape, getValue() - v.getValue(), m_index, 1, v.m_index, -1);
+}
+
+AdVar AdVar::operator*(const AdVar& v) const
+{
+    assert(m_tape == v.m_tape);
+    double a = getValue();
+    double b = v.getValue();
+    return recordScalar(m_tape, a * b, m_index, b, v.m_index, a);
+}
+
+AdVar AdVar::operator/(const AdVar& v) const
+{
+    assert(m_tape == v.m_tape);
+    double inv = 1 / v.getValue();
+    double q = getValue() * inv;
+    return recordScalar(m_tape, q, m_index, inv, v.m_index, -q * inv);
+}
+
+AdVar AdVar::operator+(double c) const
+{
+    return recordUnary((*this), getValue() + c, 1);
+}
+
+AdVar AdVar::operator-(double c) const
+{
+    double negativeC = -c;
+    return (*this) + negativeC;
+}
+
+AdVar AdVar::operator*(double c) const
+{
+    return recordUnary((*this), getValue() * c, c);
+}
+
+AdVar AdVar::operator/(double c) const
+{
+    return (*this) * (1 / c);
+}
+
+AdVar operator+(double c, const AdVar& v)
+{
+    return v + c;
+}
+
+AdVar operator-(double c, const AdVar& v)
+{
+    return recordUnary(v, c - v.getValue(), -1);
+}
+
+AdVar operator*(double c, const AdVar& v)
+{
+    return v * c;
+}
+
+AdVar operator/(double c, const AdVar& v)
+{
+    double inv = 1 / v.getValue();
+    return recordUnary(v, c * inv, -c * inv * inv);
+}
+
+AdVar sin(const AdVar& v)
+{
+    return recordUnary(v, std::sin(v.getValue()), std::cos(v.getValue()));
+}
+
+AdVar cos(const AdVar& v)
+{
+    return recordUnary(v, std::cos(v.getValue()), -std::sin(v.getValue()));
+}
+
+AdVar exp(const AdVar& v)
+{
+    double e = std::exp(v.getValue());
+    return recordUnary(v, e, e);
+}
+
+AdVar log(const AdVar& v)
+{
+    return recordUnary(v, std::log(v.getValue()), 1 / v.getValue());
+}
+
+AdVar sqrt(const AdVar& v)
+{
+    double s = std::sqrt(v.getValue());
+    return recordUnary(v, s, 0.5 / s);
+}
+
+AdVar tanh(const AdVar& v)
+{
+    double t = std::tanh(v.getValue());
+    return recordUnary(v, t, 1 - t * t);
+}
+
+AdVar pow(const AdVar& v, double p)
+{
+    double x = v.getValue();
+    return recordUnary(v, std::pow(x, p), p * std::pow(x, p - 1));
+}
+
+AdVector::AdVector(AdTape* tape, size_t offset, size_t size)
+{
+    m_tape = tape;
+    m_offset = offset;
+    m_size = size;
+}
+
+AdVar AdVector::operator[](size_t i) const
+{
+    assert(i < m_size);
+    return AdVar(m_tape, m_offset + i);
+}
+
+AdTape* AdVector::getTape() const
+{
+    return m_tape;
+}
+
+size_t AdVector::size() const
+{
+    return m_size;
+}
+
+size_t AdVector::getOffset() const
+{
+    return m_offset;
+}
+
+Vector AdVector::getValue() const
+{
+    const double* values = m_tape->getValues() + m_offset;
+    return std::vector<double>(values, values + m_size);
+}
+
+Vector AdVector::getGradient() const
+{
+    std::vector<double> r(m_size, 0);
+    for(size_t i = 0; i < m_size; i++)
+    {
+        r[i] = AdVar(m_tape, m_offset + i).getAdjoint();
+    }
+    return Vector(r);
+}
+
+AdVector AdVector::operator+(const AdVector& v) const
+{
+    assert((m_tape == v.m_tape) && (m_size == v.m_size));
+    size_t r = m_tape->addVariables(m_size);
+    double* values = m_tape->getValues();
+    for(size_t i = 0; i < m_size; i++)
+    {
+        values[r + i] = values[m_offset + i] + values[v.m_offset + i];
+    }
+    m_tape->record(backwardVectorSum, m_tape->getArena().create(VectorSumData{r, m_offset, v.m_offset, m_size, 1}));
+    return AdVector(m_tape, r, m_size);
+}
+
+AdVector AdVector::operator-(const AdVector& v) const
+{
+    assert((m_tape == v.m_tape) && (m_size == v.m_size));
+    size_t r = m_tape->addVariables(m_size);
+    double* values = m_tape->getValues();
+    for(size_t i = 0; i < m_size; i++)
+    {
+        values[r + i] = values[m_offset + i] - values[v.m_offset + i];
+    }
+    m_tape->record(backwardVectorSum, m_tape->getArena().create(VectorSumData{r, m_offset, v.m_offset, m_size, -1}));
+    return AdVector(m_tape, r, m_size);
+}
+
+AdVector AdVector::operator+(const Vector& v) const
+{
+    assert(m_size == v.size());
+    return recordVectorScale((*this), 1, &v, 1);
+}
+
+AdVector AdVector::operator-(const Vector& v) const
+{
+    assert(m_size == v.size());
+    return recordVectorScale((*this), 1, &v, -1);
+}
+
+AdVector AdVector::operator*(double c) const
+{
+    return recordVectorScale((*this), c, nullptr, 0);
+}
+
+AdVar AdVector::dot(const AdVector& v) const
+{
+    assert((m_tape == v.m_tape) && (m_size == v.m_size));
+    const double* values = m_tape->getValues();
+    double sum = 0;
+    for(size_t i = 0; i < m_size; i++)
+    {
+        sum += values[m_offset + i] * values[v.m_offset + i];
+    }
+    size_t r = m_tape->addVariables(1);
+    m_tape->getValues()[r] = sum;
+    m_tape->record(backwardDot, m_tape->getArena().create(DotData{r, m_offset, v.m_offset, m_size}));
+    return AdVar(m_tape, r);
+}
+
+AdVar AdVector::dot(const Vector& v) const
+{
+    assert(m_size == v.size());
+    // The constant operand is copied into the arena, so that the Vector need not
+    // outlive the reverse sweep.
+    double* c = m_tape->getArena().allocateArray<double>(m_size);
+    const double* values = m_tape->getValues();
+    double sum = 0;
+    for(size_t i = 0; i < m_size; i++)
+    {
+        c[i] = v[i];
+        sum += values[m_offset + i] * c[i];
+    }
+    size_t r = m_tape->addVariables(1);
+    m_tape->getValues()[r] = sum;
+    m_tape->record(backwardConstantDot, m_tape->getArena().create(ConstantDotData{r, m_offset, m_size, c}));
+    return AdVar(m_tape, r);
+}
+
+AdVar AdVector::getSum() const
+{
+    const double* values = m_tape->getValues();
+    double sum = 0;
+    for(size_t i = 0; i < m_size; i++)
+    {
+        sum += values[m_offset + i];
+    }
+    size_t r = m_tape->addVariables(1);
+    m_tape->getValues()[r] = sum;
+    m_tape->record(backwardSum, m_tape->getArena().create(SumData{r, m_offset, m_size}));
+    return AdVar(m_tape, r);
+}
+
+AdVector exp(const AdVector& v)
+{
+    return recordElementwise(v, [](double x) { return std::exp(x); }, [](double, double fx) { return fx; });
+}
+
+AdVector tanh(const AdVector& v)
+{
+    return recordElementwise(v, [](double x) { return std::tanh(x); }, [](double, double fx) { return 1 - fx * fx; });
+}
+
+AdMatrix::AdMatrix(AdTape* tape, size_t offset, size_t numRows, size_t numColumns)
+{
+    m_tape = tape;
+    m_offset = offset;
+    m_numRows = numRows;
+    m_numColumns = numColumns;
+}
+
+AdVar AdMatrix::operator()(size_t i, size_t j) const
+{
+    assert((i < m_numRows) && (j < m_numColumns));
+    return AdVar(m_tape, m_offset + i * m_numColumns + j);
+}
+
+AdTape* AdMatrix::getTape() const
+{
+    return m_tape;
+}
+
+size_t AdMatrix::getNumRows() const
+{
+    return m_numRows;
+}
+
+size_t AdMatrix::getNumColumns() const
+{
+    return m_numColumns;
+}
+
+size_t AdMatrix::getOffset() const
+{
+    return m_offset;
+}
+
+Matrix AdMatrix::getValue() const
+{
+    std::vector<std::vector<double> > r = {};
+    const double* values = m_tape->getValues() + m_offset;
+    for(size_t i = 0; i < m_numRows; i++)
+    {
+        r.push_back(std::vector<double>(values + i * m_numColumns, values + (i + 1) * m_numColumns));
+    }
+    return Matrix(r);
+}
+
+Matrix AdMatrix::getGradient() const
+{
+    std::vector<std::vector<double> > r = {};
+    for(size_t i = 0; i < m_numRows; i++)
+    {
+        r.push_back({});
+        for(size_t j = 0; j < m_numColumns; j++)
+        {
+            r[i].push_back((*this)(i, j).getAdjoint());
+        }
+    }
+    return Matrix(r);
+}
+
+AdMatrix AdMatrix::operator*(const AdMatrix& m) const
+{
+    assert((m_tape == m.m_tape) && (m_numColumns == m.m_numRows));
+    size_t numRows = m_numRows;
+    size_t k = m_numColumns;
+    size_t n = m.m_numColumns;
+    size_t r = m_tape->addVariables(numRows * n);
+    double* values = m_tape->getValues();
+    const double* a = values + m_offset;
+    const double* b = values + m.m_offset;
+    double* c = values + r;
+    for(size_t i = 0; i < numRows; i++)
+    {
+        double* cRow = c + i * n;
+        for(size_t j = 0; j < n; j++)
+        {
+            cRow[j] = 0;
+        }
+        for(size_t l = 0; l < k; l++)
+        {
+            double ail = a[i * k + l];
+            const double* bRow = b + l * n;
+            for(size_t j = 0; j < n; j++)
+            {
+                cRow[j] += ail * bRow[j];
+            }
+        }
+    }
+    m_tape->record(backwardMatrixProduct, m_tape->getArena().create(MatrixProductData{r, m_offset, m.m_offset, numRows, k, n}));
+    return AdMatrix(m_tape, r, numRows, n);
+}
+
+AdVector AdMatrix::operator*(const AdVector& v) const
+{
+    assert((m_numColumns == v.size()) && (m_tape == v.getTape()));
+    size_t r = m_tape->addVariables(m_numRows);
+    double* values = m_tape->getValues();
+    for(size_t i = 0; i < m_numRows; i++)
+    {
+        const double* row = values + m_offset + i * m_numColumns;
+        double sum = 0;
+        for(size_t j = 0; j < m_numColumns; j++)
+        {
+            sum += row[j] * values[v.getOffset() + j];
+        }
+        values[r + i] = sum;
+    }
+    MatrixVectorData data = {r, m_offset, v.getOffset(), m_numRows, m_numColumns, nullptr};
+    m_tape->record(backwardMatrixVector, m_tape->getArena().create(data));
+    return AdVector(m_tape, r, m_numRows);
+}
+
+AdVector operator*(const Matrix& m, const AdVector& v)
+{
+    assert(m.getNumColumns() == v.size());
+    AdTape* tape = v.getTape();
+    size_t numRows = m.getNumRows();
+    size_t numColumns = m.getNumColumns();
+    // The matrix is copied into the arena in row-major order (see AdVector::dot).
+    double* c = tape->getArena().allocateArray<double>(numRows * numColumns);
+    size_t r = tape->addVariables(numRows);
+    double* values = tape->getValues();
+    for(size_t i = 0; i < numRows; i++)
+    {
+        double* row = c + i * numColumns;
+        double sum = 0;
+        for(size_t j = 0; j < numColumns; j++)
+        {
+            row[j] = m[i][j];
+            sum += row[j] * values[v.getOffset() + j];
+        }
+        values[r + i] = sum;
+    }
+    MatrixVectorData data = {r, 0, v.getOffset(), numRows, numColumns, c};
+    tape->record(backwardMatrixVector, tape->getArena().create(data));
+    return AdVector(tape, r, numRows);
+}
+
+AdTape::AdTape()
+{
+    m_values = {};
+    m_adjoints = {};
+    m_operations = {};
+}
+
+AdVar AdTape::newVariable(double value)
+{
+    size_t i = addVariables(1);
+    m_values[i] = value;
+    return AdVar(this, i);
+}
+
+AdVector AdTape::newVector(const Vector& v)
+{
+    size_t offset = addVariables(v.size());
+    for(size_t i = 0; i < v.size(); i++)
+    {
+        m_values[offset + i] = v[i];
+    }
+    return AdVector(this, offset, v.size());
+}
+
+AdMatrix AdTape::newMatrix(const Matrix& m)
+{
+    size_t numRows = m.getNumRows();
+    size_t numColumns = m.getNumColumns();
+    size_t offset = addVariables(numRows * numColumns);
+    for(size_t i = 0; i < numRows; i++)
+    {
+        for(size_t j = 0; j < numColumns; j++)
+        {
+            m_values[offset + i * numColumns + j] = m[i][j];
+        }
+    }
+    return AdMatrix(this, offset, numRows, numColumns);
+}
+
+size_t AdTape::addVariables(size_t n)
+{
+    size_t offset = m_values.size();
+    // resize() keeps the capacity reached in earlier evaluations, so a cleared tape
+    // does not reallocate when the same computation is recorded again.
+    m_values.resize(offset + n);
+    return offset;
+}
+
+double* AdTape::getValues()
+{
+    return m_values.data();
+}
+
+double AdTape::getAdjoint(size_t i) const
+{
+    // Variables added after the last computeGradient() have no adjoints yet.
+    return (i < m_adjoints.size()) ? m_adjoints[i] : 0;
+}
+
+Arena& AdTape::getArena()
+{
+    return m_arena;
+}
+
+void AdTape::record(BackwardFunction backward, const void* data)
+{
+    m_operations.push_back({backward, data});
+}
+
+void AdTape::computeGradient(const AdVar& output)
+{
+    assert(output.getTape() == this);
+    m_adjoints.assign(m_values.size(), 0);
+    m_adjoints[output.getIndex()] = 1;
+    for(size_t k = m_operations.size(); k > 0; k--)
+    {
+        const Operation& op = m_operations[k - 1];
+        op.backward(op.data, m_values.data(), m_adjoints.data());
+    }
+}
+
+void AdTape::clear()
+{
+    m_values.clear();
+    m_adjoints.clear();
+    m_operations.clear();
+    m_arena.reset();
+}
+
+size_t AdTape::getNumVariables() const
+{
+    return m_values.size();
+}
+
+size_t AdTape::getNumOperations() const
+{
+    return m_operations.size();
+}
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "sampled_calculus.hpp"
+#include <cassert>
+#include <fstream>
+#include <vector>
+
+void getAlternatingSums(const double* y, size_t n, double& evenSum, double& oddSum)
+{
+    double even0 = 0, even1 = 0, odd0 = 0, odd1 = 0;
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        even0 += y[i];
+        odd0 += y[i + 1];
+        even1 += y[i + 2];
+        odd1 += y[i + 3];
+    }
+    for(; i < n; i++)
+    {
+        if(i % 2 == 0)
+        {
+            even0 += y[i];
+        }
+        else
+        {
+            odd0 += y[i];
+        }
+    }
+    evenSum = even0 + even1;
+    oddSum = odd0 + odd1;
+}
+
+StreamingIntegrator::StreamingIntegrator(double dx, QuadratureRuleEnum rule)
+{
+    m_dx = dx;
+    m_rule = rule;
+    m_numSamples = 0;
+    m_first = 0;
+    m_last[0] = m_last[1] = m_last[2] = 0;
+}
+
+void StreamingIntegrator::addSamples(const double* y, size_t count)
+{
+    if(count == 0)
+    {
+        return;
+    }
+    if(m_numSamples == 0)
+    {
+        m_first = y[0];
+    }
+    double evenSum, oddSum;
+    getAlternatingSums(y, count, evenSum, oddSum);
+    // The parity of the indices within the chunk is relative to its first sample.
+    if(m_numSamples % 2 == 0)
+    {
+        m_evenSum.add(evenSum);
+        m_oddSum.add(oddSum);
+    }
+    else
+    {
+        m_evenSum.add(oddSum);
+        m_oddSum.add(evenSum);
+    }
+    for(size_t i = (count > 3) ? count - 3 : 0; i < count; i++)
+    {
+        m_last[0] = m_last[1];
+        m_last[1] = m_last[2];
+        m_last[2] = y[i];
+    }
+    m_numSamples += count;
+}
+
+void StreamingIntegrator::addSamples(const Vector& y)
+{
+    if(y.size() > 0)
+    {
+        addSamples(&y[0], y.size());
+    }
+}
+
+double StreamingIntegrator::getValue() const
+{
+    size_t n = m_numSamples;
+    if(n < 2)
+    {
+        return 0;
+    }
+    double first = m_first;
+    double last = m_last[2];
+    double evenSum = m_evenSum.getSum();
+    double oddSum = m_oddSum.getSum();
+    if((m_rule == TRAPEZOID) || (n == 2))
+    {
+        return m_dx * (evenSum + oddSum - 0.5 * (first + last));
+    }
+    if(n % 2 == 1)
+    {
+        // Weights 1, 4, 2, 4, ..., 2, 4, 1; the last sample has an even index.
+        return m_dx / 3 * (2 * evenSum + 4 * oddSum - first - last);
+    }
+    // Simpson's rule up to the sample n - 2, which has an even index, and the quadratic
+    // through the last 3 samples over the last interval.
+    double simpson = m_dx / 3 * (2 * evenSum + 4 * (oddSum - last) - first - m_last[1]);
+    return simpson + m_dx / 12 * (5 * last + 8 * m_last[1] - m_last[0]);
+}
+
+size_t StreamingIntegrator::getNumSamples() const
+{
+    return m_numSamples;
+}
+
+double getTrapezoidValue(const Vector& y, double dx)
+{
+    StreamingIntegrator integrator(dx, TRAPEZOID);
+    integrator.addSamples(y);
+    return integrator.getValue();
+}
+
+double getTrapezoidValue(const Vector& x, const Vector& y)
+{
+    assert(x.size() == y.size());
+    size_t n = y.size();
+    if(n < 2)
+    {
+        return 0;
+    }
+    const double* xp = &x[0];
+    const double* yp = &y[0];
+    double sum0 = 0, sum1 = 0;
+    size_t i = 0;
+    for(; i + 2 < n; i += 2)
+    {
+        sum0 += (xp[i + 1] - xp[i]) * (yp[i] + yp[i + 1]);
+        sum1 += (xp[i + 2] - xp[i + 1]) * (yp[i + 1] + yp[i + 2]);
+    }
+    for(; i + 1 < n; i++)
+    {
+        sum0 += (xp[i + 1] - xp[i]) * (yp[i] + yp[i + 1]);
+    }
+    return 0.5 * (sum0 + sum1);
+}
+
+double getSimpsonValue(const Vector& y, double dx)
+{
+    StreamingIntegrator integrator(dx, SIMPSON);
+    integrator.addSamples(y);
+    return integrator.getValue();
+}
+
+double getSimpsonValue(const Vector& x, const Vector& y)
+{
+    assert(x.size() == y.size());
+    size_t n = y.size();
+    if(n < 3)
+    {
+        return getTrapezoidValue(x, y);
+    }
+    const double* xp = &x[0];
+    const double* yp = &y[0];
+    // Integral of the quadratic through each pair of intervals.
+    double sum = 0;
+    size_t i = 0;
+    for(; i + 2 < n; i += 2)
+    {
+        double h0 = xp[i + 1] - xp[i];
+        double h1 = xp[i + 2] - xp[i + 1];
+        double h = h0 + h1;
+        sum += h / 6 * ((2 - h1 / h0) * yp[i] + h * h / (h0 * h1) * yp[i + 1] + (2 - h0 / h1) * yp[i + 2]);
+    }
+    if(i + 1 < n)
+    {
+        // An odd number of intervals: the last one is integrated with the quadratic
+        // through the last 3 samples.
+        double h0 = xp[n - 2] - xp[n - 3];
+        double h1 = xp[n - 1] - xp[n - 2];
+        double alpha = (2 * h1 * h1 + 3 * h0 * h1) / (6 * (h0 + h1));
+        double beta = (h1 * h1 + 3 * h0 * h1) / (6 * h0);
+        double eta = h1 * h1 * h1 / (6 * h0 * (h0 + h1));
+        sum += alpha * yp[n - 1] + beta * yp[n - 2] - eta * yp[n - 3];
+    }
+    return sum;
+}
+
+Vector getCumulativeIntegral(const Vector& y, double dx)
+{
+    size_t n = y.size();
+    std::vector<double> result(n, 0.0);
+    CompensatedSum sum;
+    for(size_t i = 1; i < n; i++)
+    {
+        sum.add(0.5 * dx * (y[i - 1] + y[i]));
+        result[i] = sum.getSum();
+    }
+    return Vector(result);
+}
+
+Vector getCumulativeIntegral(const Vector& x, const Vector& y)
+{
+    assert(x.size() == y.size());
+    size_t n = y.size();
+    std::vector<double> result(n, 0.0);
+    CompensatedSum sum;
+    for(size_t i = 1; i < n; i++)
+    {
+        sum.add(0.5 * (x[i] - x[i - 1]) * (y[i - 1] + y[i]));
+        result[i] = sum.getSum();
+    }
+    return Vector(result);
+}
+
+Vector getSampledGradient(const Vector& y, double dx)
+{
+    size_t n = y.size();
+    assert(n >= 2);
+    std::vector<double> gradient(n);
+    const double* yp = &y[0];
+    double* g = &gradient[0];
+    double scale = 0.5 / dx;
+    for(size_t i = 1; i + 1 < n; i++)
+    {
+        g[i] = scale * (yp[i + 1] - yp[i - 1]);
+    }
+    if(n == 2)
+    {
+        g[0] = g[1] = (yp[1] - yp[0]) / dx;
+    }
+    else
+    {
+        g[0] = scale * (-3 * yp[0] + 4 * yp[1] - yp[2]);
+        g[n - 1] = scale * (3 * yp[n - 1] - 4 * yp[n - 2] + yp[n - 3]);
+    }
+    return Vector(gradient);
+}
+
+Vector getSampledGradient(const Vector& x, const Vector& y)
+{
+    assert(x.size() == y.size());
+    size_t n = y.size();
+    assert(n >= 2);
+    std::vector<double> gradient(n);
+    const double* xp = &x[0];
+    const double* yp = &y[0];
+    double* g = &gradient[0];
+    for(size_t i = 1; i + 1 < n; i++)
+    {
+        double hs = xp[i] - xp[i - 1];
+        double hd = xp[i + 1] - xp[i];
+        g[i] = (hs * hs * yp[i + 1] + (hd * hd - hs * hs) * yp[i] - hd * hd * yp[i - 1]) / (hs * hd * (hs + hd));
+    }
+    if(n == 2)
+    {
+        g[0] = g[1] = (yp[1] - yp[0]) / (xp[1] - xp[0]);
+    }
+    else
+    {
+        double h1 = xp[1] - xp[0];
+        double h2 = xp[2] - xp[1];
+        g[0] = -(2 * h1 + h2) / (h1 * (h1 + h2)) * yp[0] + (h1 + h2) / (h1 * h2) * yp[1] - h1 / (h2 * (h1 + h2)) * yp[2];
+        h1 = xp[n - 2] - xp[n - 3];
+        h2 = xp[n - 1] - xp[n - 2];
+        g[n - 1] = h2 / (h1 * (h1 + h2)) * yp[n - 3] - (h1 + h2) / (h1 * h2) * yp[n - 2] + (2 * h2 + h1) / (h2 * (h1 + h2)) * yp[n - 1];
+    }
+    return Vector(gradient);
+}
+
+double getSampledFileIntegratedValue(const std::string& fileName, double dx, QuadratureRuleEnum rule, size_t chunkSize)
+{
+    assert(chunkSize > 0);
+    std::ifstream file(fileName, std::ios::binary);
+    assert(file.is_open());
+    StreamingIntegrator integrator(dx, rule);
+    std::vector<double> buffer(chunkSize);
+    while(file)
+    {
+        file.read(reinterpret_cast<char*>(&buffer[0]), chunkSize * sizeof(double));
+        // A partial double at the end means the file is not what it is taken to be.
+        assert(file.gcount() % sizeof(double) == 0);
+        size_t count = file.gcount() / sizeof(double);
+        integrator.addSamples(&buffer[0], count);
+    }
+    return integrator.getValue();
+}
\ No newline at end of file
@@ -0,0 +1,651 @@
+#include "binary_io.hpp"
+#include "matrix.hpp"
+#include "vectr.hpp"
+#include "sparse_matrix.hpp"
+#include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    const char BINARY_MAGIC[8] = {'M', 'A', 'T', 'H', 'O', 'P', 'S', 0};
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    const uint32_t CHECKSUM_FLAG = 1;
+    const uint64_t CHECKSUM_PRIME = 0x100000001b3ULL;
+    // Number of elements written at a time, when they have to be gathered first.
+    const size_t WRITE_BUFFER_SIZE = 4096;
+
+    static_assert(sizeof(BinaryFileHeader) == 72, "BinaryFileHeader must not be padded");
+
+    size_t getAlignedOffset(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // Moves end past a section of count elements of elementSize bytes. Returns false if
+    // the section does not fit in a file of fileSize bytes, without overflowing on the way.
+    bool addSection(size_t& end, uint64_t count, size_t elementSize, size_t fileSize)
+    {
+        if((end > fileSize) || (count > (fileSize - end) / elementSize))
+        {
+            return false;
+        }
+        end += count * elementSize;
+        return true;
+    }
+
+    // Checks the CSR arrays of a mapped sparse matrix: the row offsets go from 0 to
+    // numStored without decreasing, and the column indices of each row are increasing
+    // and less than numColumns. Returns false, with a description in error, otherwise.
+    bool checkCompressedRows(const uint64_t* rowOffsets, const uint64_t* columns, const BinaryFileHeader& header, std::string& error)
+    {
+        if((rowOffsets[0] != 0) || (rowOffsets[header.numRows] != header.numStored))
+        {
+            error = "invalid row offsets";
+            return false;
+        }
+        for(size_t i = 0; i < header.numRows; i++)
+        {
+            if(rowOffsets[i + 1] < rowOffsets[i])
+            {
+                error = "decreasing row offsets at row " + std::to_string(i);
+                return false;
+            }
+            for(uint64_t k = rowOffsets[i]; k < rowOffsets[i + 1]; k++)
+            {
+                if(columns[k] >= header.numColumns)
+                {
+                    error = "column index out of range at row " + std::to_string(i);
+                    return false;
+                }
+                if((k > rowOffsets[i]) && (columns[k] <= columns[k - 1]))
+                {
+                    error = "column indices not increasing at row " + std::to_string(i);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Writes the payload sections, keeping track of the offset and the checksum.
+    class PayloadWriter
+    {
+        std::ofstream& m_stream;
+        size_t m_offset;
+        uint64_t m_checksum;
+    public:
+        PayloadWriter(std::ofstream& stream)
+        :m_stream(stream)
+        {
+            m_offset = BINARY_HEADER_SIZE;
+            m_checksum = BINARY_CHECKSUM_SEED;
+        }
+
+        void write(const void* data, size_t size)
+        {
+            m_stream.write(static_cast<const char*>(data), size);
+            m_checksum = getBinaryChecksum(static_cast<const char*>(data), size, m_checksum);
+            m_offset += size;
+        }
+
+        // Pads with zeros up to the start of the next section.
+        void pad()
+        {
+            char zeros[BINARY_ALIGNMENT] = {};
+            size_t padding = getAlignedOffset(m_offset, BINARY_ALIGNMENT) - m_offset;
+            if(padding > 0)
+            {
+                write(zeros, padding);
+            }
+        }
+
+        uint64_t getChecksum() const
+        {
+            return m_checksum;
+        }
+    };
+
+    void writeHeader(std::ofstream& stream, const BinaryFileHeader& header)
+    {
+        char buffer[BINARY_HEADER_SIZE] = {};
+        memcpy(buffer, &header, sizeof(header));
+        stream.write(buffer, BINARY_HEADER_SIZE);
+    }
+
+    // Writes the header, the payload (by calling writePayload(writer)) and then the header
+    // again, with the checksum.
+    template <typename Function>
+    bool writeFile(const std::string& path, BinaryFileHeader header, bool withChecksum, const Function& writePayload)
+    {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        if(!stream.is_open())
+        {
+            return false;
+        }
+        writeHeader(stream, header);
+        PayloadWriter writer(stream);
+        writePayload(writer);
+        if(withChecksum)
+        {
+            header.flags |= CHECKSUM_FLAG;
+            header.checksum = writer.getChecksum();
+            stream.seekp(0);
+            writeHeader(stream, header);
+        }
+        stream.close();
+        return !stream.fail();
+    }
+
+    // Maps the file and checks that it holds an object of the given type. Returns nullptr,
+    // with a description in error, if it does not.
+    std::shared_ptr<MappedFile> openBinaryFile(const std::string& path, BinaryObjectEnum objectType, bool verifyChecksum, BinaryFileHeader& header, std::string& error)
+    {
+        std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+        if(!readBinaryFileHeader(*file, header, error))
+        {
+            return nullptr;
+        }
+        if(header.objectType != (uint32_t)objectType)
+        {
+            error = "holds object type " + std::to_string(header.objectType) + " instead of " + std::to_string(objectType);
+            return nullptr;
+        }
+        if(verifyChecksum && !verifyBinaryChecksum(*file))
+        {
+            error = "the checksum does not match";
+            return nullptr;
+        }
+        error.clear();
+        return file;
+    }
+
+    // For the constructors which take a valid file for granted.
+    void assertValidFile(bool valid, const std::string& path, const std::string& error)
+    {
+        if(!valid)
+        {
+            std::cout << "Invalid binary file " << path << ": " << error << std::endl;
+        }
+        assert(valid);
+    }
+}
+
+BinaryFileHeader getBinaryFileHeader(BinaryObjectEnum objectType, size_t numRows, size_t numColumns, size_t numStored, double defaultValue)
+{
+    BinaryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.objectType = objectType;
+    header.alignment = BINARY_ALIGNMENT;
+    header.numRows = numRows;
+    header.numColumns = numColumns;
+    header.numStored = numStored;
+    header.defaultValue = defaultValue;
+    return header;
+}
+
+uint64_t getBinaryChecksum(const char* data, size_t size, uint64_t checksum)
+{
+    assert(size % 8 == 0);
+    for(size_t i = 0; i < size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        checksum = (checksum ^ word) * CHECKSUM_PRIME;
+    }
+    return checksum;
+}
+
+bool writeBinaryFile(const std::string& path, const Matrix& m, bool withChecksum)
+{
+    size_t numRows = m.getNumRows();
+    size_t numColumns = m.getNumColumns();
+    BinaryFileHeader header = getBinaryFileHeader(BINARY_MATRIX, numRows, numColumns, numRows * numColumns, 0);
+    return writeFile(path, header, withChecksum, [&](PayloadWriter& writer)
+    {
+        for(size_t i = 0; i < numRows; i++)
+        {
+            writer.write(m[i].data(), numColumns * sizeof(double));
+        }
+        writer.pad();
+    });
+}
+
+bool writeBinaryFile(const std::string& path, const Vector& v, bool withChecksum)
+{
+    BinaryFileHeader header = getBinaryFileHeader(BINARY_VECTOR, 1, v.size(), v.size(), 0);
+    return writeFile(path, header, withChecksum, [&](PayloadWriter& writer)
+    {
+        writer.write(v.getData().data(), v.size() * sizeof(double));
+        writer.pad();
+    });
+}
+
+bool writeBinaryFile(const std::string& path, const SparseMatrix& sm, bool withChecksum)
+{
+    const LinalgMap<SparseVector>& rows = sm.getData();
+    size_t numRows = sm.getNumRows();
+    size_t numStored = sm.getNumStoredElements();
+    BinaryFileHeader header = getBinaryFileHeader(BINARY_SPARSE_MATRIX, numRows, sm.getNumColumns(), numStored, sm.getDefaultValue());
+    return writeFile(path, header, withChecksum, [&](PayloadWriter& writer)
+    {
+        std::vector<uint64_t> indices;
+        std::vector<double> values;
+        indices.reserve(WRITE_BUFFER_SIZE);
+        values.reserve(WRITE_BUFFER_SIZE);
+        auto flushIndices = [&]()
+        {
+            writer.write(indices.data(), indices.size() * sizeof(uint64_t));
+            indices.clear();
+        };
+        // Row offsets.
+        uint64_t offset = 0;
+        auto row = rows.begin();
+        for(size_t i = 0; i <= numRows; i++)
+        {
+            indices.push_back(offset);
+            if((row != rows.end()) && (row->first == i))
+            {
+                offset += row->second.getData().size();
+                row++;
+            }
+            if(indices.size() == WRITE_BUFFER_SIZE)
+            {
+                flushIndices();
+            }
+        }
+        flushIndices();
+        writer.pad();
+        // Column indices, and then values.
+        for(const auto& r: rows)
+        {
+            for(const auto& e: r.second.getData())
+            {
+                indices.push_back(e.first);
+                if(indices.size() == WRITE_BUFFER_SIZE)
+                {
+                    flushIndices();
+                }
+            }
+        }
+        flushIndices();
+        writer.pad();
+        for(const auto& r: rows)
+        {
+            for(const auto& e: r.second.getData())
+            {
+                values.push_back(e.second);
+                if(values.size() == WRITE_BUFFER_SIZE)
+                {
+                    writer.write(values.data(), values.size() * sizeof(double));
+                    values.clear();
+                }
+            }
+        }
+        writer.write(values.data(), values.size() * sizeof(double));
+        writer.pad();
+    });
+}
+
+
+bool readBinaryFileHeader(const MappedFile& file, BinaryFileHeader& header, std::string& error)
+{
+    if(!file.isOpen())
+    {
+        error = "the file could not be opened";
+        return false;
+    }
+    if(file.getSize() < BINARY_HEADER_SIZE)
+    {
+        error = "the file is too short";
+        return false;
+    }
+    memcpy(&header, file.getData(), sizeof(header));
+    if(memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+    {
+        error = "not a binary matrix file";
+        return false;
+    }
+    if(header.byteOrder != BYTE_ORDER_MARK)
+    {
+        error = "written with a different byte order";
+        return false;
+    }
+    if(header.version > BINARY_FORMAT_VERSION)
+    {
+        error = "unsupported format version " + std::to_string(header.version);
+        return false;
+    }
+    if((header.alignment == 0) || (header.alignment % 8 != 0))
+    {
+        error = "invalid alignment";
+        return false;
+    }
+    size_t alignment = header.alignment;
+    size_t fileSize = file.getSize();
+    size_t end = getAlignedOffset(BINARY_HEADER_SIZE, alignment);
+    bool fits = true;
+    switch(header.objectType)
+    {
+        case BINARY_MATRIX:
+        case BINARY_VECTOR:
+            if(((header.numColumns != 0) && (header.numRows > UINT64_MAX / header.numColumns)) ||
+               (header.numStored != header.numRows * header.numColumns) || ((header.objectType == BINARY_VECTOR) && (header.numRows != 1)))
+            {
+                error = "inconsistent dimensions";
+                return false;
+            }
+            fits = addSection(end, header.numStored, sizeof(double), fileSize);
+            break;
+        case BINARY_TILED_MATRIX:
+        {
+            size_t tileSize = header.tileSize;
+            uint64_t numTileRows = (tileSize == 0) ? 0 : header.numRows / tileSize + (header.numRows % tileSize != 0);
+            uint64_t numTileColumns = (tileSize == 0) ? 0 : header.numColumns / tileSize + (header.numColumns % tileSize != 0);
+            uint64_t tileArea = (uint64_t)tileSize * tileSize;
+            if((tileSize == 0) || (numTileRows > UINT64_MAX / tileArea / std::max(numTileColumns, (uint64_t)1)) ||
+               (header.numStored != numTileRows * numTileColumns * tileArea))
+            {
+                error = "inconsistent dimensions";
+                return false;
+            }
+            fits = addSection(end, header.numStored, sizeof(double), fileSize);
+            break;
+        }
+        case BINARY_SPARSE_MATRIX:
+        {
+            fits = (header.numRows < UINT64_MAX) && addSection(end, header.numRows + 1, sizeof(uint64_t), fileSize);
+            size_t columnsOffset = getAlignedOffset(end, alignment);
+            end = columnsOffset;
+            fits = fits && addSection(end, header.numStored, sizeof(uint64_t), fileSize);
+            end = getAlignedOffset(end, alignment);
+            fits = fits && addSection(end, header.numStored, sizeof(double), fileSize);
+            if(fits)
+            {
+                const uint64_t* rowOffsets = reinterpret_cast<const uint64_t*>(file.getData() + getAlignedOffset(BINARY_HEADER_SIZE, alignment));
+                const uint64_t* columns = reinterpret_cast<const uint64_t*>(file.getData() + columnsOffset);
+                if(!checkCompressedRows(rowOffsets, columns, header, error))
+                {
+                    return false;
+                }
+            }
+            break;
+        }
+        default:
+            error = "unknown object type " + std::to_string(header.objectType);
+            return false;
+    }
+    if(!fits)
+    {
+        error = "the file is truncated";
+        return false;
+    }
+    return true;
+}
+
+bool verifyBinaryChecksum(const MappedFile& file)
+{
+    BinaryFileHeader header;
+    std::string error;
+    if(!readBinaryFileHeader(file, header, error))
+    {
+        return false;
+    }
+    if((header.flags & CHECKSUM_FLAG) == 0)
+    {
+        return true;
+    }
+    size_t size = file.getSize() - BINARY_HEADER_SIZE;
+    return (size % 8 == 0) && (getBinaryChecksum(file.getData() + BINARY_HEADER_SIZE, size) == header.checksum);
+}
+
+MappedMatrix::MappedMatrix(const std::string& path, bool verifyChecksum)
+{
+    std::string error;
+    assertValidFile(open(path, verifyChecksum, error), path, error);
+}
+
+MappedMatrix::MappedMatrix(const std::string& path, std::string& error, bool verifyChecksum)
+{
+    open(path, verifyChecksum, error);
+}
+
+bool MappedMatrix::open(const std::string& path, bool verifyChecksum, std::string& error)
+{
+    BinaryFileHeader header;
+    m_file = openBinaryFile(path, BINARY_MATRIX, verifyChecksum, header, error);
+    m_data = nullptr;
+    m_numRows = 0;
+    m_numColumns = 0;
+    if(m_file == nullptr)
+    {
+        return false;
+    }
+    m_data = reinterpret_cast<const double*>(m_file->getData() + getAlignedOffset(BINARY_HEADER_SIZE, header.alignment));
+    m_numRows = header.numRows;
+    m_numColumns = header.numColumns;
+    return true;
+}
+
+bool MappedMatrix::isValid() const
+{
+    return m_file != nullptr;
+}
+
+size_t MappedMatrix::getNumRows() const
+{
+    return m_numRows;
+}
+
+size_t MappedMatrix::getNumColumns() const
+{
+    return m_numColumns;
+}
+
+const double* MappedMatrix::operator[](size_t i) const
+{
+    assert(i < m_numRows);
+    return m_data + i * m_numColumns;
+}
+
+double MappedMatrix::operator()(size_t i, size_t j) const
+{
+    assert((i < m_numRows) && (j < m_numColumns));
+    return m_data[i * m_numColumns + j];
+}
+
+const double* MappedMatrix::getData() const
+{
+    return m_data;
+}
+
+Matrix MappedMatrix::getMatrix() const
+{
+    LinalgArray<LinalgArray<double> > data(m_numRows);
+    for(size_t i = 0; i < m_numRows; i++)
+    {
+        data[i].assign(m_data + i * m_numColumns, m_data + (i + 1) * m_numColumns);
+    }
+    return Matrix(std::move(data));
+}
+
+MappedVector::MappedVector(const std::string& path, bool verifyChecksum)
+{
+    std::string error;
+    assertValidFile(open(path, verifyChecksum, error), path, error);
+}
+
+MappedVector::MappedVector(const std::string& path, std::string& error, bool verifyChecksum)
+{
+    open(path, verifyChecksum, error);
+}
+
+bool MappedVector::open(const std::string& path, bool verifyChecksum, std::string& error)
+{
+    BinaryFileHeader header;
+    m_file = openBinaryFile(path, BINARY_VECTOR, verifyChecksum, header, error);
+    m_data = nullptr;
+    m_size = 0;
+    if(m_file == nullptr)
+    {
+        return false;
+    }
+    m_data = reinterpret_cast<const double*>(m_file->getData() + getAlignedOffset(BINARY_HEADER_SIZE, header.alignment));
+    m_size = header.numColumns;
+    return true;
+}
+
+bool MappedVector::isValid() const
+{
+    return m_file != nullptr;
+}
+
+size_t MappedVector::size() const
+{
+    return m_size;
+}
+
+double MappedVector::operator[](size_t i) const
+{
+    assert(i < m_size);
+    return m_data[i];
+}
+
+const double* MappedVector::getData() const
+{
+    return m_data;
+}
+
+Vector MappedVector::getVector() const
+{
+    return Vector(LinalgArray<double>(m_data, m_data + m_size));
+}
+
+MappedSparseMatrix::MappedSparseMatrix(const std::string& path, bool verifyChecksum)
+{
+    std::string error;
+    assertValidFile(open(path, verifyChecksum, error), path, error);
+}
+
+MappedSparseMatrix::MappedSparseMatrix(const std::string& path, std::string& error, bool verifyChecksum)
+{
+    open(path, verifyChecksum, error);
+}
+
+bool MappedSparseMatrix::open(const std::string& path, bool verifyChecksum, std::string& error)
+{
+    BinaryFileHeader header;
+    m_file = openBinaryFile(path, BINARY_SPARSE_MATRIX, verifyChecksum, header, error);
+    m_rowOffsets = nullptr;
+    m_columns = nullptr;
+    m_values = nullptr;
+    m_numRows = 0;
+    m_numColumns = 0;
+    m_numStored = 0;
+    m_defaultValue = 0;
+    if(m_file == nullptr)
+    {
+        return false;
+    }
+    m_numRows = header.numRows;
+    m_numColumns = header.numColumns;
+    m_numStored = header.numStored;
+    m_defaultValue = header.defaultValue;
+    size_t alignment = header.alignment;
+    size_t offset = getAlignedOffset(BINARY_HEADER_SIZE, alignment);
+    m_rowOffsets = reinterpret_cast<const uint64_t*>(m_file->getData() + offset);
+    offset = getAlignedOffset(offset + (m_numRows + 1) * sizeof(uint64_t), alignment);
+    m_columns = reinterpret_cast<const uint64_t*>(m_file->getData() + offset);
+    offset = getAlignedOffset(offset + m_numStored * sizeof(uint64_t), alignment);
+    m_values = reinterpret_cast<const double*>(m_file->getData() + offset);
+    return true;
+}
+
+bool MappedSparseMatrix::isValid() const
+{
+    return m_file != nullptr;
+}
+
+size_t MappedSparseMatrix::getNumRows() const
+{
+    return m_numRows;
+}
+
+size_t MappedSparseMatrix::getNumColumns() const
+{
+    return m_numColumns;
+}
+
+size_t MappedSparseMatrix::getNumStoredElements() const
+{
+    return m_numStored;
+}
+
+double MappedSparseMatrix::getDefaultValue() const
+{
+    return m_defaultValue;
+}
+
+const uint64_t* MappedSparseMatrix::getRowOffsets() const
+{
+    return m_rowOffsets;
+}
+
+const uint64_t* MappedSparseMatrix::getColumns() const
+{
+    return m_columns;
+}
+
+const double* MappedSparseMatrix::getValues() const
+{
+    return m_values;
+}
+
+double MappedSparseMatrix::operator()(size_t i, size_t j) const
+{
+    assert((i < m_numRows) && (j < m_numColumns));
+    const uint64_t* first = m_columns + m_rowOffsets[i];
+    const uint64_t* last = m_columns + m_rowOffsets[i + 1];
+    const uint64_t* k = std::lower_bound(first, last, (uint64_t)j);
+    return ((k != last) && (*k == j)) ? m_values[k - m_columns] : m_defaultValue;
+}
+
+Vector MappedSparseMatrix::operator*(const Vector& v) const
+{
+    assert(v.size() == m_numColumns);
+    // Every row is the default value times the sum of v, corrected at the stored elements.
+    double defaultSum = m_defaultValue * v.getSum();
+    const double* x = v.getData().data();
+    LinalgArray<double> r(m_numRows);
+    for(size_t i = 0; i < m_numRows; i++)
+    {
+        double sum = defaultSum;
+        for(uint64_t k = m_rowOffsets[i]; k < m_rowOffsets[i + 1]; k++)
+        {
+            sum += (m_values[k] - m_defaultValue) * x[m_columns[k]];
+        }
+        r[i] = sum;
+    }
+    return Vector(std::move(r));
+}
+
+SparseMatrix MappedSparseMatrix::getSparseMatrix() const
+{
+    std::vector<SparseMatrixEntry> entries;
+    entries.reserve(m_numStored);
+    for(size_t i = 0; i < m_numRows; i++)
+    {
+        for(uint64_t k = m_rowOffsets[i]; k < m_rowOffsets[i + 1]; k++)
+        {
+            entries.push_back({i, m_columns[k], m_values[k]});
+        }
+    }
+    return SparseMatrix(m_defaultValue, m_numRows, m_numColumns, entries);
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "mapped_file.hpp"
+#include <cassert>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::MappedFile()
+{
+    m_data = nullptr;
+    m_size = 0;
+    m_isWritable = false;
+}
+
+MappedFile::MappedFile(const std::string& path, bool writable)
+{
+    m_data = nullptr;
+    m_size = 0;
+    m_isWritable = writable;
+    m_path = path;
+    int fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if(fd < 0)
+    {
+        return;
+    }
+    struct stat status;
+    if((fstat(fd, &status) == 0) && (status.st_size > 0))
+    {
+        void* data = mmap(nullptr, status.st_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+        if(data != MAP_FAILED)
+        {
+            m_data = static_cast<const char*>(data);
+            m_size = status.st_size;
+        }
+    }
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+{
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_isWritable = other.m_isWritable;
+    m_path = std::move(other.m_path);
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+    if(this != &other)
+    {
+        close();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_isWritable = other.m_isWritable;
+        m_path = std::move(other.m_path);
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+void MappedFile::close()
+{
+    if(m_data != nullptr)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+bool MappedFile::isWritable() const
+{
+    return m_isWritable;
+}
+
+const char* MappedFile::getData() const
+{
+    return m_data;
+}
+
+char* MappedFile::getWritableData() const
+{
+    assert(m_isWritable);
+    return const_cast<char*>(m_data);
+}
+
+size_t MappedFile::getSize() const
+{
+    return m_size;
+}
+
+const std::string& MappedFile::getPath() const
+{
+    return m_path;
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const
+{
+    if((m_data == nullptr) || (offset >= m_size))
+    {
+        return;
+    }
+    // madvise needs a page-aligned start.
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t start = offset - offset % pageSize;
+    size_t end = (offset + length < m_size) ? (offset + length) : m_size;
+    madvise(const_cast<char*>(m_data) + start, end - start, MADV_WILLNEED);
+}
+
+void MappedFile::release(size_t offset, size_t length) const
+{
+    if((m_data == nullptr) || (offset >= m_size))
+    {
+        return;
+    }
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t start = offset - offset % pageSize;
+    size_t end = (offset + length < m_size) ? (offset + length) : m_size;
+    // For a shared file mapping this only unmaps the pages; dirty ones are still written
+    // back to the file, and accessing them again reads them back.
+    madvise(const_cast<char*>(m_data) + start, end - start, MADV_DONTNEED);
+}
+
+bool MappedFile::sync() const
+{
+    if((m_data == nullptr) || !m_isWritable)
+    {
+        return m_data != nullptr;
+    }
+    return msync(const_cast<char*>(m_data), m_size, MS_SYNC) == 0;
+}
\ No newline at end of file
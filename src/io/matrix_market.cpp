@@ -0,0 +1,350 @@
+#include "matrix_market.hpp"
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+#include "sparse_matrix.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    const size_t WRITE_BUFFER_SIZE = 1 << 16;
+    // Smallest part of a file worth parsing on its own thread.
+    const size_t MIN_CHUNK_SIZE = 1 << 16;
+    // Room for one entry: two 20 digit indices and a double of at most 24 characters.
+    const size_t MAX_LINE_SIZE = 80;
+
+    enum SymmetryEnum {GENERAL, SYMMETRIC, SKEW_SYMMETRIC};
+
+    const char* skipBlanks(const char* p, const char* end)
+    {
+        while((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+        {
+            p++;
+        }
+        return p;
+    }
+
+    // std::from_chars, also accepting the leading '+' which strtod and scanf (and so the
+    // files written with printf's %+ flag) allow.
+    template <typename T>
+    std::from_chars_result parseNumber(const char* p, const char* end, T& value)
+    {
+        if((end - p > 1) && (*p == '+') && (p[1] != '+') && (p[1] != '-'))
+        {
+            p++;
+        }
+        return std::from_chars(p, end, value);
+    }
+
+    const char* getLineEnd(const char* p, const char* end)
+    {
+        const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+        return (newline == nullptr) ? end : newline;
+    }
+
+    const char* getNextLine(const char* lineEnd, const char* end)
+    {
+        return (lineEnd < end) ? (lineEnd + 1) : end;
+    }
+
+    // Parses the entries in the lines of [p, end), appending them (0-based) to entries.
+    // Returns false if a line is malformed.
+    bool parseEntries(const char* p, const char* end, bool isPattern, SymmetryEnum symmetry, size_t numRows, size_t numColumns, std::vector<SparseMatrixEntry>& entries)
+    {
+        while(p < end)
+        {
+            const char* lineEnd = getLineEnd(p, end);
+            p = skipBlanks(p, lineEnd);
+            if((p == lineEnd) || (*p == '%'))
+            {
+                p = getNextLine(lineEnd, end);
+                continue;
+            }
+            size_t row, column;
+            double value = 1;
+            auto r = parseNumber(p, lineEnd, row);
+            if(r.ec != std::errc())
+            {
+                return false;
+            }
+            p = skipBlanks(r.ptr, lineEnd);
+            r = parseNumber(p, lineEnd, column);
+            if(r.ec != std::errc())
+            {
+                return false;
+            }
+            p = skipBlanks(r.ptr, lineEnd);
+            if(!isPattern)
+            {
+                r = parseNumber(p, lineEnd, value);
+                if(r.ec != std::errc())
+                {
+                    return false;
+                }
+                p = skipBlanks(r.ptr, lineEnd);
+            }
+            if((p != lineEnd) || (row == 0) || (column == 0) || (row > numRows) || (column > numColumns))
+            {
+                return false;
+            }
+            entries.push_back({row - 1, column - 1, value});
+            if((symmetry != GENERAL) && (row != column))
+            {
+                entries.push_back({column - 1, row - 1, (symmetry == SKEW_SYMMETRIC) ? -value : value});
+            }
+            p = getNextLine(lineEnd, end);
+        }
+        return true;
+    }
+
+    bool isBefore(const SparseMatrixEntry& a, const SparseMatrixEntry& b)
+    {
+        return (a.row < b.row) || ((a.row == b.row) && (a.column < b.column));
+    }
+
+    std::string getLowerCase(std::string s)
+    {
+        for(auto& c: s)
+        {
+            c = tolower(c);
+        }
+        return s;
+    }
+
+    // Formats entries into a buffer, which is written out whenever it is nearly full.
+    class BufferedWriter
+    {
+        std::ofstream& m_stream;
+        std::vector<char> m_buffer;
+        size_t m_size;
+    public:
+        BufferedWriter(std::ofstream& stream)
+        :m_stream(stream), m_buffer(WRITE_BUFFER_SIZE), m_size(0)
+        {
+        }
+
+        void flush()
+        {
+            m_stream.write(m_buffer.data(), m_size);
+            m_size = 0;
+        }
+
+        template <typename T>
+        void append(T value, char separator)
+        {
+            if(m_size + MAX_LINE_SIZE > m_buffer.size())
+            {
+                flush();
+            }
+            char* begin = m_buffer.data() + m_size;
+            auto r = std::to_chars(begin, m_buffer.data() + m_buffer.size(), value);
+            *r.ptr = separator;
+            m_size = r.ptr + 1 - m_buffer.data();
+        }
+    };
+}
+
+SparseMatrix readMatrixMarketFile(const std::string& path, std::string& error, size_t numThreads)
+{
+    error.clear();
+    MappedFile file(path);
+    if(!file.isOpen())
+    {
+        // An empty file cannot be mapped.
+        error = std::ifstream(path).good() ? "the file is empty" : "the file could not be opened";
+        return SparseMatrix();
+    }
+    const char* p = file.getData();
+    const char* end = p + file.getSize();
+    // The banner.
+    const char* lineEnd = getLineEnd(p, end);
+    std::istringstream banner(std::string(p, lineEnd));
+    std::string marker, object, format, field, symmetryName;
+    banner >> marker >> object >> format >> field >> symmetryName;
+    if((marker != "%%MatrixMarket") || (getLowerCase(object) != "matrix"))
+    {
+        error = "not a Matrix Market file";
+        return SparseMatrix();
+    }
+    field = getLowerCase(field);
+    symmetryName = getLowerCase(symmetryName);
+    if(getLowerCase(format) != "coordinate")
+    {
+        error = "only the coordinate format is supported";
+        return SparseMatrix();
+    }
+    if((field != "real") && (field != "integer") && (field != "pattern") && (field != "double"))
+    {
+        error = "unsupported field " + field;
+        return SparseMatrix();
+    }
+    SymmetryEnum symmetry = GENERAL;
+    if(symmetryName == "symmetric")
+    {
+        symmetry = SYMMETRIC;
+    }
+    else if(symmetryName == "skew-symmetric")
+    {
+        symmetry = SKEW_SYMMETRIC;
+    }
+    else if(symmetryName != "general")
+    {
+        error = "unsupported symmetry " + symmetryName;
+        return SparseMatrix();
+    }
+    // The comments, and the size line.
+    p = getNextLine(lineEnd, end);
+    size_t numRows = 0, numColumns = 0, numEntries = 0;
+    while(true)
+    {
+        if(p >= end)
+        {
+            error = "missing size line";
+            return SparseMatrix();
+        }
+        lineEnd = getLineEnd(p, end);
+        const char* q = skipBlanks(p, lineEnd);
+        p = getNextLine(lineEnd, end);
+        if((q == lineEnd) || (*q == '%'))
+        {
+            continue;
+        }
+        auto r = parseNumber(q, lineEnd, numRows);
+        q = skipBlanks(r.ptr, lineEnd);
+        auto rc = parseNumber(q, lineEnd, numColumns);
+        q = skipBlanks(rc.ptr, lineEnd);
+        auto re = parseNumber(q, lineEnd, numEntries);
+        if((r.ec != std::errc()) || (rc.ec != std::errc()) || (re.ec != std::errc()) || (skipBlanks(re.ptr, lineEnd) != lineEnd))
+        {
+            error = "malformed size line";
+            return SparseMatrix();
+        }
+        break;
+    }
+    // Chunks of the entries, each starting at the beginning of a line.
+    const char* body = p;
+    size_t bodySize = end - body;
+    size_t numChunks = getNumThreads(numThreads);
+    numChunks = (bodySize / MIN_CHUNK_SIZE + 1 < numChunks) ? (bodySize / MIN_CHUNK_SIZE + 1) : numChunks;
+    std::vector<const char*> chunkStarts(numChunks + 1, end);
+    chunkStarts[0] = body;
+    for(size_t c = 1; c < numChunks; c++)
+    {
+        const char* q = body + getChunkStart(bodySize, numChunks, c);
+        q = (q > chunkStarts[c - 1]) ? q : chunkStarts[c - 1];
+        chunkStarts[c] = (q == body) ? body : getNextLine(getLineEnd(q - 1, end), end);
+    }
+    bool isPattern = (field == "pattern");
+    std::vector<std::vector<SparseMatrixEntry> > chunkEntries(numChunks);
+    std::vector<char> chunkValid(numChunks, 1);
+    runInParallel(numChunks, numChunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        for(size_t c = chunkStart; c < chunkEnd; c++)
+        {
+            chunkEntries[c].reserve((chunkStarts[c + 1] - chunkStarts[c]) / 16);
+            chunkValid[c] = parseEntries(chunkStarts[c], chunkStarts[c + 1], isPattern, symmetry, numRows, numColumns, chunkEntries[c]);
+            std::sort(chunkEntries[c].begin(), chunkEntries[c].end(), isBefore);
+        }
+    });
+    size_t numParsed = 0;
+    for(size_t c = 0; c < numChunks; c++)
+    {
+        if(!chunkValid[c])
+        {
+            error = "malformed entry";
+            return SparseMatrix();
+        }
+        numParsed += chunkEntries[c].size();
+    }
+    // Concatenate the sorted chunks, and merge them pairwise (in parallel) in rounds.
+    std::vector<SparseMatrixEntry> entries;
+    entries.reserve(numParsed);
+    std::vector<size_t> boundaries = {0};
+    size_t numLines = 0;
+    for(auto& e: chunkEntries)
+    {
+        for(const auto& entry: e)
+        {
+            numLines += ((symmetry == GENERAL) || (entry.row <= entry.column)) ? 1 : 0;
+        }
+        entries.insert(entries.end(), e.begin(), e.end());
+        boundaries.push_back(entries.size());
+        std::vector<SparseMatrixEntry>().swap(e);
+    }
+    if(numLines != numEntries)
+    {
+        error = "expected " + std::to_string(numEntries) + " entries, found " + std::to_string(numLines);
+        return SparseMatrix();
+    }
+    while(boundaries.size() > 2)
+    {
+        size_t numMerges = (boundaries.size() - 1) / 2;
+        runInParallel(numMerges, numMerges, [&](size_t, size_t chunkStart, size_t chunkEnd)
+        {
+            for(size_t m = chunkStart; m < chunkEnd; m++)
+            {
+                std::inplace_merge(entries.begin() + boundaries[2 * m], entries.begin() + boundaries[2 * m + 1], entries.begin() + boundaries[2 * m + 2], isBefore);
+            }
+        });
+        std::vector<size_t> merged;
+        for(size_t b = 0; b < boundaries.size(); b += 2)
+        {
+            merged.push_back(boundaries[b]);
+        }
+        if(merged.back() != boundaries.back())
+        {
+            merged.push_back(boundaries.back());
+        }
+        boundaries.swap(merged);
+    }
+    // Sum repeated entries.
+    size_t numUnique = 0;
+    for(size_t k = 0; k < entries.size(); k++)
+    {
+        if((numUnique > 0) && (entries[numUnique - 1].row == entries[k].row) && (entries[numUnique - 1].column == entries[k].column))
+        {
+            entries[numUnique - 1].value += entries[k].value;
+        }
+        else
+        {
+            entries[numUnique++] = entries[k];
+        }
+    }
+    entries.resize(numUnique);
+    return SparseMatrix(0, numRows, numColumns, entries);
+}
+
+bool writeMatrixMarketFile(const std::string& path, const SparseMatrix& sm)
+{
+    if(sm.getDefaultValue() != 0)
+    {
+        return false;
+    }
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if(!stream.is_open())
+    {
+        return false;
+    }
+    stream << "%%MatrixMarket matrix coordinate real general\n";
+    BufferedWriter writer(stream);
+    writer.append(sm.getNumRows(), ' ');
+    writer.append(sm.getNumColumns(), ' ');
+    writer.append(sm.getNumStoredElements(), '\n');
+    for(const auto& row: sm.getData())
+    {
+        for(const auto& e: row.second.getData())
+        {
+            writer.append(row.first + 1, ' ');
+            writer.append(e.first + 1, ' ');
+            writer.append(e.second, '\n');
+        }
+    }
+    writer.flush();
+    stream.close();
+    return !stream.fail();
+}
\ No newline at end of file
@@ -0,0 +1,777 @@
+#include "npy_io.hpp"
+#include "matrix.hpp"
+#include "vectr.hpp"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    const char NPY_MAGIC[6] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+    // The header is padded so that the elements start at a multiple of this.
+    const size_t NPY_HEADER_ALIGNMENT = 64;
+    const size_t WRITE_BUFFER_SIZE = 65536;
+    const uint32_t ZIP_LOCAL_HEADER_SIGNATURE = 0x04034b50;
+    const uint32_t ZIP_CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+    const uint32_t ZIP_END_SIGNATURE = 0x06054b50;
+    const uint32_t ZIP64_END_SIGNATURE = 0x06064b50;
+    const uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+    const size_t ZIP_LOCAL_HEADER_SIZE = 30;
+    const size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+    const size_t ZIP_END_SIZE = 22;
+    const uint32_t ZIP32_LIMIT = 0xffffffff;
+    // Version 2.0 of the zip format, and the date 1980-01-01 in MS-DOS format.
+    const uint16_t ZIP_VERSION = 20;
+    const uint16_t ZIP_DATE = 0x21;
+
+    bool isLittleEndianMachine()
+    {
+        uint16_t word = 1;
+        unsigned char firstByte;
+        memcpy(&firstByte, &word, 1);
+        return firstByte == 1;
+    }
+
+    // Little-endian integers of the zip and .npy headers.
+    uint64_t readInteger(const char* data, size_t numBytes)
+    {
+        uint64_t value = 0;
+        for(size_t i = numBytes; i-- > 0;)
+        {
+            value = (value << 8) | static_cast<unsigned char>(data[i]);
+        }
+        return value;
+    }
+
+    void appendInteger(std::string& s, uint64_t value, size_t numBytes)
+    {
+        assert(numBytes <= 8);
+        for(size_t i = 0; i < numBytes; i++)
+        {
+            s.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    // CRC-32 of the zip format (polynomial 0xedb88320), continued from crc.
+    uint32_t getCRC32(const char* data, size_t size, uint32_t crc)
+    {
+        static const std::vector<uint32_t> table = []()
+        {
+            std::vector<uint32_t> t(256);
+            for(uint32_t n = 0; n < 256; n++)
+            {
+                uint32_t c = n;
+                for(int k = 0; k < 8; k++)
+                {
+                    c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+                }
+                t[n] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for(size_t i = 0; i < size; i++)
+        {
+            crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    // The text following key in the header dictionary, after the colon and spaces.
+    const char* findValue(const std::string& header, const std::string& key)
+    {
+        size_t position = header.find("'" + key + "'");
+        if(position == std::string::npos)
+        {
+            return nullptr;
+        }
+        position = header.find(':', position);
+        if(position == std::string::npos)
+        {
+            return nullptr;
+        }
+        position = header.find_first_not_of(' ', position + 1);
+        return (position == std::string::npos) ? nullptr : (header.c_str() + position);
+    }
+
+    bool parseShape(const char* text, std::vector<size_t>& shape)
+    {
+        if(*text != '(')
+        {
+            return false;
+        }
+        text++;
+        while(true)
+        {
+            while(*text == ' ')
+            {
+                text++;
+            }
+            if(*text == ')')
+            {
+                return true;
+            }
+            size_t n;
+            auto r = std::from_chars(text, text + strlen(text), n);
+            if(r.ec != std::errc())
+            {
+                return false;
+            }
+            shape.push_back(n);
+            text = r.ptr;
+            while(*text == ' ')
+            {
+                text++;
+            }
+            if(*text == ',')
+            {
+                text++;
+            }
+            else if(*text != ')')
+            {
+                return false;
+            }
+        }
+    }
+
+    std::string getNpyHeader(const std::vector<size_t>& shape, NpyDataTypeEnum dataType, bool fortranOrder)
+    {
+        std::string header = "{'descr': '<f";
+        header += (dataType == NPY_FLOAT32) ? "4" : "8";
+        header += "', 'fortran_order': ";
+        header += fortranOrder ? "True" : "False";
+        header += ", 'shape': (";
+        for(size_t i = 0; i < shape.size(); i++)
+        {
+            header += std::to_string(shape[i]) + ((shape.size() == 1) ? "," : ((i + 1 < shape.size()) ? ", " : ""));
+        }
+        header += "), }";
+        // Magic, version and length, then the dictionary padded with spaces and a newline.
+        size_t length = sizeof(NPY_MAGIC) + 4 + header.size() + 1;
+        header.append((NPY_HEADER_ALIGNMENT - length % NPY_HEADER_ALIGNMENT) % NPY_HEADER_ALIGNMENT, ' ');
+        header += '\n';
+        std::string prefix(NPY_MAGIC, sizeof(NPY_MAGIC));
+        prefix += '\x01';
+        prefix += '\x00';
+        appendInteger(prefix, header.size(), 2);
+        return prefix + header;
+    }
+
+    // Writes .npy images through a buffer, keeping track of their size and checksum.
+    class NpyWriter
+    {
+        std::ostream& m_stream;
+        std::vector<char> m_buffer;
+        size_t m_size;
+        uint64_t m_totalSize;
+        uint32_t m_crc;
+    public:
+        NpyWriter(std::ostream& stream)
+        :m_stream(stream), m_buffer(WRITE_BUFFER_SIZE), m_size(0), m_totalSize(0), m_crc(0)
+        {
+        }
+
+        void write(const char* data, size_t size)
+        {
+            if(m_size + size > m_buffer.size())
+            {
+                flush();
+            }
+            if(size > m_buffer.size())
+            {
+                m_stream.write(data, size);
+                m_crc = getCRC32(data, size, m_crc);
+                m_totalSize += size;
+                return;
+            }
+            memcpy(m_buffer.data() + m_size, data, size);
+            m_size += size;
+        }
+
+        void flush()
+        {
+            m_stream.write(m_buffer.data(), m_size);
+            m_crc = getCRC32(m_buffer.data(), m_size, m_crc);
+            m_totalSize += m_size;
+            m_size = 0;
+        }
+
+        // Writes the header and the elements getElement(i, j) of the numRows x numColumns
+        // array, as little-endian values of the given type.
+        template <typename Getter>
+        void writeArray(const std::vector<size_t>& shape, NpyDataTypeEnum dataType, bool fortranOrder, size_t numRows, size_t numColumns, const Getter& getElement)
+        {
+            std::string header = getNpyHeader(shape, dataType, fortranOrder);
+            write(header.data(), header.size());
+            bool swap = !isLittleEndianMachine();
+            size_t outerSize = fortranOrder ? numColumns : numRows;
+            size_t innerSize = fortranOrder ? numRows : numColumns;
+            for(size_t outer = 0; outer < outerSize; outer++)
+            {
+                for(size_t inner = 0; inner < innerSize; inner++)
+                {
+                    double value = fortranOrder ? getElement(inner, outer) : getElement(outer, inner);
+                    char bytes[8];
+                    size_t numBytes = (dataType == NPY_FLOAT32) ? 4 : 8;
+                    if(dataType == NPY_FLOAT32)
+                    {
+                        float f = static_cast<float>(value);
+                        memcpy(bytes, &f, 4);
+                    }
+                    else
+                    {
+                        memcpy(bytes, &value, 8);
+                    }
+                    if(swap)
+                    {
+                        std::reverse(bytes, bytes + numBytes);
+                    }
+                    write(bytes, numBytes);
+                }
+            }
+            flush();
+        }
+
+        uint64_t getTotalSize() const
+        {
+            return m_totalSize;
+        }
+
+        uint32_t getCRC() const
+        {
+            return m_crc;
+        }
+    };
+
+    std::vector<size_t> getShape(const Matrix& m)
+    {
+        return {m.getNumRows(), m.getNumColumns()};
+    }
+
+    // The archive members, from the central directory at the end of the file.
+    struct ZipMember
+    {
+        std::string name;
+        uint16_t method;
+        uint64_t compressedSize;
+        uint64_t size;
+        uint64_t offset;
+    };
+
+    bool readZipDirectory(const MappedFile& file, std::vector<ZipMember>& members, std::string& error)
+    {
+        const char* data = file.getData();
+        size_t fileSize = file.getSize();
+        // The end record is followed by a comment of at most 65535 bytes.
+        size_t end = std::string::npos;
+        for(size_t p = (fileSize < ZIP_END_SIZE) ? 0 : (fileSize - ZIP_END_SIZE + 1); (p-- > 0) && (p + ZIP_END_SIZE + 65535 >= fileSize);)
+        {
+            if(readInteger(data + p, 4) == ZIP_END_SIGNATURE)
+            {
+                end = p;
+                break;
+            }
+        }
+        if(end == std::string::npos)
+        {
+            error = "not a zip archive";
+            return false;
+        }
+        uint64_t numMembers = readInteger(data + end + 10, 2);
+        uint64_t directoryOffset = readInteger(data + end + 16, 4);
+        if((numMembers == 0xffff) || (directoryOffset == ZIP32_LIMIT))
+        {
+            // Zip64: a locator right before the end record points to the zip64 end record.
+            if((end < 20) || (readInteger(data + end - 20, 4) != ZIP64_LOCATOR_SIGNATURE))
+            {
+                error = "missing zip64 end record";
+                return false;
+            }
+            uint64_t end64 = readInteger(data + end - 12, 8);
+            if((end64 + 56 > fileSize) || (readInteger(data + end64, 4) != ZIP64_END_SIGNATURE))
+            {
+                error = "invalid zip64 end record";
+                return false;
+            }
+            numMembers = readInteger(data + end64 + 32, 8);
+            directoryOffset = readInteger(data + end64 + 48, 8);
+        }
+        size_t p = directoryOffset;
+        for(uint64_t m = 0; m < numMembers; m++)
+        {
+            if((p + ZIP_CENTRAL_HEADER_SIZE > fileSize) || (readInteger(data + p, 4) != ZIP_CENTRAL_HEADER_SIGNATURE))
+            {
+                error = "invalid zip central directory";
+                return false;
+            }
+            ZipMember member;
+            member.method = readInteger(data + p + 10, 2);
+            member.compressedSize = readInteger(data + p + 20, 4);
+            member.size = readInteger(data + p + 24, 4);
+            size_t nameLength = readInteger(data + p + 28, 2);
+            size_t extraLength = readInteger(data + p + 30, 2);
+            size_t commentLength = readInteger(data + p + 32, 2);
+            member.offset = readInteger(data + p + 42, 4);
+            if(p + ZIP_CENTRAL_HEADER_SIZE + nameLength + extraLength > fileSize)
+            {
+                error = "invalid zip central directory";
+                return false;
+            }
+            member.name.assign(data + p + ZIP_CENTRAL_HEADER_SIZE, nameLength);
+            // The zip64 extra field holds the 64-bit values of the fields set to 0xffffffff.
+            const char* extra = data + p + ZIP_CENTRAL_HEADER_SIZE + nameLength;
+            for(size_t e = 0; e + 4 <= extraLength;)
+            {
+                size_t id = readInteger(extra + e, 2);
+                size_t length = readInteger(extra + e + 2, 2);
+                if(id == 1)
+                {
+                    size_t q = e + 4;
+                    for(uint64_t* field: {&member.size, &member.compressedSize, &member.offset})
+                    {
+                        if((*field == ZIP32_LIMIT) && (q + 8 <= e + 4 + length))
+                        {
+                            *field = readInteger(extra + q, 8);
+                            q += 8;
+                        }
+                    }
+                }
+                e += 4 + length;
+            }
+            members.push_back(member);
+            p += ZIP_CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+        }
+        return true;
+    }
+}
+
+NpyArray::NpyArray()
+{
+    m_data = nullptr;
+    m_dataType = NPY_FLOAT64;
+    m_isFortranOrder = false;
+    m_isByteSwapped = false;
+    m_numRows = 0;
+    m_numColumns = 0;
+}
+
+NpyArray::NpyArray(const std::shared_ptr<MappedFile>& file, const char* data, size_t size, std::string& error)
+:NpyArray()
+{
+    error.clear();
+    if((size < 10) || (memcmp(data, NPY_MAGIC, sizeof(NPY_MAGIC)) != 0))
+    {
+        error = "not a .npy array";
+        return;
+    }
+    int majorVersion = static_cast<unsigned char>(data[6]);
+    if((majorVersion < 1) || (majorVersion > 3))
+    {
+        error = "unsupported .npy format version " + std::to_string(majorVersion);
+        return;
+    }
+    size_t lengthSize = (majorVersion == 1) ? 2 : 4;
+    size_t headerStart = 8 + lengthSize;
+    if(size < headerStart)
+    {
+        error = "the array is truncated";
+        return;
+    }
+    size_t headerLength = readInteger(data + 8, lengthSize);
+    if(size < headerStart + headerLength)
+    {
+        error = "the array is truncated";
+        return;
+    }
+    std::string header(data + headerStart, headerLength);
+    const char* descr = findValue(header, "descr");
+    const char* fortranOrder = findValue(header, "fortran_order");
+    const char* shape = findValue(header, "shape");
+    if((descr == nullptr) || (fortranOrder == nullptr) || (shape == nullptr))
+    {
+        error = "invalid .npy header";
+        return;
+    }
+    std::string type(descr, strcspn(descr, ",}"));
+    bool isLittleEndian;
+    if((type == "'<f8'") || (type == "'<f4'"))
+    {
+        isLittleEndian = true;
+    }
+    else if((type == "'>f8'") || (type == "'>f4'"))
+    {
+        isLittleEndian = false;
+    }
+    else if((type == "'=f8'") || (type == "'=f4'"))
+    {
+        isLittleEndian = isLittleEndianMachine();
+    }
+    else
+    {
+        error = "unsupported element type " + type + " (only float32 and float64 are supported)";
+        return;
+    }
+    std::vector<size_t> dimensions = {};
+    if(!parseShape(shape, dimensions) || ((strncmp(fortranOrder, "True", 4) != 0) && (strncmp(fortranOrder, "False", 5) != 0)))
+    {
+        error = "invalid .npy header";
+        return;
+    }
+    if(dimensions.size() > 2)
+    {
+        error = "only arrays of up to 2 dimensions are supported";
+        return;
+    }
+    NpyDataTypeEnum dataType = (type[3] == '4') ? NPY_FLOAT32 : NPY_FLOAT64;
+    size_t numRows = (dimensions.size() == 2) ? dimensions[0] : 1;
+    size_t numColumns = (dimensions.size() == 0) ? 1 : dimensions.back();
+    size_t elementSize = (dataType == NPY_FLOAT32) ? sizeof(float) : sizeof(double);
+    if(size - headerStart - headerLength < numRows * numColumns * elementSize)
+    {
+        error = "the array is truncated";
+        return;
+    }
+    m_file = file;
+    m_data = data + headerStart + headerLength;
+    m_shape = dimensions;
+    m_dataType = dataType;
+    m_isFortranOrder = (strncmp(fortranOrder, "True", 4) == 0);
+    m_isByteSwapped = (isLittleEndian != isLittleEndianMachine());
+    m_numRows = numRows;
+    m_numColumns = numColumns;
+}
+
+const std::vector<size_t>& NpyArray::getShape() const
+{
+    return m_shape;
+}
+
+size_t NpyArray::getNumDimensions() const
+{
+    return m_shape.size();
+}
+
+size_t NpyArray::getNumRows() const
+{
+    return m_numRows;
+}
+
+size_t NpyArray::getNumColumns() const
+{
+    return m_numColumns;
+}
+
+size_t NpyArray::size() const
+{
+    return m_numRows * m_numColumns;
+}
+
+NpyDataTypeEnum NpyArray::getDataType() const
+{
+    return m_dataType;
+}
+
+bool NpyArray::isFortranOrder() const
+{
+    return m_isFortranOrder;
+}
+
+double NpyArray::getElement(size_t k) const
+{
+    assert(k < size());
+    // memcpy, because the elements of a .npz member need not be aligned.
+    if(m_dataType == NPY_FLOAT32)
+    {
+        char bytes[4];
+        memcpy(bytes, m_data + k * 4, 4);
+        if(m_isByteSwapped)
+        {
+            std::reverse(bytes, bytes + 4);
+        }
+        float value;
+        memcpy(&value, bytes, 4);
+        return value;
+    }
+    char bytes[8];
+    memcpy(bytes, m_data + k * 8, 8);
+    if(m_isByteSwapped)
+    {
+        std::reverse(bytes, bytes + 8);
+    }
+    double value;
+    memcpy(&value, bytes, 8);
+    return value;
+}
+
+double NpyArray::operator()(size_t i, size_t j) const
+{
+    assert((i < m_numRows) && (j < m_numColumns));
+    return getElement(m_isFortranOrder ? (j * m_numRows + i) : (i * m_numColumns + j));
+}
+
+NpyArray::Row NpyArray::operator[](size_t i) const
+{
+    assert(i < m_numRows);
+    return Row(*this, i);
+}
+
+const double* NpyArray::getDoubleData() const
+{
+    bool inPlace = (m_data != nullptr) && (m_dataType == NPY_FLOAT64) && !m_isByteSwapped;
+    inPlace = inPlace && (reinterpret_cast<uintptr_t>(m_data) % alignof(double) == 0);
+    return inPlace ? reinterpret_cast<const double*>(m_data) : nullptr;
+}
+
+const float* NpyArray::getFloatData() const
+{
+    bool inPlace = (m_data != nullptr) && (m_dataType == NPY_FLOAT32) && !m_isByteSwapped;
+    inPlace = inPlace && (reinterpret_cast<uintptr_t>(m_data) % alignof(float) == 0);
+    return inPlace ? reinterpret_cast<const float*>(m_data) : nullptr;
+}
+
+Matrix NpyArray::getMatrix() const
+{
+    // Matrix has no shape with rows but no columns.
+    if(m_numRows == 0)
+    {
+        return Matrix();
+    }
+    LinalgArray<LinalgArray<double> > r(m_numRows, LinalgArray<double>(m_numColumns));
+    for(size_t i = 0; i < m_numRows; i++)
+    {
+        for(size_t j = 0; j < m_numColumns; j++)
+        {
+            r[i][j] = (*this)(i, j);
+        }
+    }
+    return Matrix(std::move(r));
+}
+
+Vector NpyArray::getVector() const
+{
+    LinalgArray<double> r(size());
+    const double* data = getDoubleData();
+    if((data != nullptr) && !m_isFortranOrder)
+    {
+        std::copy(data, data + r.size(), r.begin());
+        return Vector(std::move(r));
+    }
+    for(size_t k = 0; k < r.size(); k++)
+    {
+        r[k] = (*this)(k / m_numColumns, k % m_numColumns);
+    }
+    return Vector(std::move(r));
+}
+
+NpyArray readNpyFile(const std::string& path, std::string& error)
+{
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+    if(!file->isOpen())
+    {
+        error = "the file could not be opened";
+        return NpyArray();
+    }
+    return NpyArray(file, file->getData(), file->getSize(), error);
+}
+
+bool writeNpyFile(const std::string& path, const Matrix& m, NpyDataTypeEnum dataType, bool fortranOrder)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if(!stream.is_open())
+    {
+        return false;
+    }
+    NpyWriter writer(stream);
+    writer.writeArray(getShape(m), dataType, fortranOrder, m.getNumRows(), m.getNumColumns(), [&m](size_t i, size_t j) { return m[i][j]; });
+    stream.close();
+    return !stream.fail();
+}
+
+bool writeNpyFile(const std::string& path, const Vector& v, NpyDataTypeEnum dataType)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if(!stream.is_open())
+    {
+        return false;
+    }
+    NpyWriter writer(stream);
+    writer.writeArray({v.size()}, dataType, false, 1, v.size(), [&v](size_t, size_t j) { return v[j]; });
+    stream.close();
+    return !stream.fail();
+}
+
+std::map<std::string, NpyArray> readNpzFile(const std::string& path, std::string& error)
+{
+    error.clear();
+    std::map<std::string, NpyArray> arrays = {};
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+    if(!file->isOpen())
+    {
+        error = "the file could not be opened";
+        return arrays;
+    }
+    std::vector<ZipMember> members = {};
+    if(!readZipDirectory(*file, members, error))
+    {
+        return arrays;
+    }
+    const char* data = file->getData();
+    for(const ZipMember& member: members)
+    {
+        if(member.method != 0)
+        {
+            error = "the member " + member.name + " is compressed";
+            break;
+        }
+        if((member.offset + ZIP_LOCAL_HEADER_SIZE > file->getSize()) || (readInteger(data + member.offset, 4) != ZIP_LOCAL_HEADER_SIGNATURE))
+        {
+            error = "invalid local header of the member " + member.name;
+            break;
+        }
+        size_t start = member.offset + ZIP_LOCAL_HEADER_SIZE + readInteger(data + member.offset + 26, 2) + readInteger(data + member.offset + 28, 2);
+        if(start + member.size > file->getSize())
+        {
+            error = "the member " + member.name + " is truncated";
+            break;
+        }
+        std::string name = member.name;
+        if((name.size() >= 4) && (name.compare(name.size() - 4, 4, ".npy") == 0))
+        {
+            name.resize(name.size() - 4);
+        }
+        NpyArray array(file, data + start, member.size, error);
+        if(!error.empty())
+        {
+            error = "the member " + member.name + ": " + error;
+            break;
+        }
+        arrays[name] = array;
+    }
+    if(!error.empty())
+    {
+        arrays.clear();
+    }
+    return arrays;
+}
+
+NpzWriter::NpzWriter(const std::string& path)
+:m_stream(path, std::ios::binary | std::ios::trunc)
+{
+    m_isValid = m_stream.is_open();
+    m_isClosed = false;
+}
+
+NpzWriter::~NpzWriter()
+{
+    close();
+}
+
+template <typename Getter>
+bool NpzWriter::add(const std::string& name, const std::vector<size_t>& shape, NpyDataTypeEnum dataType, bool fortranOrder, const Getter& getElement)
+{
+    assert(!m_isClosed);
+    if(!m_isValid)
+    {
+        return false;
+    }
+    Member member;
+    member.name = name + ".npy";
+    member.offset = m_stream.tellp();
+    // The local header is written with zero sizes and checksum, which are filled in
+    // once the array has been written.
+    std::string localHeader = {};
+    appendInteger(localHeader, ZIP_LOCAL_HEADER_SIGNATURE, 4);
+    appendInteger(localHeader, ZIP_VERSION, 2);
+    appendInteger(localHeader, 0, 2);
+    appendInteger(localHeader, 0, 2);
+    appendInteger(localHeader, 0, 2);
+    appendInteger(localHeader, ZIP_DATE, 2);
+    localHeader.append(12, '\0');
+    appendInteger(localHeader, member.name.size(), 2);
+    appendInteger(localHeader, 0, 2);
+    localHeader += member.name;
+    m_stream.write(localHeader.data(), localHeader.size());
+    size_t numRows = (shape.size() == 2) ? shape[0] : 1;
+    size_t numColumns = shape.back();
+    NpyWriter writer(m_stream);
+    writer.writeArray(shape, dataType, fortranOrder, numRows, numColumns, getElement);
+    member.crc = writer.getCRC();
+    member.size = writer.getTotalSize();
+    uint64_t end = m_stream.tellp();
+    if((member.size >= ZIP32_LIMIT) || (end >= ZIP32_LIMIT))
+    {
+        m_isValid = false;
+        return false;
+    }
+    std::string sizes = {};
+    appendInteger(sizes, member.crc, 4);
+    appendInteger(sizes, member.size, 4);
+    appendInteger(sizes, member.size, 4);
+    m_stream.seekp(member.offset + 14);
+    m_stream.write(sizes.data(), sizes.size());
+    m_stream.seekp(end);
+    m_members.push_back(member);
+    m_isValid = !m_stream.fail();
+    return m_isValid;
+}
+
+bool NpzWriter::add(const std::string& name, const Matrix& m, NpyDataTypeEnum dataType, bool fortranOrder)
+{
+    return add(name, getShape(m), dataType, fortranOrder, [&m](size_t i, size_t j) { return m[i][j]; });
+}
+
+bool NpzWriter::add(const std::string& name, const Vector& v, NpyDataTypeEnum dataType)
+{
+    return add(name, {v.size()}, dataType, false, [&v](size_t, size_t j) { return v[j]; });
+}
+
+bool NpzWriter::close()
+{
+    if(m_isClosed)
+    {
+        return m_isValid;
+    }
+    m_isClosed = true;
+    if(!m_isValid)
+    {
+        return false;
+    }
+    std::string directory = {};
+    for(const Member& member: m_members)
+    {
+        appendInteger(directory, ZIP_CENTRAL_HEADER_SIGNATURE, 4);
+        appendInteger(directory, ZIP_VERSION, 2);
+        appendInteger(directory, ZIP_VERSION, 2);
+        appendInteger(directory, 0, 2);
+        appendInteger(directory, 0, 2);
+        appendInteger(directory, 0, 2);
+        appendInteger(directory, ZIP_DATE, 2);
+        appendInteger(directory, member.crc, 4);
+        appendInteger(directory, member.size, 4);
+        appendInteger(directory, member.size, 4);
+        appendInteger(directory, member.name.size(), 2);
+        directory.append(12, '\0');
+        appendInteger(directory, member.offset, 4);
+        directory += member.name;
+    }
+    uint64_t directoryOffset = m_stream.tellp();
+    uint64_t directorySize = directory.size();
+    if(directoryOffset + directorySize >= ZIP32_LIMIT)
+    {
+        m_isValid = false;
+        return false;
+    }
+    appendInteger(directory, ZIP_END_SIGNATURE, 4);
+    appendInteger(directory, 0, 4);
+    appendInteger(directory, m_members.size(), 2);
+    appendInteger(directory, m_members.size(), 2);
+    appendInteger(directory, directorySize, 4);
+    appendInteger(directory, directoryOffset, 4);
+    appendInteger(directory, 0, 2);
+    m_stream.write(directory.data(), directory.size());
+    m_stream.close();
+    m_isValid = !m_stream.fail();
+    return m_isValid;
+}
\ No newline at end of file
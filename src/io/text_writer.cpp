@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstring>
+#include <map>
+#include "text_writer.hpp"
+#include "matrix.hpp"
+#include "vectr.hpp"
+#include "sparse_matrix.hpp"
+#include "sparse_vector.hpp"
+
+namespace
+{
+    // Enough for the sign, the 309 integer digits of the largest double and the point.
+    const size_t MAX_FIXED_LENGTH = 312;
+
+    // Writes the stored elements of a row, and the default value in between, each padded
+    // to the width; the padded default value is given by defaultText.
+    template <typename T>
+    void writeSparseRow(TextWriter& writer, const LinalgMap<T>& data, size_t size, const std::string& defaultText, size_t width)
+    {
+        size_t next = 0;
+        for(const auto& e: data)
+        {
+            for(; next < e.first; next++)
+            {
+                writer.write(defaultText.data(), defaultText.size());
+            }
+            writer.writeValue(e.second, width);
+            next = e.first + 1;
+        }
+        for(; next < size; next++)
+        {
+            writer.write(defaultText.data(), defaultText.size());
+        }
+    }
+
+    template <typename T>
+    size_t getMaxLength(TextWriter& writer, const LinalgMap<T>& data)
+    {
+        size_t width = 0;
+        for(const auto& e: data)
+        {
+            width = std::max(width, writer.getLength(e.second));
+        }
+        return width;
+    }
+
+    template <typename T>
+    std::string getPaddedText(TextWriter& writer, const T& value, size_t width)
+    {
+        std::string text;
+        {
+            TextWriter valueWriter(text, writer.getPrecision(), width + 1);
+            valueWriter.writeValue(value, width);
+        }
+        return text;
+    }
+}
+
+TextWriter::TextWriter(const std::function<void(const char*, size_t)>& sink, int precision, size_t chunkSize)
+:m_sink(sink), m_buffer(std::max(chunkSize, size_t(1))), m_size(0), m_precision(precision),
+m_valueBuffer(MAX_FIXED_LENGTH + precision)
+{
+    assert(precision >= 0);
+}
+
+TextWriter::TextWriter(std::ostream& stream, int precision, size_t chunkSize)
+:TextWriter([&stream](const char* data, size_t count) { stream.write(data, count); }, precision, chunkSize)
+{
+}
+
+TextWriter::TextWriter(std::string& text, int precision, size_t chunkSize)
+:TextWriter([&text](const char* data, size_t count) { text.append(data, count); }, precision, chunkSize)
+{
+}
+
+TextWriter::~TextWriter()
+{
+    flush();
+}
+
+int TextWriter::getPrecision() const
+{
+    return m_precision;
+}
+
+size_t TextWriter::formatValue(double value)
+{
+    char* begin = m_valueBuffer.data();
+    auto r = std::to_chars(begin, begin + m_valueBuffer.size(), value, std::chars_format::fixed, m_precision);
+    return r.ptr - begin;
+}
+
+size_t TextWriter::getLength(double value)
+{
+    return formatValue(value);
+}
+
+void TextWriter::write(const char* data, size_t count)
+{
+    while(count > 0)
+    {
+        if(m_size == m_buffer.size())
+        {
+            flush();
+        }
+        size_t n = std::min(count, m_buffer.size() - m_size);
+        std::memcpy(m_buffer.data() + m_size, data, n);
+        m_size += n;
+        data += n;
+        count -= n;
+    }
+}
+
+void TextWriter::write(char c)
+{
+    if(m_size == m_buffer.size())
+    {
+        flush();
+    }
+    m_buffer[m_size++] = c;
+}
+
+size_t TextWriter::getLength(const std::complex<double>& value)
+{
+    return formatValue(value.real()) + formatValue(value.imag()) + 3;
+}
+
+void TextWriter::writeValue(double value, size_t width)
+{
+    size_t length = formatValue(value);
+    write(m_valueBuffer.data(), length);
+    for(; length < width; length++)
+    {
+        write(' ');
+    }
+    write(' ');
+}
+
+void TextWriter::writeValue(const std::complex<double>& value, size_t width)
+{
+    write('(');
+    size_t length = formatValue(value.real());
+    write(m_valueBuffer.data(), length);
+    write(',');
+    size_t imaginaryLength = formatValue(value.imag());
+    write(m_valueBuffer.data(), imaginaryLength);
+    write(')');
+    for(length += imaginaryLength + 3; length < width; length++)
+    {
+        write(' ');
+    }
+    write(' ');
+}
+
+void TextWriter::flush()
+{
+    if(m_size > 0)
+    {
+        m_sink(m_buffer.data(), m_size);
+        m_size = 0;
+    }
+}
+
+template <typename T>
+void writeText(TextWriter& writer, const BasicMatrix<T>& m)
+{
+    writeMatrixText(writer, m.getData(), m.getNumRows(), m.getNumColumns());
+}
+
+template <typename T>
+void writeText(TextWriter& writer, const BasicVector<T>& v)
+{
+    writeVectorText(writer, v.getData(), v.size());
+}
+
+template <typename T>
+void writeText(TextWriter& writer, const BasicSparseMatrix<T>& sm)
+{
+    size_t numRows = sm.getNumRows();
+    size_t numColumns = sm.getNumColumns();
+    const LinalgMap<BasicSparseVector<T> >& rows = sm.getData();
+    size_t width = 0;
+    bool hasDefault = (rows.size() < numRows) && (numColumns > 0);
+    for(const auto& row: rows)
+    {
+        const LinalgMap<T>& data = row.second.getData();
+        width = std::max(width, getMaxLength(writer, data));
+        hasDefault = hasDefault || (data.size() < numColumns);
+    }
+    if(hasDefault)
+    {
+        width = std::max(width, writer.getLength(sm.getDefaultValue()));
+    }
+    std::string defaultText = getPaddedText(writer, sm.getDefaultValue(), width);
+    const LinalgMap<T> emptyRow;
+    auto it = rows.begin();
+    for(size_t i = 0; i < numRows; i++)
+    {
+        if((it != rows.end()) && (it->first == i))
+        {
+            writeSparseRow(writer, it->second.getData(), numColumns, defaultText, width);
+            it++;
+        }
+        else
+        {
+            writeSparseRow(writer, emptyRow, numColumns, defaultText, width);
+        }
+        writer.write('\n');
+    }
+}
+
+template <typename T>
+void writeText(TextWriter& writer, const BasicSparseVector<T>& sv)
+{
+    const LinalgMap<T>& data = sv.getData();
+    size_t width = getMaxLength(writer, data);
+    if(data.size() < sv.size())
+    {
+        width = std::max(width, writer.getLength(sv.getDefaultValue()));
+    }
+    std::string defaultText = getPaddedText(writer, sv.getDefaultValue(), width);
+    writeSparseRow(writer, data, sv.size(), defaultText, width);
+}
+
+template void writeText(TextWriter& writer, const BasicMatrix<float>& m);
+template void writeText(TextWriter& writer, const BasicMatrix<double>& m);
+template void writeText(TextWriter& writer, const BasicMatrix<std::complex<double> >& m);
+template void writeText(TextWriter& writer, const BasicVector<float>& v);
+template void writeText(TextWriter& writer, const BasicVector<double>& v);
+template void writeText(TextWriter& writer, const BasicVector<std::complex<double> >& v);
+template void writeText(TextWriter& writer, const BasicSparseMatrix<float>& sm);
+template void writeText(TextWriter& writer, const BasicSparseMatrix<double>& sm);
+template void writeText(TextWriter& writer, const BasicSparseMatrix<std::complex<double> >& sm);
+template void writeText(TextWriter& writer, const BasicSparseVector<float>& sv);
+template void writeText(TextWriter& writer, const BasicSparseVector<double>& sv);
+template void writeText(TextWriter& writer, const BasicSparseVector<std::complex<double> >& sv);
\ No newline at end of file
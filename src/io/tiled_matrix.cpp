@@ -0,0 +1,748 @@
+#include "tiled_matrix.hpp"
+#include "binary_io.hpp"
+#include "matrix.hpp"
+#include "vectr.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // The tiles start right after the header, which is a multiple of the alignment.
+    const size_t PAYLOAD_OFFSET = BINARY_HEADER_SIZE;
+    static_assert(BINARY_HEADER_SIZE % BINARY_ALIGNMENT == 0, "The payload must be aligned");
+
+    size_t getNumTiles(size_t n, size_t tileSize)
+    {
+        return (n + tileSize - 1) / tileSize;
+    }
+
+    // Creates the file with the header and zeros for the tiles.
+    bool createTiledMatrixFile(const std::string& path, size_t numRows, size_t numColumns, size_t tileSize)
+    {
+        size_t numStored = getNumTiles(numRows, tileSize) * getNumTiles(numColumns, tileSize) * tileSize * tileSize;
+        BinaryFileHeader header = getBinaryFileHeader(BINARY_TILED_MATRIX, numRows, numColumns, numStored, 0);
+        header.tileSize = tileSize;
+        char buffer[BINARY_HEADER_SIZE] = {};
+        memcpy(buffer, &header, sizeof(header));
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0)
+        {
+            return false;
+        }
+        // The file is extended with ftruncate, so the tiles take no disk space until written.
+        bool written = (pwrite(fd, buffer, BINARY_HEADER_SIZE, 0) == (ssize_t)BINARY_HEADER_SIZE);
+        written = written && (ftruncate(fd, PAYLOAD_OFFSET + numStored * sizeof(double)) == 0);
+        close(fd);
+        return written;
+    }
+
+    struct TileReference
+    {
+        const TiledMatrix* matrix;
+        size_t tileRow;
+        size_t tileColumn;
+    };
+
+    // Calls process(s, tiles) for the steps s = 0, ..., numSteps - 1 in order, where
+    // tiles[t] is a copy of the tile getTiles(s)[t], which process may modify. The tiles
+    // of step s + 1 are copied on another thread while step s is processed.
+    template <typename GetTiles, typename Process>
+    void streamTiles(size_t numSteps, size_t tileLength, const GetTiles& getTiles, const Process& process)
+    {
+        std::vector<std::vector<double> > current = {};
+        std::vector<std::vector<double> > next = {};
+        auto load = [&getTiles, tileLength](size_t s, std::vector<std::vector<double> >& buffers)
+        {
+            std::vector<TileReference> tiles = getTiles(s);
+            buffers.resize(tiles.size());
+            for(size_t t = 0; t < tiles.size(); t++)
+            {
+                buffers[t].resize(tileLength);
+                tiles[t].matrix->readTile(tiles[t].tileRow, tiles[t].tileColumn, buffers[t].data());
+            }
+        };
+        if(numSteps > 0)
+        {
+            load(0, current);
+        }
+        for(size_t s = 0; s < numSteps; s++)
+        {
+            std::future<void> loaded;
+            if(s + 1 < numSteps)
+            {
+                loaded = std::async(std::launch::async, load, s + 1, std::ref(next));
+            }
+            process(s, current);
+            if(loaded.valid())
+            {
+                loaded.get();
+            }
+            std::swap(current, next);
+        }
+    }
+
+    // c += sign * a * b, for the numRows x n block of a, the n x numColumns block of b and
+    // the numRows x numColumns block of c, all tiles with rows of tileSize elements.
+    void addTileProduct(const double* a, const double* b, double* c, size_t tileSize, size_t numRows, size_t n, size_t numColumns, double sign, size_t numThreads)
+    {
+        numThreads = std::min(getNumThreads(numThreads), std::max(numRows, size_t(1)));
+        runInParallel(numRows, numThreads, [&](size_t, size_t chunkStart, size_t chunkEnd)
+        {
+            for(size_t i = chunkStart; i < chunkEnd; i++)
+            {
+                double* cRow = c + i * tileSize;
+                for(size_t k = 0; k < n; k++)
+                {
+                    double aik = sign * a[i * tileSize + k];
+                    const double* bRow = b + k * tileSize;
+                    for(size_t j = 0; j < numColumns; j++)
+                    {
+                        cRow[j] += aik * bRow[j];
+                    }
+                }
+            }
+        });
+    }
+
+    // LU factorization with partial pivoting of a panel: the tiles of a tile column, from
+    // the diagonal one down, whose first n columns are factored in place. numRows is the
+    // number of rows of the panel inside the matrix. The pivot of column c is the largest
+    // element in absolute value at or below row c of the whole panel; its row is exchanged
+    // with row c, over all the columns of the tiles, and stored in pivots[c].
+    void factorPanel(std::vector<std::vector<double> >& tiles, size_t tileSize, size_t numRows, size_t n, std::vector<size_t>& pivots)
+    {
+        auto getRow = [&tiles, tileSize](size_t i)
+        {
+            return tiles[i / tileSize].data() + (i % tileSize) * tileSize;
+        };
+        pivots.resize(n);
+        for(size_t c = 0; c < n; c++)
+        {
+            size_t pivotRow = c;
+            for(size_t i = c + 1; i < numRows; i++)
+            {
+                pivotRow = (std::abs(getRow(i)[c]) > std::abs(getRow(pivotRow)[c])) ? i : pivotRow;
+            }
+            pivots[c] = pivotRow;
+            double* row = getRow(c);
+            if(pivotRow != c)
+            {
+                std::swap_ranges(row, row + tileSize, getRow(pivotRow));
+            }
+            double pivot = row[c];
+            assert(pivot != 0);
+            for(size_t i = c + 1; i < numRows; i++)
+            {
+                double* rowI = getRow(i);
+                double l = (rowI[c] /= pivot);
+                for(size_t j = c + 1; j < n; j++)
+                {
+                    rowI[j] -= l * row[j];
+                }
+            }
+        }
+    }
+
+    // Applies the row exchanges of a panel, given by factorPanel for tile row k, to the
+    // other tile columns of a: row k * tileSize + c with row k * tileSize + pivots[c], for
+    // c = 0, 1, ... in order. Each tile column is streamed once, through the tile of row k
+    // and the tiles below it which hold a pivot row.
+    void swapPanelRows(TiledMatrix& a, size_t k, const std::vector<size_t>& pivots)
+    {
+        size_t tileSize = a.getTileSize();
+        size_t n = pivots.size();
+        // The exchanges as a permutation of the rows of the panel: row r ends up with the
+        // row source[r]. Rows below tile k only ever receive rows of tile k.
+        std::vector<size_t> source(std::max(tileSize, *std::max_element(pivots.begin(), pivots.end()) + 1));
+        bool exchanged = false;
+        for(size_t r = 0; r < source.size(); r++)
+        {
+            source[r] = r;
+        }
+        for(size_t c = 0; c < n; c++)
+        {
+            std::swap(source[c], source[pivots[c]]);
+            exchanged = exchanged || (pivots[c] != c);
+        }
+        if(!exchanged)
+        {
+            return;
+        }
+        std::vector<size_t> tileRows = {};
+        for(size_t r = tileSize; r < source.size(); r++)
+        {
+            if(source[r] != r)
+            {
+                assert(source[r] < tileSize);
+                if(tileRows.empty() || (tileRows.back() != k + r / tileSize))
+                {
+                    tileRows.push_back(k + r / tileSize);
+                }
+            }
+        }
+        size_t numSteps = tileRows.size() + 1;
+        std::vector<double> original(tileSize * tileSize);
+        std::vector<double> top(tileSize * tileSize);
+        for(size_t j = 0; j < a.getNumTileColumns(); j++)
+        {
+            if(j == k)
+            {
+                continue;
+            }
+            streamTiles(numSteps, tileSize * tileSize, [&](size_t s)
+            {
+                return std::vector<TileReference>{{&a, (s == 0) ? k : tileRows[s - 1], j}};
+            },
+            [&](size_t s, std::vector<std::vector<double> >& tiles)
+            {
+                const double* tile = tiles[0].data();
+                if(s == 0)
+                {
+                    std::copy(tile, tile + tileSize * tileSize, original.begin());
+                    for(size_t r = 0; r < tileSize; r++)
+                    {
+                        if(source[r] < tileSize)
+                        {
+                            std::copy(tile + source[r] * tileSize, tile + (source[r] + 1) * tileSize, top.begin() + r * tileSize);
+                        }
+                    }
+                }
+                else
+                {
+                    size_t first = (tileRows[s - 1] - k) * tileSize;
+                    for(size_t r = first; r < std::min(first + tileSize, source.size()); r++)
+                    {
+                        if(source[r] == r)
+                        {
+                            continue;
+                        }
+                        double* row = tiles[0].data() + (r - first) * tileSize;
+                        // The row of tile k which receives row r, before row r is replaced.
+                        size_t target = std::find(source.begin(), source.begin() + tileSize, r) - source.begin();
+                        assert(target < tileSize);
+                        std::copy(row, row + tileSize, top.begin() + target * tileSize);
+                        std::copy(original.begin() + source[r] * tileSize, original.begin() + (source[r] + 1) * tileSize, row);
+                    }
+                    a.writeTile(tileRows[s - 1], j, tiles[0].data());
+                }
+                if(s + 1 == numSteps)
+                {
+                    a.writeTile(k, j, top.data());
+                }
+            });
+        }
+    }
+
+    // b = L^-1 * b, for the unit lower triangle L of the n x n block of lu and the
+    // n x numColumns block of b.
+    void solveLowerTile(const double* lu, double* b, size_t tileSize, size_t n, size_t numColumns)
+    {
+        for(size_t i = 1; i < n; i++)
+        {
+            for(size_t k = 0; k < i; k++)
+            {
+                double l = lu[i * tileSize + k];
+                for(size_t j = 0; j < numColumns; j++)
+                {
+                    b[i * tileSize + j] -= l * b[k * tileSize + j];
+                }
+            }
+        }
+    }
+}
+
+TiledMatrix::TiledMatrix(const std::string& path, size_t numRows, size_t numColumns, size_t tileSize)
+{
+    assert(tileSize > 0);
+    bool created = createTiledMatrixFile(path, numRows, numColumns, tileSize);
+    if(!created)
+    {
+        std::cout << "The tiled matrix file " << path << " could not be created" << std::endl;
+    }
+    assert(created);
+    m_file = MappedFile(path, true);
+    assert(m_file.isOpen());
+    m_data = reinterpret_cast<double*>(m_file.getWritableData() + PAYLOAD_OFFSET);
+    m_numRows = numRows;
+    m_numColumns = numColumns;
+    m_tileSize = tileSize;
+    m_numTileRows = getNumTiles(numRows, tileSize);
+    m_numTileColumns = getNumTiles(numColumns, tileSize);
+}
+
+TiledMatrix::TiledMatrix(const std::string& path, const Matrix& m, size_t tileSize)
+:TiledMatrix(path, m.getNumRows(), m.getNumColumns(), tileSize)
+{
+    for(size_t ti = 0; ti < m_numTileRows; ti++)
+    {
+        for(size_t tj = 0; tj < m_numTileColumns; tj++)
+        {
+            double* tile = getTileData(ti, tj);
+            size_t numTileRows = getTileNumRows(ti);
+            size_t numTileColumns = getTileNumColumns(tj);
+            for(size_t i = 0; i < numTileRows; i++)
+            {
+                const double* row = m[ti * m_tileSize + i].data() + tj * m_tileSize;
+                std::copy(row, row + numTileColumns, tile + i * m_tileSize);
+            }
+        }
+    }
+}
+
+TiledMatrix::TiledMatrix(const std::string& path)
+:m_file(path, true)
+{
+    std::string error;
+    bool valid = open(error);
+    if(!valid)
+    {
+        std::cout << "Invalid binary file " << path << ": " << error << std::endl;
+    }
+    assert(valid);
+}
+
+TiledMatrix::TiledMatrix(const std::string& path, std::string& error)
+:m_file(path, true)
+{
+    open(error);
+}
+
+bool TiledMatrix::open(std::string& error)
+{
+    m_data = nullptr;
+    m_numRows = 0;
+    m_numColumns = 0;
+    m_tileSize = 0;
+    m_numTileRows = 0;
+    m_numTileColumns = 0;
+    BinaryFileHeader header;
+    if(!readBinaryFileHeader(m_file, header, error))
+    {
+        return false;
+    }
+    if(header.objectType != BINARY_TILED_MATRIX)
+    {
+        error = "holds object type " + std::to_string(header.objectType) + " instead of " + std::to_string(BINARY_TILED_MATRIX);
+        return false;
+    }
+    error.clear();
+    m_data = reinterpret_cast<double*>(m_file.getWritableData() + PAYLOAD_OFFSET);
+    m_numRows = header.numRows;
+    m_numColumns = header.numColumns;
+    m_tileSize = header.tileSize;
+    m_numTileRows = getNumTiles(m_numRows, m_tileSize);
+    m_numTileColumns = getNumTiles(m_numColumns, m_tileSize);
+    return true;
+}
+
+bool TiledMatrix::isValid() const
+{
+    return m_data != nullptr;
+}
+
+size_t TiledMatrix::getTileOffset(size_t tileRow, size_t tileColumn) const
+{
+    assert((tileRow < m_numTileRows) && (tileColumn < m_numTileColumns));
+    return (tileRow * m_numTileColumns + tileColumn) * m_tileSize * m_tileSize;
+}
+
+size_t TiledMatrix::getNumRows() const
+{
+    return m_numRows;
+}
+
+size_t TiledMatrix::getNumColumns() const
+{
+    return m_numColumns;
+}
+
+size_t TiledMatrix::getTileSize() const
+{
+    return m_tileSize;
+}
+
+size_t TiledMatrix::getNumTileRows() const
+{
+    return m_numTileRows;
+}
+
+size_t TiledMatrix::getNumTileColumns() const
+{
+    return m_numTileColumns;
+}
+
+size_t TiledMatrix::getTileNumRows(size_t tileRow) const
+{
+    return std::min(m_tileSize, m_numRows - tileRow * m_tileSize);
+}
+
+size_t TiledMatrix::getTileNumColumns(size_t tileColumn) const
+{
+    return std::min(m_tileSize, m_numColumns - tileColumn * m_tileSize);
+}
+
+const std::string& TiledMatrix::getPath() const
+{
+    return m_file.getPath();
+}
+
+double TiledMatrix::operator()(size_t i, size_t j) const
+{
+    assert((i < m_numRows) && (j < m_numColumns));
+    return getTileData(i / m_tileSize, j / m_tileSize)[(i % m_tileSize) * m_tileSize + (j % m_tileSize)];
+}
+
+void TiledMatrix::set(size_t i, size_t j, double value)
+{
+    assert((i < m_numRows) && (j < m_numColumns));
+    getTileData(i / m_tileSize, j / m_tileSize)[(i % m_tileSize) * m_tileSize + (j % m_tileSize)] = value;
+}
+
+const double* TiledMatrix::getTileData(size_t tileRow, size_t tileColumn) const
+{
+    return m_data + getTileOffset(tileRow, tileColumn);
+}
+
+double* TiledMatrix::getTileData(size_t tileRow, size_t tileColumn)
+{
+    return m_data + getTileOffset(tileRow, tileColumn);
+}
+
+void TiledMatrix::readTile(size_t tileRow, size_t tileColumn, double* buffer) const
+{
+    size_t length = m_tileSize * m_tileSize;
+    size_t offset = getTileOffset(tileRow, tileColumn);
+    std::copy(m_data + offset, m_data + offset + length, buffer);
+    m_file.release(PAYLOAD_OFFSET + offset * sizeof(double), length * sizeof(double));
+}
+
+void TiledMatrix::writeTile(size_t tileRow, size_t tileColumn, const double* buffer)
+{
+    size_t length = m_tileSize * m_tileSize;
+    size_t offset = getTileOffset(tileRow, tileColumn);
+    std::copy(buffer, buffer + length, m_data + offset);
+    m_file.release(PAYLOAD_OFFSET + offset * sizeof(double), length * sizeof(double));
+}
+
+void TiledMatrix::prefetchTile(size_t tileRow, size_t tileColumn) const
+{
+    size_t offset = getTileOffset(tileRow, tileColumn);
+    m_file.prefetch(PAYLOAD_OFFSET + offset * sizeof(double), m_tileSize * m_tileSize * sizeof(double));
+}
+
+Matrix TiledMatrix::getTile(size_t tileRow, size_t tileColumn) const
+{
+    const double* tile = getTileData(tileRow, tileColumn);
+    size_t numTileRows = getTileNumRows(tileRow);
+    size_t numTileColumns = getTileNumColumns(tileColumn);
+    LinalgArray<LinalgArray<double> > r(numTileRows);
+    for(size_t i = 0; i < numTileRows; i++)
+    {
+        r[i].assign(tile + i * m_tileSize, tile + i * m_tileSize + numTileColumns);
+    }
+    return Matrix(std::move(r));
+}
+
+void TiledMatrix::setTile(size_t tileRow, size_t tileColumn, const Matrix& m)
+{
+    size_t numTileRows = getTileNumRows(tileRow);
+    size_t numTileColumns = getTileNumColumns(tileColumn);
+    assert((m.getNumRows() == numTileRows) && (m.getNumColumns() == numTileColumns));
+    double* tile = getTileData(tileRow, tileColumn);
+    for(size_t i = 0; i < numTileRows; i++)
+    {
+        std::copy(m[i].begin(), m[i].end(), tile + i * m_tileSize);
+    }
+}
+
+Matrix TiledMatrix::getMatrix() const
+{
+    LinalgArray<LinalgArray<double> > r(m_numRows, LinalgArray<double>(m_numColumns));
+    for(size_t ti = 0; ti < m_numTileRows; ti++)
+    {
+        for(size_t tj = 0; tj < m_numTileColumns; tj++)
+        {
+            const double* tile = getTileData(ti, tj);
+            size_t numTileColumns = getTileNumColumns(tj);
+            for(size_t i = 0; i < getTileNumRows(ti); i++)
+            {
+                std::copy(tile + i * m_tileSize, tile + i * m_tileSize + numTileColumns, r[ti * m_tileSize + i].begin() + tj * m_tileSize);
+            }
+        }
+    }
+    return Matrix(std::move(r));
+}
+
+bool TiledMatrix::sync() const
+{
+    return m_file.sync();
+}
+
+void getTiledProduct(const TiledMatrix& a, const TiledMatrix& b, TiledMatrix& c, size_t numThreads)
+{
+    assert((a.getNumColumns() == b.getNumRows()) && (c.getNumRows() == a.getNumRows()) && (c.getNumColumns() == b.getNumColumns()));
+    assert((a.getTileSize() == b.getTileSize()) && (a.getTileSize() == c.getTileSize()));
+    assert((&c != &a) && (&c != &b));
+    size_t tileSize = a.getTileSize();
+    size_t numInner = a.getNumTileColumns();
+    size_t numTileColumns = c.getNumTileColumns();
+    std::vector<double> sum(tileSize * tileSize);
+    if(numInner == 0)
+    {
+        // c = 0, as the product of empty matrices.
+        for(size_t ti = 0; ti < c.getNumTileRows(); ti++)
+        {
+            for(size_t tj = 0; tj < numTileColumns; tj++)
+            {
+                c.writeTile(ti, tj, sum.data());
+            }
+        }
+        return;
+    }
+    // Step s computes the term k of tile (i, j) of c, which is written after its last term.
+    auto getIndices = [numInner, numTileColumns](size_t s, size_t& i, size_t& j, size_t& k)
+    {
+        k = s % numInner;
+        j = (s / numInner) % numTileColumns;
+        i = s / (numInner * numTileColumns);
+    };
+    size_t numSteps = c.getNumTileRows() * numTileColumns * numInner;
+    streamTiles(numSteps, tileSize * tileSize, [&](size_t s)
+    {
+        size_t i, j, k;
+        getIndices(s, i, j, k);
+        return std::vector<TileReference>{{&a, i, k}, {&b, k, j}};
+    },
+    [&](size_t s, std::vector<std::vector<double> >& tiles)
+    {
+        size_t i, j, k;
+        getIndices(s, i, j, k);
+        if(k == 0)
+        {
+            std::fill(sum.begin(), sum.end(), 0);
+        }
+        addTileProduct(tiles[0].data(), tiles[1].data(), sum.data(), tileSize, c.getTileNumRows(i), a.getTileNumColumns(k), c.getTileNumColumns(j), 1, numThreads);
+        if(k + 1 == numInner)
+        {
+            c.writeTile(i, j, sum.data());
+        }
+    });
+}
+
+Vector getTiledProduct(const TiledMatrix& a, const Vector& v)
+{
+    assert(a.getNumColumns() == v.size());
+    size_t tileSize = a.getTileSize();
+    size_t numTileColumns = a.getNumTileColumns();
+    const LinalgArray<double>& x = v.getData();
+    LinalgArray<double> r(a.getNumRows(), 0);
+    streamTiles(a.getNumTileRows() * numTileColumns, tileSize * tileSize, [&](size_t s)
+    {
+        return std::vector<TileReference>{{&a, s / numTileColumns, s % numTileColumns}};
+    },
+    [&](size_t s, std::vector<std::vector<double> >& tiles)
+    {
+        size_t ti = s / numTileColumns;
+        size_t tj = s % numTileColumns;
+        const double* xPart = x.data() + tj * tileSize;
+        size_t numColumns = a.getTileNumColumns(tj);
+        for(size_t i = 0; i < a.getTileNumRows(ti); i++)
+        {
+            const double* row = tiles[0].data() + i * tileSize;
+            double sum = 0;
+            for(size_t j = 0; j < numColumns; j++)
+            {
+                sum += row[j] * xPart[j];
+            }
+            r[ti * tileSize + i] += sum;
+        }
+    });
+    return Vector(std::move(r));
+}
+
+void getTiledTranspose(const TiledMatrix& a, TiledMatrix& t)
+{
+    assert((t.getNumRows() == a.getNumColumns()) && (t.getNumColumns() == a.getNumRows()));
+    assert((a.getTileSize() == t.getTileSize()) && (&a != &t));
+    size_t tileSize = a.getTileSize();
+    size_t numTileColumns = a.getNumTileColumns();
+    std::vector<double> transposed(tileSize * tileSize);
+    streamTiles(a.getNumTileRows() * numTileColumns, tileSize * tileSize, [&](size_t s)
+    {
+        return std::vector<TileReference>{{&a, s / numTileColumns, s % numTileColumns}};
+    },
+    [&](size_t s, std::vector<std::vector<double> >& tiles)
+    {
+        // The padding of a tile is 0, so the whole tile can be transposed.
+        for(size_t i = 0; i < tileSize; i++)
+        {
+            for(size_t j = 0; j < tileSize; j++)
+            {
+                transposed[j * tileSize + i] = tiles[0][i * tileSize + j];
+            }
+        }
+        t.writeTile(s % numTileColumns, s / numTileColumns, transposed.data());
+    });
+}
+
+std::vector<size_t> getTiledLUFactorization(TiledMatrix& a, size_t numThreads)
+{
+    assert(a.getNumRows() == a.getNumColumns());
+    size_t tileSize = a.getTileSize();
+    size_t tileLength = tileSize * tileSize;
+    size_t numTiles = a.getNumTileRows();
+    std::vector<size_t> pivots = {};
+    std::vector<size_t> panelPivots = {};
+    // Right-looking: factor the panel of tile column k with partial pivoting, exchange the
+    // same rows in the other tile columns, solve for the rest of tile row k, and subtract
+    // the product of tile column and row k from the trailing tiles.
+    for(size_t k = 0; k < numTiles; k++)
+    {
+        size_t nk = a.getTileNumRows(k);
+        size_t numTrailing = numTiles - k - 1;
+        streamTiles(1, tileLength, [&](size_t)
+        {
+            std::vector<TileReference> panel = {};
+            for(size_t i = k; i < numTiles; i++)
+            {
+                panel.push_back({&a, i, k});
+            }
+            return panel;
+        },
+        [&](size_t, std::vector<std::vector<double> >& tiles)
+        {
+            factorPanel(tiles, tileSize, a.getNumRows() - k * tileSize, nk, panelPivots);
+            for(size_t i = k; i < numTiles; i++)
+            {
+                a.writeTile(i, k, tiles[i - k].data());
+            }
+        });
+        swapPanelRows(a, k, panelPivots);
+        for(size_t c = 0; c < nk; c++)
+        {
+            pivots.push_back(k * tileSize + panelPivots[c]);
+        }
+        streamTiles(numTrailing, tileLength, [&](size_t s)
+        {
+            return std::vector<TileReference>{{&a, k, k}, {&a, k, k + 1 + s}};
+        },
+        [&](size_t s, std::vector<std::vector<double> >& tiles)
+        {
+            size_t j = k + 1 + s;
+            solveLowerTile(tiles[0].data(), tiles[1].data(), tileSize, nk, a.getTileNumColumns(j));
+            a.writeTile(k, j, tiles[1].data());
+        });
+        streamTiles(numTrailing * numTrailing, tileLength, [&](size_t s)
+        {
+            size_t i = k + 1 + s / numTrailing;
+            size_t j = k + 1 + s % numTrailing;
+            return std::vector<TileReference>{{&a, i, j}, {&a, i, k}, {&a, k, j}};
+        },
+        [&](size_t s, std::vector<std::vector<double> >& tiles)
+        {
+            size_t i = k + 1 + s / numTrailing;
+            size_t j = k + 1 + s % numTrailing;
+            addTileProduct(tiles[1].data(), tiles[2].data(), tiles[0].data(), tileSize, a.getTileNumRows(i), nk, a.getTileNumColumns(j), -1, numThreads);
+            a.writeTile(i, j, tiles[0].data());
+        });
+    }
+    return pivots;
+}
+
+Vector getTiledLUSolution(const TiledMatrix& lu, const std::vector<size_t>& pivots, const Vector& b)
+{
+    assert((lu.getNumRows() == lu.getNumColumns()) && (lu.getNumRows() == b.size()) && (pivots.size() == b.size()));
+    size_t tileSize = lu.getTileSize();
+    size_t numTiles = lu.getNumTileRows();
+    std::vector<double> x(b.getData().begin(), b.getData().end());
+    // P * b, with the row exchanges of the factorization in order.
+    for(size_t i = 0; i < pivots.size(); i++)
+    {
+        std::swap(x[i], x[pivots[i]]);
+    }
+    // Forward substitution with L, by tile rows: the tiles (i, 0), ..., (i, i) in order.
+    std::vector<std::pair<size_t, size_t> > order = {};
+    for(size_t i = 0; i < numTiles; i++)
+    {
+        for(size_t j = 0; j <= i; j++)
+        {
+            order.push_back({i, j});
+        }
+    }
+    auto getTiles = [&](size_t s)
+    {
+        return std::vector<TileReference>{{&lu, order[s].first, order[s].second}};
+    };
+    streamTiles(order.size(), tileSize * tileSize, getTiles, [&](size_t s, std::vector<std::vector<double> >& tiles)
+    {
+        size_t ti = order[s].first;
+        size_t tj = order[s].second;
+        const double* tile = tiles[0].data();
+        double* xi = x.data() + ti * tileSize;
+        const double* xj = x.data() + tj * tileSize;
+        size_t numRows = lu.getTileNumRows(ti);
+        for(size_t i = 0; i < numRows; i++)
+        {
+            // In the diagonal tile, only the elements left of the diagonal belong to L.
+            size_t numColumns = (ti == tj) ? i : lu.getTileNumColumns(tj);
+            double sum = 0;
+            for(size_t j = 0; j < numColumns; j++)
+            {
+                sum += tile[i * tileSize + j] * xj[j];
+            }
+            xi[i] -= sum;
+        }
+    });
+    // Back substitution with U: the tiles (i, n - 1), ..., (i, i), for i from the last.
+    order.clear();
+    for(size_t i = numTiles; i-- > 0;)
+    {
+        for(size_t j = numTiles; j-- > i;)
+        {
+            order.push_back({i, j});
+        }
+    }
+    streamTiles(order.size(), tileSize * tileSize, getTiles, [&](size_t s, std::vector<std::vector<double> >& tiles)
+    {
+        size_t ti = order[s].first;
+        size_t tj = order[s].second;
+        const double* tile = tiles[0].data();
+        double* xi = x.data() + ti * tileSize;
+        const double* xj = x.data() + tj * tileSize;
+        size_t numRows = lu.getTileNumRows(ti);
+        if(ti != tj)
+        {
+            size_t numColumns = lu.getTileNumColumns(tj);
+            for(size_t i = 0; i < numRows; i++)
+            {
+                double sum = 0;
+                for(size_t j = 0; j < numColumns; j++)
+                {
+                    sum += tile[i * tileSize + j] * xj[j];
+                }
+                xi[i] -= sum;
+            }
+            return;
+        }
+        for(size_t i = numRows; i-- > 0;)
+        {
+            double sum = xi[i];
+            for(size_t j = i + 1; j < numRows; j++)
+            {
+                sum -= tile[i * tileSize + j] * xi[j];
+            }
+            xi[i] = sum / tile[i * tileSize + i];
+        }
+    });
+    return Vector(std::move(x));
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "linalg_allocator.hpp"
+#include <cassert>
+#include <mutex>
+
+namespace
+{
+    const size_t NODE_SIZE_STEP = 16;
+    const size_t NUM_NODE_SIZES = LINALG_MAX_NODE_SIZE / NODE_SIZE_STEP;
+    const size_t NODES_PER_CHUNK = 64;
+
+    struct FreeNode
+    {
+        FreeNode* next;
+    };
+
+    thread_local Arena* currentArena = nullptr;
+    thread_local LinalgArenaScope* currentScope = nullptr;
+
+    // Free nodes of the current thread for every size class. The array is trivially
+    // destructible, so nodes released during the destruction of thread locals and
+    // statics can still be put back into it.
+    thread_local FreeNode* freeNodes[NUM_NODE_SIZES] = {};
+
+    // Nodes left by the threads which have exited, for the next threads to reuse. The
+    // chunks the nodes are carved from are never freed, because the nodes handed out
+    // by a thread can outlive it.
+    std::mutex orphanMutex;
+    FreeNode* orphanNodes[NUM_NODE_SIZES] = {};
+
+    struct NodePoolReleaser
+    {
+        bool isActive = false;
+
+        ~NodePoolReleaser()
+        {
+            std::lock_guard<std::mutex> lock(orphanMutex);
+            for(size_t c = 0; c < NUM_NODE_SIZES; c++)
+            {
+                if(freeNodes[c] == nullptr)
+                {
+                    continue;
+                }
+                FreeNode* last = freeNodes[c];
+                while(last->next != nullptr)
+                {
+                    last = last->next;
+                }
+                last->next = orphanNodes[c];
+                orphanNodes[c] = freeNodes[c];
+                freeNodes[c] = nullptr;
+            }
+        }
+    };
+
+    thread_local NodePoolReleaser nodePoolReleaser;
+
+    size_t getSizeClass(size_t numBytes)
+    {
+        return (numBytes > 0) ? ((numBytes - 1) / NODE_SIZE_STEP) : 0;
+    }
+
+    bool isPooled(size_t numBytes, size_t alignment)
+    {
+        return (numBytes <= LINALG_MAX_NODE_SIZE) && (alignment <= alignof(std::max_align_t));
+    }
+
+    void addFreeNode(void* p, size_t sizeClass)
+    {
+        FreeNode* node = static_cast<FreeNode*>(p);
+        node->next = freeNodes[sizeClass];
+        freeNodes[sizeClass] = node;
+    }
+
+    void refillFreeNodes(size_t sizeClass)
+    {
+        nodePoolReleaser.isActive = true;
+        {
+            std::lock_guard<std::mutex> lock(orphanMutex);
+            if(orphanNodes[sizeClass] != nullptr)
+            {
+                freeNodes[sizeClass] = orphanNodes[sizeClass];
+                orphanNodes[sizeClass] = nullptr;
+                return;
+            }
+        }
+        size_t nodeSize = (sizeClass + 1) * NODE_SIZE_STEP;
+        char* chunk = static_cast<char*>(::operator new(nodeSize * NODES_PER_CHUNK));
+        // Added in reverse, so the nodes are handed out in address order.
+        for(size_t i = NODES_PER_CHUNK; i-- > 0;)
+        {
+            addFreeNode(chunk + i * nodeSize, sizeClass);
+        }
+    }
+}
+
+LinalgArenaScope::LinalgArenaScope(Arena& arena)
+{
+    m_arena = &arena;
+    m_previousScope = currentScope;
+    m_isOutermost = true;
+    for(const LinalgArenaScope* scope = m_previousScope; scope != nullptr; scope = scope->m_previousScope)
+    {
+        m_isOutermost = m_isOutermost && (scope->m_arena != m_arena);
+    }
+    m_marker = arena.getMarker();
+    currentScope = this;
+    currentArena = m_arena;
+}
+
+LinalgArenaScope::~LinalgArenaScope()
+{
+    assert(currentScope == this);
+    // An enclosing scope of the same arena may own objects which grew inside this one, so
+    // only the outermost scope of an arena rewinds it.
+    if(m_isOutermost)
+    {
+        m_arena->rewind(m_marker);
+    }
+    currentScope = m_previousScope;
+    currentArena = (m_previousScope != nullptr) ? m_previousScope->m_arena : nullptr;
+}
+
+Arena* LinalgArenaScope::getCurrentArena()
+{
+    return currentArena;
+}
+
+void* allocateLinalgMemory(Arena* arena, size_t numBytes, size_t alignment)
+{
+    if(arena != nullptr)
+    {
+        return arena->allocate(numBytes, alignment);
+    }
+    if(isPooled(numBytes, alignment))
+    {
+        size_t sizeClass = getSizeClass(numBytes);
+        if(freeNodes[sizeClass] == nullptr)
+        {
+            refillFreeNodes(sizeClass);
+        }
+        FreeNode* node = freeNodes[sizeClass];
+        freeNodes[sizeClass] = node->next;
+        return node;
+    }
+    return ::operator new(numBytes, std::align_val_t(alignment));
+}
+
+void deallocateLinalgMemory(Arena* arena, void* p, size_t numBytes, size_t alignment)
+{
+    // Memory from an arena is released when the scope which used it ends.
+    if(arena != nullptr)
+    {
+        return;
+    }
+    if(isPooled(numBytes, alignment))
+    {
+        addFreeNode(p, getSizeClass(numBytes));
+        return;
+    }
+    ::operator delete(p, std::align_val_t(alignment));
+}
\ No newline at end of file
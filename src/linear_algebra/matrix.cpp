@@ -1,12 +1,17 @@
 #include "matrix.hpp"
 #include "vectr.hpp"
 #include <cassert>
+#include <cmath>
+#include <complex>
 #include <iostream>
 #include <algorithm>
+#include <utility>
 #include "templates_linalg.hpp"
+#include "matrix_view.hpp"
 #include "sparse_matrix.hpp"
 
-bool Matrix::isDataValid() const
+template <typename T>
+bool BasicMatrix<T>::isDataValid() const
 {
     // Empty data denotes a null matrix, which is valid.
     if(m_data.size() == 0)
@@ -38,7 +43,8 @@ bool Matrix::isDataValid() const
     return true;
 }
 
-Matrix::Matrix()
+template <typename T>
+BasicMatrix<T>::BasicMatrix()
 {
     m_data = {};
     // At this point, the matrix is a null-matrix, hence it has 0 dimensions.
@@ -46,27 +52,55 @@ Matrix::Matrix()
     m_numColumns = 0;
 }
 
-Matrix::Matrix(const std::vector<std::vector<double> >& data)
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const std::vector<std::vector<T> >& data)
 {
-    m_data = data;
+    for(const auto& row: data)
+    {
+        m_data.emplace_back(row.begin(), row.end());
+    }
+    assert(isDataValid());
+    m_numRows = m_data.size();
+    m_numColumns = m_data.empty() ? 0 : m_data[0].size();
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(std::initializer_list<std::initializer_list<T> > data)
+{
+    for(const auto& row: data)
+    {
+        m_data.emplace_back(row);
+    }
     assert(isDataValid());
     m_numRows = m_data.size();
-    m_numColumns = m_data[0].size();
+    m_numColumns = m_data.empty() ? 0 : m_data[0].size();
 }
 
-std::vector<double>& Matrix::operator[](size_t i)
+template <typename T>
+BasicMatrix<T>::BasicMatrix(LinalgArray<LinalgArray<T> >&& data)
+:m_data(std::move(data))
+{
+    assert(isDataValid());
+    m_numRows = m_data.size();
+    m_numColumns = m_data.empty() ? 0 : m_data[0].size();
+}
+
+template <typename T>
+LinalgArray<T>& BasicMatrix<T>::operator[](size_t i)
 {
     return m_data[i];
 }
 
-const std::vector<double>& Matrix::operator[](size_t i) const
+template <typename T>
+const LinalgArray<T>& BasicMatrix<T>::operator[](size_t i) const
 {
     return m_data[i];
 }
 
-Matrix Matrix::operator+(double c) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(T c) const
 {
-    std::vector<std::vector<double> > r = {};
+    LinalgArray<LinalgArray<T> > r = {};
     for(size_t i = 0; i < m_numRows; i++)
     {
         r.push_back({});
@@ -75,46 +109,52 @@ Matrix Matrix::operator+(double c) const
             r[i].push_back(m_data[i][j] + c);
         }
     }
-    return Matrix(r);
+    return BasicMatrix<T>(std::move(r));
 }
 
-Matrix Matrix::operator-(double c) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator-(T c) const
 {
-    double negativeC = -c;
+    T negativeC = -c;
     return (*this) + negativeC;
 }
 
-Matrix Matrix::operator+(const Matrix& m) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const BasicMatrix<T>& m) const
 {
     assert(m_numRows == m.m_numRows);
     assert(m_numColumns == m.m_numColumns);
-    return getMatrixSum((*this), m.m_data, m_numRows, m_numColumns);
+    return getMatrixSum<T>((*this), m.m_data, m_numRows, m_numColumns);
 }
 
-Matrix Matrix::operator-(const Matrix& m) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator-(const BasicMatrix<T>& m) const
 {
     assert(m_numRows == m.m_numRows);
     assert(m_numColumns == m.m_numColumns);
-    return getMatrixDiff((*this), m, m_numRows, m_numColumns);
+    return getMatrixDiff<T>((*this), m, m_numRows, m_numColumns);
 }
 
-Matrix Matrix::operator+(const SparseMatrix& sm) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const BasicSparseMatrix<T>& sm) const
 {
     assert(m_numRows == sm.getNumRows());
     assert(m_numColumns == sm.getNumColumns());
-    return getMatrixSum((*this), sm, m_numRows, m_numColumns);
+    return getMatrixSum<T>((*this), sm, m_numRows, m_numColumns);
 }
 
-Matrix Matrix::operator-(const SparseMatrix& sm) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator-(const BasicSparseMatrix<T>& sm) const
 {
     assert(m_numRows == sm.getNumRows());
     assert(m_numColumns == sm.getNumColumns());
-    return getMatrixDiff((*this), sm, m_numRows, m_numColumns);
+    return getMatrixDiff<T>((*this), sm, m_numRows, m_numColumns);
 }
 
-Matrix Matrix::operator*(double c) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(T c) const
 {
-    std::vector<std::vector<double> > r = {};
+    LinalgArray<LinalgArray<T> > r = {};
     for(size_t i = 0; i < m_numRows; i++)
     {
         r.push_back({});
@@ -123,63 +163,168 @@ Matrix Matrix::operator*(double c) const
             r[i].push_back(m_data[i][j] * c);
         }
     }
-    return Matrix(r);
+    return BasicMatrix<T>(std::move(r));
 }
 
-Matrix Matrix::operator*(const std::vector<std::vector<double> >& d) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const std::vector<std::vector<T> >& d) const
 {
     bool bothMatricesNull = (m_data.size() == 0) && (d.size() == 0);
     bool bothMatricesNotNull = (m_data.size() != 0) && (d.size() != 0);
     assert(bothMatricesNull || bothMatricesNotNull);
     if(d.size() == 0)
     {
-        return Matrix();
+        return BasicMatrix<T>();
     }
     assert(m_numColumns == d.size());
-    return getMatrixMatrixProduct(m_data, d, m_numRows, m_numColumns, d[0].size());
+    return getMatrixMatrixProduct<T>(m_data, d, m_numRows, m_numColumns, d[0].size());
 }
 
-Matrix Matrix::operator*(const Matrix& m) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix<T>& m) const
 {
-    return (*this) * m.m_data;
+    bool bothMatricesNull = (m_data.size() == 0) && (m.m_data.size() == 0);
+    bool bothMatricesNotNull = (m_data.size() != 0) && (m.m_data.size() != 0);
+    assert(bothMatricesNull || bothMatricesNotNull);
+    if(m.m_data.size() == 0)
+    {
+        return BasicMatrix<T>();
+    }
+    assert(m_numColumns == m.m_numRows);
+    return getMatrixMatrixProduct<T>(m_data, m.m_data, m_numRows, m_numColumns, m.m_numColumns);
 }
 
-Matrix Matrix::operator*(const SparseMatrix& sm) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicSparseMatrix<T>& sm) const
 {
     assert(m_numColumns == sm.getNumRows());
-    return getMatrixMatrixProduct(m_data, sm, m_numRows, m_numColumns, sm.getNumColumns());
+    return getMatrixMatrixProduct<T>(m_data, sm, m_numRows, m_numColumns, sm.getNumColumns());
 }
 
-Vector Matrix::operator*(const std::vector<double>& d) const
+template <typename T>
+BasicVector<T> BasicMatrix<T>::operator*(const std::vector<T>& d) const
 {
     assert(m_numColumns == d.size());
-    return (m_numRows == 0) ? Vector() : getMatrixVectorProduct(m_data, d, m_numRows, m_numColumns);
+    return (m_numRows == 0) ? BasicVector<T>() : getMatrixVectorProduct<T>(m_data, d, m_numRows, m_numColumns);
 }
 
-Vector Matrix::operator*(const Vector& v) const
+template <typename T>
+BasicVector<T> BasicMatrix<T>::operator*(const BasicVector<T>& v) const
 {
-    return (*this) * v.getData();
+    assert(m_numColumns == v.size());
+    return (m_numRows == 0) ? BasicVector<T>() : getMatrixVectorProduct<T>(m_data, v.getData(), m_numRows, m_numColumns);
 }
 
-Vector Matrix::operator*(const SparseVector& sv) const
+template <typename T>
+BasicVector<T> BasicMatrix<T>::operator*(const BasicSparseVector<T>& sv) const
 {
     assert(m_numColumns == sv.size());
-    return getMatrixVectorProduct(m_data, sv, m_numRows, m_numColumns);
+    return getMatrixVectorProduct<T>(m_data, sv, m_numRows, m_numColumns);
 }
 
-const std::vector<std::vector<double> >& Matrix::getData() const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const BasicMatrixView<const T>& m) const
+{
+    assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+    return getMatrixSum<T>(m_data, m, m_numRows, m_numColumns);
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator-(const BasicMatrixView<const T>& m) const
+{
+    assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+    return getMatrixDiff<T>(m_data, m, m_numRows, m_numColumns);
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrixView<const T>& m) const
+{
+    assert(m_numColumns == m.getNumRows());
+    return getMatrixMatrixProduct<T>(m_data, m, m_numRows, m_numColumns, m.getNumColumns());
+}
+
+template <typename T>
+BasicVector<T> BasicMatrix<T>::operator*(const BasicVectorView<const T>& v) const
+{
+    assert(m_numColumns == v.size());
+    return getMatrixVectorProduct<T>(m_data, v, m_numRows, m_numColumns);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::getBlock(size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns)
+{
+    return BasicMatrixView<T>(*this, firstRow, firstColumn, numRows, numColumns);
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicMatrix<T>::getBlock(size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns) const
+{
+    return BasicMatrixView<const T>(*this, firstRow, firstColumn, numRows, numColumns);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::getRows(size_t firstRow, size_t numRows)
+{
+    return getBlock(firstRow, 0, numRows, m_numColumns);
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicMatrix<T>::getRows(size_t firstRow, size_t numRows) const
+{
+    return getBlock(firstRow, 0, numRows, m_numColumns);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::getColumns(size_t firstColumn, size_t numColumns)
+{
+    return getBlock(0, firstColumn, m_numRows, numColumns);
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicMatrix<T>::getColumns(size_t firstColumn, size_t numColumns) const
+{
+    return getBlock(0, firstColumn, m_numRows, numColumns);
+}
+
+template <typename T>
+BasicVectorView<T> BasicMatrix<T>::getColumn(size_t j)
+{
+    return BasicMatrixView<T>(*this).getColumn(j);
+}
+
+template <typename T>
+BasicVectorView<const T> BasicMatrix<T>::getColumn(size_t j) const
+{
+    return BasicMatrixView<const T>(*this).getColumn(j);
+}
+
+template <typename T>
+BasicVectorView<T> BasicMatrix<T>::getDiagonal()
+{
+    return BasicMatrixView<T>(*this).getDiagonal();
+}
+
+template <typename T>
+BasicVectorView<const T> BasicMatrix<T>::getDiagonal() const
+{
+    return BasicMatrixView<const T>(*this).getDiagonal();
+}
+
+template <typename T>
+const LinalgArray<LinalgArray<T> >& BasicMatrix<T>::getData() const
 {
     return m_data;
 }
 
-Matrix Matrix::getInverse() const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::getInverse() const
 {
     // Inverse is only possible for a square matrix.
     assert(m_numRows == m_numColumns);
     // It is required to make a copy of the matrix data because row transformations
     // will be done.
-    std::vector<std::vector<double> > data = m_data;
-    std::vector<std::vector<double> > inv = {};
+    LinalgArray<LinalgArray<T> > data = m_data;
+    LinalgArray<LinalgArray<T> > inv = {};
     // Initialize the matrix as an identity matrix.
     for(size_t i = 0; i < m_numRows; i++)
     {
@@ -197,13 +342,13 @@ Matrix Matrix::getInverse() const
         // In future, the following check may be replaced by a check for a very
         // small number, as it is unlikely that a floating point value will have
         // the exact bit representation of 0, when it is practically so.
-        if(data[i][i] == 0)
+        if(data[i][i] == T(0))
         {
             bool nonZeroPivotFound = false;
             size_t i2;
             for(i2 = (i + 1); i2 < m_numRows; i2++)
             {
-                if(data[i2][i] != 0)
+                if(data[i2][i] != T(0))
                 {
                     nonZeroPivotFound = true;
                     break;
@@ -223,7 +368,7 @@ Matrix Matrix::getInverse() const
         }
         // At this point, the pivot element(i, i) is non-zero. Divide the row
         // with this pivot element for the data matrix and the inverse matrix.
-        double pivot = data[i][i];
+        T pivot = data[i][i];
         for(size_t j = i; j < m_numColumns; j++)
         {
             data[i][j] /= pivot;
@@ -236,7 +381,7 @@ Matrix Matrix::getInverse() const
         // non-diagonal terms below the pivot element is 0 in the data matrix.
         for(size_t i2 = (i + 1); i2 < m_numRows; i2++)
         {
-            double factor = data[i2][i];
+            T factor = data[i2][i];
             for(size_t j = i; j < m_numColumns; j++)
             {
                 data[i2][j] = data[i2][j] - factor * data[i][j];
@@ -255,7 +400,7 @@ Matrix Matrix::getInverse() const
     {
         for(size_t i2 = (i - 1); ; i2--)
         {
-            double factor = data[i2][i];
+            T factor = data[i2][i];
             /*
             for(size_t j = i; j >= i2; j--)
             {
@@ -274,12 +419,43 @@ Matrix Matrix::getInverse() const
             }
         }
     }
-    return Matrix(inv);
+    return BasicMatrix<T>(std::move(inv));
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::getCholeskyFactor() const
+{
+    assert(m_numRows == m_numColumns);
+    size_t n = m_numRows;
+    LinalgArray<LinalgArray<T> > l(n, LinalgArray<T>(n, 0));
+    for(size_t j = 0; j < n; j++)
+    {
+        // The diagonal of a Hermitian matrix is real, and so is that of L.
+        auto d = getRealPart(m_data[j][j]);
+        for(size_t k = 0; k < j; k++)
+        {
+            d -= getRealPart(l[j][k] * getConjugate(l[j][k]));
+        }
+        // A non-positive pivot means that the matrix is not positive definite.
+        assert(d > 0);
+        l[j][j] = sqrt(d);
+        for(size_t i = j + 1; i < n; i++)
+        {
+            T s = m_data[i][j];
+            for(size_t k = 0; k < j; k++)
+            {
+                s -= l[i][k] * getConjugate(l[j][k]);
+            }
+            l[i][j] = s / l[j][j];
+        }
+    }
+    return BasicMatrix<T>(std::move(l));
 }
 
-Matrix Matrix::getTranspose() const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::getTranspose() const
 {
-    std::vector<std::vector<double> > r = {};
+    LinalgArray<LinalgArray<T> > r = {};
     for(size_t j = 0; j < m_numColumns; j++)
     {
         r.push_back({});
@@ -288,25 +464,33 @@ Matrix Matrix::getTranspose() const
             r[j].push_back(m_data[i][j]);
         }
     }
-    return Matrix(r);
+    return BasicMatrix<T>(std::move(r));
 }
 
-double Matrix::t(size_t i, size_t j) const
+template <typename T>
+T BasicMatrix<T>::t(size_t i, size_t j) const
 {
     return m_data[j][i];
 }
 
-size_t Matrix::getNumRows() const
+template <typename T>
+size_t BasicMatrix<T>::getNumRows() const
 {
     return m_numRows;
 }
 
-size_t Matrix::getNumColumns() const
+template <typename T>
+size_t BasicMatrix<T>::getNumColumns() const
 {
     return m_numColumns;
 }
 
-std::string Matrix::getText() const
+template <typename T>
+std::string BasicMatrix<T>::getText() const
 {
     return getMatrixText(m_data, m_numRows, m_numColumns);
-}
\ No newline at end of file
+}
+
+template class BasicMatrix<float>;
+template class BasicMatrix<double>;
+template class BasicMatrix<std::complex<double> >;
\ No newline at end of file
@@ -4,44 +4,91 @@
 #include "matrix.hpp"
 #include "vectr.hpp"
 #include "templates_linalg.hpp"
+#include "matrix_view.hpp"
 
-SparseMatrix::SparseMatrix(double defaultValue, size_t numRows, size_t numColumns)
-:m_defaultRowVector(SparseVector(defaultValue, numColumns))
+template <typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(T defaultValue, size_t numRows, size_t numColumns)
+:m_defaultRowVector(BasicSparseVector<T>(defaultValue, numColumns))
 {
     m_defaultValue = defaultValue;
     m_numRows = numRows;
     m_numColumns = numColumns;
 }
 
-size_t SparseMatrix::getNumRows() const
+template <typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(T defaultValue, size_t numRows, size_t numColumns, const std::vector<BasicSparseMatrixEntry<T> >& entries)
+:m_defaultRowVector(BasicSparseVector<T>(defaultValue, numColumns))
+{
+    m_defaultValue = defaultValue;
+    m_numRows = numRows;
+    m_numColumns = numColumns;
+    auto row = m_data.end();
+    for(const auto& e: entries)
+    {
+        assert((e.row < numRows) && (e.column < numColumns));
+        if((row == m_data.end()) || (row->first != e.row))
+        {
+            assert((row == m_data.end()) || (e.row > row->first));
+            row = m_data.emplace_hint(m_data.end(), e.row, m_defaultRowVector);
+        }
+        row->second.pushBack(e.column, e.value);
+    }
+}
+
+template <typename T>
+size_t BasicSparseMatrix<T>::getNumRows() const
 {
     return m_numRows;
 }
 
-size_t SparseMatrix::getNumColumns() const
+template <typename T>
+size_t BasicSparseMatrix<T>::getNumColumns() const
 {
     return m_numColumns;
 }
 
-const SparseVector& SparseMatrix::operator[](size_t i) const
+template <typename T>
+size_t BasicSparseMatrix<T>::getNumStoredElements() const
+{
+    size_t count = 0;
+    for(const auto& e: m_data)
+    {
+        count += e.second.getData().size();
+    }
+    return count;
+}
+
+template <typename T>
+T BasicSparseMatrix<T>::getDefaultValue() const
+{
+    return m_defaultValue;
+}
+
+template <typename T>
+const BasicSparseVector<T>& BasicSparseMatrix<T>::operator[](size_t i) const
 {
     assert(i < m_numRows);
     return (m_data.count(i) > 0) ? m_data.at(i) : m_defaultRowVector;
 }
 
-SparseVector& SparseMatrix::operator[](size_t i)
+template <typename T>
+BasicSparseVector<T>& BasicSparseMatrix<T>::operator[](size_t i)
 {
     m_numRows = (i < m_numRows) ? m_numRows : (i + 1);
-    if(m_data.count(i) == 0)
+    auto row = m_data.find(i);
+    if(row == m_data.end())
     {
-        m_data[i] = m_defaultRowVector;
+        // The new row is stored in the memory of the matrix, even when the default row
+        // vector was made elsewhere.
+        row = m_data.emplace(i, BasicSparseVector<T>(m_defaultRowVector, m_data.get_allocator())).first;
     }
-    return m_data[i];
+    return row->second;
 }
 
-SparseMatrix SparseMatrix::operator+(double c) const
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::operator+(T c) const
 {
-    SparseMatrix r(m_defaultValue + c, m_numRows, m_numColumns);
+    BasicSparseMatrix<T> r(m_defaultValue + c, m_numRows, m_numColumns);
     for(const auto& e: m_data)
     {
         r[e.first] = e.second + c;
@@ -49,34 +96,52 @@ SparseMatrix SparseMatrix::operator+(double c) const
     return r;
 }
 
-SparseMatrix SparseMatrix::operator-(double c) const
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::operator-(T c) const
 {
-    double negativeC = -c;
+    T negativeC = -c;
     return (*this) + negativeC;
 }
 
-Matrix SparseMatrix::operator+(const Matrix& m) const
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator+(const BasicMatrix<T>& m) const
 {
     assert(m_numRows == m.getNumRows());
     assert(m_numColumns == m.getNumColumns());
-    return getMatrixSum((*this), m.getData(), m_numRows, m_numColumns);
+    return getMatrixSum<T>((*this), m.getData(), m_numRows, m_numColumns);
 }
 
-Matrix SparseMatrix::operator-(const Matrix& m) const
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator-(const BasicMatrix<T>& m) const
 {
     assert(m_numRows == m.getNumRows());
     assert(m_numColumns == m.getNumColumns());
-    return getMatrixDiff((*this), m.getData(), m_numRows, m_numColumns);
+    return getMatrixDiff<T>((*this), m.getData(), m_numRows, m_numColumns);
+}
+
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator+(const BasicMatrixView<const T>& m) const
+{
+    assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+    return getMatrixSum<T>((*this), m, m_numRows, m_numColumns);
+}
+
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator-(const BasicMatrixView<const T>& m) const
+{
+    assert((m_numRows == m.getNumRows()) && (m_numColumns == m.getNumColumns()));
+    return getMatrixDiff<T>((*this), m, m_numRows, m_numColumns);
 }
 
 // Some thought may be put into optimizing the addition and subtraction between
 // SparseMatrix objects, as common indices of the two matrices, where non-default
 // values exist, are being accessed twice.
-SparseMatrix SparseMatrix::operator+(const SparseMatrix& sm) const
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::operator+(const BasicSparseMatrix<T>& sm) const
 {
     assert(m_numRows == sm.m_numRows);
     assert(m_numColumns == sm.m_numColumns);
-    SparseMatrix r(m_defaultValue + sm.m_defaultValue, m_numRows, m_numColumns);
+    BasicSparseMatrix<T> r(m_defaultValue + sm.m_defaultValue, m_numRows, m_numColumns);
     for(const auto& e: m_data)
     {
         size_t i = e.first;
@@ -98,11 +163,12 @@ SparseMatrix SparseMatrix::operator+(const SparseMatrix& sm) const
     return r;
 }
 
-SparseMatrix SparseMatrix::operator-(const SparseMatrix& sm) const
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::operator-(const BasicSparseMatrix<T>& sm) const
 {
     assert(m_numRows == sm.m_numRows);
     assert(m_numColumns == sm.m_numColumns);
-    SparseMatrix r(m_defaultValue - sm.m_defaultValue, m_numRows, m_numColumns);
+    BasicSparseMatrix<T> r(m_defaultValue - sm.m_defaultValue, m_numRows, m_numColumns);
     for(const auto& e: m_data)
     {
         size_t i = e.first;
@@ -124,9 +190,10 @@ SparseMatrix SparseMatrix::operator-(const SparseMatrix& sm) const
     return r;
 }
 
-SparseMatrix SparseMatrix::operator*(double c) const
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::operator*(T c) const
 {
-    SparseMatrix r(m_defaultValue * c, m_numRows, m_numColumns);
+    BasicSparseMatrix<T> r(m_defaultValue * c, m_numRows, m_numColumns);
     for(const auto& e: m_data)
     {
         r[e.first] = e.second * c;
@@ -134,46 +201,73 @@ SparseMatrix SparseMatrix::operator*(double c) const
     return r;
 }
 
-Matrix SparseMatrix::operator*(const std::vector<std::vector<double> >& d) const
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator*(const std::vector<std::vector<T> >& d) const
 {
     assert(m_numColumns == d.size());
-    return getMatrixMatrixProduct((*this), d, m_numRows, m_numColumns, d[0].size());
+    return getMatrixMatrixProduct<T>((*this), d, m_numRows, m_numColumns, d[0].size());
 }
 
-Matrix SparseMatrix::operator*(const Matrix& m) const
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator*(const BasicMatrix<T>& m) const
 {
     assert(m_numColumns == m.getNumRows());
-    return getMatrixMatrixProduct((*this), m.getData(), m_numRows, m_numColumns, m.getNumColumns());
+    return getMatrixMatrixProduct<T>((*this), m.getData(), m_numRows, m_numColumns, m.getNumColumns());
 }
 
-Matrix SparseMatrix::operator*(const SparseMatrix& sm) const
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator*(const BasicSparseMatrix<T>& sm) const
 {
     assert(m_numColumns == sm.m_numRows);
-    return getMatrixMatrixProduct((*this), sm, m_numRows, m_numColumns, sm.getNumColumns());
+    return getMatrixMatrixProduct<T>((*this), sm, m_numRows, m_numColumns, sm.getNumColumns());
 }
 
-Vector SparseMatrix::operator*(const std::vector<double>& d) const
+template <typename T>
+BasicVector<T> BasicSparseMatrix<T>::operator*(const std::vector<T>& d) const
 {
     assert(m_numColumns == d.size());
-    return getMatrixVectorProduct((*this), d, m_numRows, m_numColumns);
+    return getMatrixVectorProduct<T>((*this), d, m_numRows, m_numColumns);
 }
 
-Vector SparseMatrix::operator*(const Vector& v) const
+template <typename T>
+BasicVector<T> BasicSparseMatrix<T>::operator*(const BasicVector<T>& v) const
 {
     assert(m_numColumns == v.getData().size());
     // REPLACE ABOVE WITH: v.size()
-    return getMatrixVectorProduct((*this), v.getData(), m_numRows, m_numColumns);
+    return getMatrixVectorProduct<T>((*this), v.getData(), m_numRows, m_numColumns);
 }
 
-Vector SparseMatrix::operator*(const SparseVector& sv) const
+template <typename T>
+BasicVector<T> BasicSparseMatrix<T>::operator*(const BasicSparseVector<T>& sv) const
 {
     assert(m_numColumns == sv.size());
-    return getMatrixVectorProduct((*this), sv, m_numRows, m_numColumns);
+    return getMatrixVectorProduct<T>((*this), sv, m_numRows, m_numColumns);
 }
 
-Matrix SparseMatrix::getFullMatrix() const
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator*(const BasicMatrixView<const T>& m) const
 {
-    std::vector<std::vector<double> > r = {};
+    assert(m_numColumns == m.getNumRows());
+    return getMatrixMatrixProduct<T>((*this), m, m_numRows, m_numColumns, m.getNumColumns());
+}
+
+template <typename T>
+BasicVector<T> BasicSparseMatrix<T>::operator*(const BasicVectorView<const T>& v) const
+{
+    assert(m_numColumns == v.size());
+    return getMatrixVectorProduct<T>((*this), v, m_numRows, m_numColumns);
+}
+
+template <typename T>
+const LinalgMap<BasicSparseVector<T> >& BasicSparseMatrix<T>::getData() const
+{
+    return m_data;
+}
+
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::getFullMatrix() const
+{
+    LinalgArray<LinalgArray<T> > r = {};
     for(size_t i = 0; i < m_numRows; i++)
     {
         r.push_back({});
@@ -182,10 +276,26 @@ Matrix SparseMatrix::getFullMatrix() const
             r[i].push_back((*this)[i][j]);
         }
     }
-    return r;
+    return BasicMatrix<T>(std::move(r));
+}
+
+template <typename T>
+BasicSparseMatrixView<T> BasicSparseMatrix<T>::getBlock(size_t firstRow, size_t firstColumn, size_t numRows, size_t numColumns) const
+{
+    return BasicSparseMatrixView<T>(*this, firstRow, firstColumn, numRows, numColumns);
 }
 
-std::string SparseMatrix::getText() const
+template <typename T>
+std::string BasicSparseMatrix<T>::getText() const
 {
-    return getMatrixText((*this), m_numRows, m_numColumns);
-}
\ No newline at end of file
+    std::string text;
+    {
+        TextWriter writer(text);
+        writeText(writer, (*this));
+    }
+    return text;
+}
+
+template class BasicSparseMatrix<float>;
+template class BasicSparseMatrix<double>;
+template class BasicSparseMatrix<std::complex<double> >;
\ No newline at end of file
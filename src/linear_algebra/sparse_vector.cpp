@@ -4,33 +4,73 @@
 #include "templates_linalg.hpp"
 #include "matrix.hpp"
 #include "sparse_matrix.hpp"
+#include "matrix_view.hpp"
 
-SparseVector::SparseVector(double defaultValue, size_t size)
+template <typename T>
+BasicSparseVector<T>::BasicSparseVector(T defaultValue, size_t size)
 {
     m_defaultValue = defaultValue;
     m_size = size;
 }
 
-const double& SparseVector::operator[](size_t i) const
+template <typename T>
+BasicSparseVector<T>::BasicSparseVector(T defaultValue, size_t size, const std::vector<BasicSparseVectorEntry<T> >& entries)
+{
+    m_defaultValue = defaultValue;
+    m_size = size;
+    for(const auto& e: entries)
+    {
+        pushBack(e.index, e.value);
+    }
+}
+
+template <typename T>
+BasicSparseVector<T>::BasicSparseVector(const BasicSparseVector<T>& sv, const LinalgAllocator<T>& allocator)
+:m_data(sv.m_data, allocator)
+{
+    m_defaultValue = sv.m_defaultValue;
+    m_size = sv.m_size;
+}
+
+template <typename T>
+const T& BasicSparseVector<T>::operator[](size_t i) const
 {
     assert(i < m_size);
     return (m_data.count(i) > 0) ? m_data.at(i) : m_defaultValue;
 }
 
-double& SparseVector::operator[](size_t i)
+template <typename T>
+T& BasicSparseVector<T>::operator[](size_t i)
 {
     m_size = (i < m_size) ? m_size : (i + 1);
     return m_data[i];
 }
 
-size_t SparseVector::size() const
+template <typename T>
+size_t BasicSparseVector<T>::size() const
 {
     return m_size;
 }
 
-SparseVector SparseVector::operator+(double c) const
+template <typename T>
+T BasicSparseVector<T>::getDefaultValue() const
 {
-    SparseVector r(m_defaultValue + c, m_size);
+    return m_defaultValue;
+}
+
+template <typename T>
+void BasicSparseVector<T>::pushBack(size_t i, T value)
+{
+    assert(m_data.empty() || (i > m_data.rbegin()->first));
+    // The end is the correct hint, so the insertion does not search the tree.
+    m_data.emplace_hint(m_data.end(), i, value);
+    m_size = (i < m_size) ? m_size : (i + 1);
+}
+
+template <typename T>
+BasicSparseVector<T> BasicSparseVector<T>::operator+(T c) const
+{
+    BasicSparseVector<T> r(m_defaultValue + c, m_size);
     for(const auto& e: m_data)
     {
         r[e.first] = e.second + c;
@@ -38,28 +78,46 @@ SparseVector SparseVector::operator+(double c) const
     return r;
 }
 
-SparseVector SparseVector::operator-(double c) const
+template <typename T>
+BasicSparseVector<T> BasicSparseVector<T>::operator-(T c) const
 {
-    double negativeC = -c;
+    T negativeC = -c;
     return (*this) + negativeC;
 }
 
-Vector SparseVector::operator+(const Vector& v) const
+template <typename T>
+BasicVector<T> BasicSparseVector<T>::operator+(const BasicVector<T>& v) const
 {
     assert(m_size == v.size());
-    return getVectorSum((*this), v.getData(), m_size);
+    return getVectorSum<T>((*this), v.getData(), m_size);
 }
 
-Vector SparseVector::operator-(const Vector& v) const
+template <typename T>
+BasicVector<T> BasicSparseVector<T>::operator-(const BasicVector<T>& v) const
 {
     assert(m_size == v.size());
-    return getVectorDiff((*this), v.getData(), m_size);
+    return getVectorDiff<T>((*this), v.getData(), m_size);
 }
 
-SparseVector SparseVector::operator+(const SparseVector& sv) const
+template <typename T>
+BasicVector<T> BasicSparseVector<T>::operator+(const BasicVectorView<const T>& v) const
+{
+    assert(m_size == v.size());
+    return getVectorSum<T>((*this), v, m_size);
+}
+
+template <typename T>
+BasicVector<T> BasicSparseVector<T>::operator-(const BasicVectorView<const T>& v) const
+{
+    assert(m_size == v.size());
+    return getVectorDiff<T>((*this), v, m_size);
+}
+
+template <typename T>
+BasicSparseVector<T> BasicSparseVector<T>::operator+(const BasicSparseVector<T>& sv) const
 {
     assert(m_size == sv.m_size);
-    SparseVector r(m_defaultValue + sv.m_defaultValue, m_size);
+    BasicSparseVector<T> r(m_defaultValue + sv.m_defaultValue, m_size);
     for(const auto& e: m_data)
     {
         size_t i = e.first;
@@ -73,10 +131,11 @@ SparseVector SparseVector::operator+(const SparseVector& sv) const
     return r;
 }
 
-SparseVector SparseVector::operator-(const SparseVector& sv) const
+template <typename T>
+BasicSparseVector<T> BasicSparseVector<T>::operator-(const BasicSparseVector<T>& sv) const
 {
     assert(m_size == sv.m_size);
-    SparseVector r(m_defaultValue - sv.m_defaultValue, m_size);
+    BasicSparseVector<T> r(m_defaultValue - sv.m_defaultValue, m_size);
     for(const auto& e: m_data)
     {
         size_t i = e.first;
@@ -90,9 +149,10 @@ SparseVector SparseVector::operator-(const SparseVector& sv) const
     return r;
 }
 
-SparseVector SparseVector::operator*(double c) const
+template <typename T>
+BasicSparseVector<T> BasicSparseVector<T>::operator*(T c) const
 {
-    SparseVector r(m_defaultValue * c, m_size);
+    BasicSparseVector<T> r(m_defaultValue * c, m_size);
     for(const auto& e: m_data)
     {
         r[e.first] = c * e.second;
@@ -100,69 +160,101 @@ SparseVector SparseVector::operator*(double c) const
     return r;
 }
 
-double SparseVector::dot(const Vector& v) const
+template <typename T>
+T BasicSparseVector<T>::dot(const BasicVector<T>& v) const
 {
     assert(m_size == v.size());
-    return getDotProduct((*this), v.getData(), m_size);
+    return getDotProduct<T>((*this), v.getData(), m_size);
 }
 
-double SparseVector::dot(const SparseVector& sv) const
+template <typename T>
+T BasicSparseVector<T>::dot(const BasicSparseVector<T>& sv) const
 {
     assert(m_size == sv.m_size);
-    return getDotProduct((*this), sv, m_size);
+    return getDotProduct<T>((*this), sv, m_size);
+}
+
+template <typename T>
+T BasicSparseVector<T>::dot(const BasicVectorView<const T>& v) const
+{
+    assert(m_size == v.size());
+    return getDotProduct<T>((*this), v, m_size);
+}
+
+template <typename T>
+BasicVector<T> BasicSparseVector<T>::operator*(const BasicMatrix<T>& m) const
+{
+    assert(m_size == m.getNumRows());
+    return getVectorMatrixProduct<T>((*this), m.getData(), m.getNumRows(), m.getNumColumns());
 }
 
-Vector SparseVector::operator*(const Matrix& m) const
+template <typename T>
+BasicVector<T> BasicSparseVector<T>::operator*(const BasicMatrixView<const T>& m) const
 {
     assert(m_size == m.getNumRows());
-    return getVectorMatrixProduct((*this), m.getData(), m.getNumRows(), m.getNumColumns());
+    return getVectorMatrixProduct<T>((*this), m, m.getNumRows(), m.getNumColumns());
 }
 
-Vector SparseVector::operator*(const SparseMatrix& sm) const
+template <typename T>
+BasicVector<T> BasicSparseVector<T>::operator*(const BasicSparseMatrix<T>& sm) const
 {
     assert(m_size == sm.getNumRows());
-    return getVectorMatrixProduct((*this), sm, sm.getNumRows(), sm.getNumColumns());
+    return getVectorMatrixProduct<T>((*this), sm, sm.getNumRows(), sm.getNumColumns());
 }
 
-const std::map<size_t, double>& SparseVector::getData() const
+template <typename T>
+const LinalgMap<T>& BasicSparseVector<T>::getData() const
 {
     return m_data;
 }
 
-std::string SparseVector::getText() const
+template <typename T>
+std::string BasicSparseVector<T>::getText() const
 {
-    return getVectorText((*this), m_size);
+    std::string text;
+    {
+        TextWriter writer(text);
+        writeText(writer, (*this));
+    }
+    return text;
 }
 
-double SparseVector::getSum() const
+template <typename T>
+T BasicSparseVector<T>::getSum() const
 {
-    double sum = 0;
+    T sum = 0;
     size_t count = 0;
     for(const auto& e: m_data)
     {
         sum += e.second;
         count++;
     }
-    sum += ((m_size - count) * m_defaultValue);
+    sum += (static_cast<T>(m_size - count) * m_defaultValue);
     return sum;
 }
 
-double SparseVector::getMin() const
+template <typename T>
+T BasicSparseVector<T>::getMin() const
 {
-    double minval = m_defaultValue;
+    T minval = m_defaultValue;
     for(const auto& e: m_data)
     {
-        minval = (e.second < minval) ? e.second : minval;
+        minval = isLess(e.second, minval) ? e.second : minval;
     }
     return minval;
 }
 
-double SparseVector::getMax() const
+template <typename T>
+T BasicSparseVector<T>::getMax() const
 {
-    double maxval = m_defaultValue;
+    T maxval = m_defaultValue;
     for(const auto& e: m_data)
     {
-        maxval = (e.second > maxval) ? e.second : maxval;
+        maxval = isLess(maxval, e.second) ? e.second : maxval;
     }
     return maxval;
-}
\ No newline at end of file
+}
+
+template class BasicSparseVector<float>;
+template class BasicSparseVector<double>;
+template class BasicSparseVector<std::complex<double> >;
\ No newline at end of file
@@ -1,122 +1,183 @@
 #include "vectr.hpp"
 #include <cassert>
+#include <utility>
 #include "matrix.hpp"
 #include "templates_linalg.hpp"
+#include "matrix_view.hpp"
 #include "sparse_vector.hpp"
 #include "sparse_matrix.hpp"
 
-Vector::Vector()
+template <typename T>
+BasicVector<T>::BasicVector()
 {
     m_data = {};
 }
 
-Vector::Vector(const std::vector<double>& data)
+template <typename T>
+BasicVector<T>::BasicVector(const std::vector<T>& data)
+{
+    m_data.assign(data.begin(), data.end());
+}
+
+template <typename T>
+BasicVector<T>::BasicVector(std::initializer_list<T> data)
 {
     m_data = data;
 }
 
-double& Vector::operator[](size_t i)
+template <typename T>
+BasicVector<T>::BasicVector(LinalgArray<T>&& data)
+:m_data(std::move(data))
+{
+}
+
+template <typename T>
+T& BasicVector<T>::operator[](size_t i)
 {
     return m_data[i];
 }
 
-const double& Vector::operator[](size_t i) const
+template <typename T>
+const T& BasicVector<T>::operator[](size_t i) const
 {
     return m_data[i];
 }
 
-Vector Vector::operator+(double c) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator+(T c) const
 {
-    std::vector<double> r = {};
+    LinalgArray<T> r = {};
     for(const auto& x: m_data)
     {
         r.push_back(x + c);
     }
-    return Vector(r);
+    return BasicVector<T>(std::move(r));
 }
 
-Vector Vector::operator-(double c) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator-(T c) const
 {
-    double negativeC = -c;
+    T negativeC = -c;
     return (*this) + negativeC;
 }
 
-Vector Vector::operator+(const Vector& v) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator+(const BasicVector<T>& v) const
 {
     assert(m_data.size() == v.m_data.size());
-    return getVectorSum((*this), v.m_data, m_data.size());
+    return getVectorSum<T>((*this), v.m_data, m_data.size());
 }
 
-Vector Vector::operator-(const Vector& v) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator-(const BasicVector<T>& v) const
 {
     assert(m_data.size() == v.m_data.size());
-    return getVectorDiff((*this), v.m_data, m_data.size());
+    return getVectorDiff<T>((*this), v.m_data, m_data.size());
 }
 
-Vector Vector::operator+(const SparseVector& sv) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator+(const BasicSparseVector<T>& sv) const
 {
     assert(m_data.size() == sv.size());
-    return getVectorSum(m_data, sv, m_data.size());
+    return getVectorSum<T>(m_data, sv, m_data.size());
 }
 
-Vector Vector::operator-(const SparseVector& sv) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator-(const BasicSparseVector<T>& sv) const
 {
     assert(m_data.size() == sv.size());
-    return getVectorDiff(m_data, sv, m_data.size());
+    return getVectorDiff<T>(m_data, sv, m_data.size());
 }
 
-Vector Vector::operator*(double c) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator*(T c) const
 {
-    std::vector<double> r = {};
+    LinalgArray<T> r = {};
     for(const auto& x: m_data)
     {
         r.push_back(x * c);
     }
-    return Vector(r);
+    return BasicVector<T>(std::move(r));
 }
 
-double Vector::dot(const Vector& v) const
+template <typename T>
+T BasicVector<T>::dot(const BasicVector<T>& v) const
 {
     assert(m_data.size() == v.m_data.size());
-    return getDotProduct(m_data, v.m_data, m_data.size());
+    return getDotProduct<T>(m_data, v.m_data, m_data.size());
 }
 
-double Vector::dot(const SparseVector& sv) const
+template <typename T>
+T BasicVector<T>::dot(const BasicSparseVector<T>& sv) const
 {
     assert(m_data.size() == sv.size());
-    return getDotProduct(m_data, sv, m_data.size());
+    return getDotProduct<T>(m_data, sv, m_data.size());
 }
 
-Vector Vector::operator*(const Matrix& m) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator*(const BasicMatrix<T>& m) const
 {
     assert(m_data.size() == m.getData().size());
-    return getVectorMatrixProduct(m_data, m.getData(), m.getNumRows(), m.getNumColumns());
+    return getVectorMatrixProduct<T>(m_data, m.getData(), m.getNumRows(), m.getNumColumns());
 }
 
-Vector Vector::operator*(const SparseMatrix& sm) const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator*(const BasicSparseMatrix<T>& sm) const
 {
     assert(m_data.size() == sm.getNumRows());
-    return getVectorMatrixProduct(m_data, sm, sm.getNumRows(), sm.getNumColumns());
+    return getVectorMatrixProduct<T>(m_data, sm, sm.getNumRows(), sm.getNumColumns());
+}
+
+template <typename T>
+BasicVector<T> BasicVector<T>::operator+(const BasicVectorView<const T>& v) const
+{
+    assert(m_data.size() == v.size());
+    return getVectorSum<T>(m_data, v, m_data.size());
+}
+
+template <typename T>
+BasicVector<T> BasicVector<T>::operator-(const BasicVectorView<const T>& v) const
+{
+    assert(m_data.size() == v.size());
+    return getVectorDiff<T>(m_data, v, m_data.size());
+}
+
+template <typename T>
+T BasicVector<T>::dot(const BasicVectorView<const T>& v) const
+{
+    assert(m_data.size() == v.size());
+    return getDotProduct<T>(m_data, v, m_data.size());
 }
 
-const std::vector<double>& Vector::getData() const
+template <typename T>
+BasicVector<T> BasicVector<T>::operator*(const BasicMatrixView<const T>& m) const
+{
+    assert(m_data.size() == m.getNumRows());
+    return getVectorMatrixProduct<T>(m_data, m, m.getNumRows(), m.getNumColumns());
+}
+
+template <typename T>
+const LinalgArray<T>& BasicVector<T>::getData() const
 {
     return m_data;
 }
 
-std::string Vector::getText() const
+template <typename T>
+std::string BasicVector<T>::getText() const
 {
     return getVectorText(m_data, m_data.size());
 }
 
-size_t Vector::size() const
+template <typename T>
+size_t BasicVector<T>::size() const
 {
     return m_data.size();
 }
 
-double Vector::getSum() const
+template <typename T>
+T BasicVector<T>::getSum() const
 {
-    double sum = 0;
+    T sum = 0;
     for(const auto& e: m_data)
     {
         sum += e;
@@ -124,9 +185,10 @@ double Vector::getSum() const
     return sum;
 }
 
-double Vector::getMin() const
+template <typename T>
+T BasicVector<T>::getMin() const
 {
-    double minval = 0;
+    T minval = 0;
     bool first = true;
     for(const auto& e: m_data)
     {
@@ -136,14 +198,15 @@ double Vector::getMin() const
             first = false;
             continue;
         }
-        minval = (e < minval) ? e : minval;
+        minval = isLess(e, minval) ? e : minval;
     }
     return minval;
 }
 
-double Vector::getMax() const
+template <typename T>
+T BasicVector<T>::getMax() const
 {
-    double maxval;
+    T maxval;
     bool first = true;
     for(const auto& e: m_data)
     {
@@ -153,7 +216,11 @@ double Vector::getMax() const
             first = false;
             continue;
         }
-        maxval = (e > maxval) ? e : maxval;
+        maxval = isLess(maxval, e) ? e : maxval;
     }
     return maxval;
-}
\ No newline at end of file
+}
+
+template class BasicVector<float>;
+template class BasicVector<double>;
+template class BasicVector<std::complex<double> >;
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "optimization.hpp"
+
+double getCubicStepLength(double a0, double f0, double d0, double a1, double f1, double d1)
+{
+    double lower = (a0 < a1) ? a0 : a1;
+    double upper = (a0 < a1) ? a1 : a0;
+    double margin = 0.1 * (upper - lower);
+    double midpoint = 0.5 * (a0 + a1);
+    double theta = d0 + d1 - 3 * (f0 - f1) / (a0 - a1);
+    double discriminant = theta * theta - d0 * d1;
+    if(!(discriminant >= 0) || !std::isfinite(theta))
+    {
+        return midpoint;
+    }
+    double gamma = sqrt(discriminant);
+    gamma = (a1 > a0) ? gamma : -gamma;
+    double denominator = d1 - d0 + 2 * gamma;
+    if(denominator == 0)
+    {
+        return midpoint;
+    }
+    double a = a1 - (a1 - a0) * (d1 + gamma - theta) / denominator;
+    if(!std::isfinite(a))
+    {
+        return midpoint;
+    }
+    if(a < lower + margin)
+    {
+        return lower + margin;
+    }
+    if(a > upper - margin)
+    {
+        return upper - margin;
+    }
+    return a;
+}
+
+void addScaledVector(Vector& y, double a, const Vector& x)
+{
+    size_t n = y.size();
+    assert(x.size() == n);
+    double* yp = &y[0];
+    const double* xp = &x[0];
+    for(size_t i = 0; i < n; i++)
+    {
+        yp[i] += a * xp[i];
+    }
+}
+
+double getMaxNorm(const Vector& v)
+{
+    double norm = 0;
+    for(size_t i = 0; i < v.size(); i++)
+    {
+        norm = (fabs(v[i]) > norm) ? fabs(v[i]) : norm;
+    }
+    return norm;
+}
+
+LBFGSWorkspace::LBFGSWorkspace(size_t dimension, size_t numCorrections)
+{
+    assert(numCorrections > 0);
+    Vector zero(std::vector<double>(dimension, 0));
+    s.assign(numCorrections, zero);
+    y.assign(numCorrections, zero);
+    rho.assign(numCorrections, 0);
+    alpha.assign(numCorrections, 0);
+    gradient = zero;
+    direction = zero;
+    xTrial = zero;
+    gradientTrial = zero;
+}
+
+size_t LBFGSWorkspace::getDimension() const
+{
+    return gradient.size();
+}
+
+bool addLBFGSCorrection(LBFGSWorkspace& workspace, const Vector& x, const Vector& xNew, const Vector& gradient, const Vector& gradientNew, size_t& newest, size_t& numStored)
+{
+    size_t n = x.size();
+    size_t m = workspace.s.size();
+    // The curvature is checked before anything is written, as the slot after newest
+    // holds the oldest pair still in use once the buffer is full.
+    double sy = 0, ss = 0, yy = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        double si = xNew[i] - x[i];
+        double yi = gradientNew[i] - gradient[i];
+        sy += si * yi;
+        ss += si * si;
+        yy += yi * yi;
+    }
+    // The Wolfe conditions ensure positive curvature, up to round-off.
+    if(!(sy > std::numeric_limits<double>::epsilon() * sqrt(ss * yy)))
+    {
+        return false;
+    }
+    size_t next = (numStored == 0) ? 0 : (newest + 1) % m;
+    for(size_t i = 0; i < n; i++)
+    {
+        workspace.s[next][i] = xNew[i] - x[i];
+        workspace.y[next][i] = gradientNew[i] - gradient[i];
+    }
+    workspace.rho[next] = 1 / sy;
+    newest = next;
+    numStored = (numStored < m) ? numStored + 1 : m;
+    return true;
+}
+
+NewtonCGWorkspace::NewtonCGWorkspace(size_t dimension)
+{
+    Vector zero(std::vector<double>(dimension, 0));
+    gradient = zero;
+    direction = zero;
+    residual = zero;
+    conjugate = zero;
+    hessianConjugate = zero;
+    xTrial = zero;
+    gradientTrial = zero;
+}
+
+size_t NewtonCGWorkspace::getDimension() const
+{
+    return gradient.size();
+}
\ No newline at end of file
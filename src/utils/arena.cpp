@@ -0,0 +1,61 @@
+#include "arena.hpp"
+#include <cstdint>
+
+Arena::Arena(size_t blockSize)
+{
+    m_blockSize = blockSize;
+    m_currentBlock = 0;
+    m_offset = 0;
+}
+
+void* Arena::allocate(size_t numBytes, size_t alignment)
+{
+    while(m_currentBlock < m_blocks.size())
+    {
+        uintptr_t base = reinterpret_cast<uintptr_t>(m_blocks[m_currentBlock].get());
+        size_t alignedOffset = ((base + m_offset + alignment - 1) / alignment) * alignment - base;
+        if(alignedOffset + numBytes <= m_blockSizes[m_currentBlock])
+        {
+            m_offset = alignedOffset + numBytes;
+            return m_blocks[m_currentBlock].get() + alignedOffset;
+        }
+        // The rest of the current block is left unused until the next reset().
+        m_currentBlock++;
+        m_offset = 0;
+    }
+    // None of the existing blocks has room, so a new one is added. Requests larger than
+    // the block size get a block of their own size.
+    size_t blockSize = (numBytes + alignment > m_blockSize) ? (numBytes + alignment) : m_blockSize;
+    m_blocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+    m_blockSizes.push_back(blockSize);
+    m_currentBlock = m_blocks.size() - 1;
+    m_offset = 0;
+    return allocate(numBytes, alignment);
+}
+
+void Arena::reset()
+{
+    m_currentBlock = 0;
+    m_offset = 0;
+}
+
+size_t Arena::getCapacity() const
+{
+    size_t capacity = 0;
+    for(const auto& s: m_blockSizes)
+    {
+        capacity += s;
+    }
+    return capacity;
+}
+
+ArenaMarker Arena::getMarker() const
+{
+    return ArenaMarker{m_currentBlock, m_offset};
+}
+
+void Arena::rewind(const ArenaMarker& marker)
+{
+    m_currentBlock = marker.block;
+    m_offset = marker.offset;
+}
\ No newline at end of file
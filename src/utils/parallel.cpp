@@ -0,0 +1,20 @@
+#include "parallel.hpp"
+
+size_t getNumThreads(size_t numThreads)
+{
+    if(numThreads > 0)
+    {
+        return numThreads;
+    }
+    size_t hardwareThreads = std::thread::hardware_concurrency();
+    // hardware_concurrency() may return 0 when the number cannot be determined.
+    return (hardwareThreads > 0) ? hardwareThreads : 1;
+}
+
+size_t getChunkStart(size_t numItems, size_t numChunks, size_t chunkIndex)
+{
+    // The first (numItems % numChunks) chunks get one extra item each.
+    size_t base = numItems / numChunks;
+    size_t remainder = numItems % numChunks;
+    return chunkIndex * base + ((chunkIndex < remainder) ? chunkIndex : remainder);
+}
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "random_distributions.hpp"
+#include "random_generator.hpp"
+#include "matrix.hpp"
+#include "vectr.hpp"
+#include "parallel.hpp"
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Gamma samples are drawn by rejection, which needs a variable number of uniform
+    // numbers. Every sample gets its own range of positions, long enough for 21
+    // attempts; the chance of needing more (which would then read into the range of the
+    // next sample) is below 1e-27.
+    const uint64_t GAMMA_STRIDE = 64;
+    // Number of Box-Muller pairs transformed together.
+    const size_t NUM_PAIRS = 128;
+    // Fewer samples per thread than this are not worth starting a thread for.
+    const size_t MIN_CHUNK_SIZE = 16384;
+    const double TWO_PI = 6.283185307179586;
+
+    size_t getNumChunks(size_t count, size_t numThreads)
+    {
+        size_t numChunks = getNumThreads(numThreads);
+        size_t maxChunks = count / MIN_CHUNK_SIZE + 1;
+        return (numChunks < maxChunks) ? numChunks : maxChunks;
+    }
+
+    // Standard normal samples with indices first, ..., first + count - 1.
+    void fillStandardNormal(uint64_t seed, uint64_t stream, uint64_t first, double* out, size_t count)
+    {
+        double uniform[2 * NUM_PAIRS];
+        double normal[2 * NUM_PAIRS];
+        size_t i = 0;
+        while(i < count)
+        {
+            // The pairs containing the samples first + i, ... (up to NUM_PAIRS of them).
+            uint64_t firstPair = (first + i) / 2;
+            uint64_t lastPair = (first + count - 1) / 2;
+            size_t numPairs = ((lastPair - firstPair + 1) < NUM_PAIRS) ? (size_t)(lastPair - firstPair + 1) : NUM_PAIRS;
+            fillUniform(seed, stream, 2 * firstPair, uniform, 2 * numPairs);
+            for(size_t k = 0; k < numPairs; k++)
+            {
+                // 1 - u is in (0, 1], so the logarithm is finite.
+                double r = sqrt(-2 * log(1 - uniform[2 * k]));
+                double theta = TWO_PI * uniform[2 * k + 1];
+                normal[2 * k] = r * cos(theta);
+                normal[2 * k + 1] = r * sin(theta);
+            }
+            size_t offset = (size_t)(first + i - 2 * firstPair);
+            size_t numCopied = 2 * numPairs - offset;
+            numCopied = (numCopied < count - i) ? numCopied : (count - i);
+            for(size_t k = 0; k < numCopied; k++)
+            {
+                out[i + k] = normal[offset + k];
+            }
+            i += numCopied;
+        }
+    }
+
+    // Marsaglia and Tsang's method, for shape >= 1.
+    double getGammaSample(RandomStream& stream, double shape)
+    {
+        double d = shape - 1.0 / 3;
+        double c = 1 / sqrt(9 * d);
+        while(true)
+        {
+            double r = sqrt(-2 * log(1 - stream.getUniform()));
+            double x = r * cos(TWO_PI * stream.getUniform());
+            double v = 1 + c * x;
+            if(v <= 0)
+            {
+                continue;
+            }
+            v = v * v * v;
+            double u = 1 - stream.getUniform();
+            if(log(u) < 0.5 * x * x + d * (1 - v + log(v)))
+            {
+                return d * v;
+            }
+        }
+    }
+}
+
+RandomDistribution::RandomDistribution(DistributionEnum type, double a, double b)
+{
+    m_type = type;
+    m_a = a;
+    m_b = b;
+}
+
+RandomDistribution RandomDistribution::getUniform(double start, double end)
+{
+    return RandomDistribution(UNIFORM, start, end);
+}
+
+RandomDistribution RandomDistribution::getNormal(double mean, double standardDeviation)
+{
+    return RandomDistribution(NORMAL, mean, standardDeviation);
+}
+
+RandomDistribution RandomDistribution::getLogNormal(double mean, double standardDeviation)
+{
+    return RandomDistribution(LOG_NORMAL, mean, standardDeviation);
+}
+
+RandomDistribution RandomDistribution::getExponential(double rate)
+{
+    assert(rate > 0);
+    return RandomDistribution(EXPONENTIAL, rate, 0);
+}
+
+RandomDistribution RandomDistribution::getGamma(double shape, double scale)
+{
+    assert((shape > 0) && (scale > 0));
+    return RandomDistribution(GAMMA, shape, scale);
+}
+
+RandomDistribution RandomDistribution::getBernoulli(double p)
+{
+    return RandomDistribution(BERNOULLI, p, 0);
+}
+
+DistributionEnum RandomDistribution::getType() const
+{
+    return m_type;
+}
+
+uint64_t RandomDistribution::getStride() const
+{
+    return (m_type == GAMMA) ? GAMMA_STRIDE : 1;
+}
+
+void RandomDistribution::fill(uint64_t seed, uint64_t stream, uint64_t first, double* out, size_t count) const
+{
+    switch(m_type)
+    {
+        case UNIFORM:
+            fillUniform(seed, stream, first, out, count, m_a, m_b);
+            break;
+        case NORMAL:
+            fillStandardNormal(seed, stream, first, out, count);
+            for(size_t i = 0; i < count; i++)
+            {
+                out[i] = m_a + m_b * out[i];
+            }
+            break;
+        case LOG_NORMAL:
+            fillStandardNormal(seed, stream, first, out, count);
+            for(size_t i = 0; i < count; i++)
+            {
+                out[i] = exp(m_a + m_b * out[i]);
+            }
+            break;
+        case EXPONENTIAL:
+            fillUniform(seed, stream, first, out, count);
+            for(size_t i = 0; i < count; i++)
+            {
+                out[i] = -log(1 - out[i]) / m_a;
+            }
+            break;
+        case BERNOULLI:
+            fillUniform(seed, stream, first, out, count);
+            for(size_t i = 0; i < count; i++)
+            {
+                out[i] = (out[i] < m_a) ? 1 : 0;
+            }
+            break;
+        case GAMMA:
+        {
+            RandomStream sampleStream(seed, stream);
+            // For shape < 1, a sample for shape + 1 is scaled by u^(1 / shape).
+            double shape = (m_a < 1) ? (m_a + 1) : m_a;
+            for(size_t i = 0; i < count; i++)
+            {
+                sampleStream.setPosition((first + i) * GAMMA_STRIDE);
+                double x = getGammaSample(sampleStream, shape);
+                if(m_a < 1)
+                {
+                    x *= pow(1 - sampleStream.getUniform(), 1 / m_a);
+                }
+                out[i] = m_b * x;
+            }
+            break;
+        }
+    }
+}
+
+uint64_t RandomDistribution::getFirstIndex(const RandomStream& stream) const
+{
+    uint64_t stride = getStride();
+    uint64_t first = (stream.getPosition() + stride - 1) / stride;
+    if((m_type == NORMAL) || (m_type == LOG_NORMAL))
+    {
+        // Start at a new Box-Muller pair.
+        first += first % 2;
+    }
+    return first;
+}
+
+void RandomDistribution::skip(RandomStream& stream, uint64_t first, uint64_t count) const
+{
+    uint64_t next = first + count;
+    if((m_type == NORMAL) || (m_type == LOG_NORMAL))
+    {
+        next += next % 2;
+    }
+    stream.setPosition(next * getStride());
+}
+
+void RandomDistribution::fill(RandomStream& stream, double* out, size_t count, size_t numThreads) const
+{
+    uint64_t first = getFirstIndex(stream);
+    uint64_t seed = stream.getSeed();
+    uint64_t streamNumber = stream.getStream();
+    runInParallel(count, getNumChunks(count, numThreads), [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        fill(seed, streamNumber, first + chunkStart, out + chunkStart, chunkEnd - chunkStart);
+    });
+    skip(stream, first, count);
+}
+
+void RandomDistribution::fill(RandomStream& stream, Vector& v, size_t numThreads) const
+{
+    if(v.size() > 0)
+    {
+        fill(stream, &v[0], v.size(), numThreads);
+    }
+}
+
+void RandomDistribution::fill(RandomStream& stream, Matrix& m, size_t numThreads) const
+{
+    size_t numRows = m.getNumRows();
+    size_t numColumns = m.getNumColumns();
+    uint64_t first = getFirstIndex(stream);
+    uint64_t seed = stream.getSeed();
+    uint64_t streamNumber = stream.getStream();
+    size_t numChunks = getNumChunks(numRows * numColumns, numThreads);
+    numChunks = (numChunks < numRows) ? numChunks : ((numRows > 0) ? numRows : 1);
+    runInParallel(numRows, numChunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        for(size_t i = chunkStart; i < chunkEnd; i++)
+        {
+            fill(seed, streamNumber, first + i * numColumns, m[i].data(), numColumns);
+        }
+    });
+    skip(stream, first, numRows * numColumns);
+}
+
+Vector getRandomVector(size_t vectorSize, const RandomDistribution& distribution, RandomStream& stream, size_t numThreads)
+{
+    LinalgArray<double> data(vectorSize);
+    distribution.fill(stream, data.data(), vectorSize, numThreads);
+    return Vector(std::move(data));
+}
+
+Matrix getRandomMatrix(size_t numRows, size_t numColumns, const RandomDistribution& distribution, RandomStream& stream, size_t numThreads)
+{
+    Matrix m(LinalgArray<LinalgArray<double> >(numRows, LinalgArray<double>(numColumns)));
+    distribution.fill(stream, m, numThreads);
+    return m;
+}
+
+Matrix getMultivariateNormalMatrix(size_t numSamples, const Vector& mean, const Matrix& choleskyFactor, RandomStream& stream, size_t numThreads)
+{
+    size_t n = mean.size();
+    assert((choleskyFactor.getNumRows() == n) && (choleskyFactor.getNumColumns() == n));
+    Matrix samples = getRandomMatrix(numSamples, n, RandomDistribution::getNormal(), stream, numThreads);
+    size_t numChunks = getNumChunks(numSamples * n, numThreads);
+    numChunks = (numChunks < numSamples) ? numChunks : ((numSamples > 0) ? numSamples : 1);
+    runInParallel(numSamples, numChunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        // x = mean + L * z, in place: row i of L only uses z[0], ..., z[i], so the
+        // elements are computed from the last one back.
+        for(size_t s = chunkStart; s < chunkEnd; s++)
+        {
+            double* z = samples[s].data();
+            for(size_t i = n; i > 0; i--)
+            {
+                const double* l = choleskyFactor[i - 1].data();
+                double x = 0;
+                for(size_t k = 0; k < i; k++)
+                {
+                    x += l[k] * z[k];
+                }
+                z[i - 1] = mean[i - 1] + x;
+            }
+        }
+    });
+    return samples;
+}
\ No newline at end of file
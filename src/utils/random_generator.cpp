@@ -0,0 +1,222 @@
+#include "random_generator.hpp"
+#include "parallel.hpp"
+#include <atomic>
+
+namespace
+{
+    const uint32_t PHILOX_M0 = 0xD2511F53;
+    const uint32_t PHILOX_M1 = 0xCD9E8D57;
+    const uint32_t PHILOX_W0 = 0x9E3779B9;
+    const uint32_t PHILOX_W1 = 0xBB67AE85;
+    const size_t PHILOX_ROUNDS = 10;
+    // Number of blocks generated together by fillUniform.
+    const size_t NUM_LANES = 8;
+
+    double getUnitDouble(uint64_t word)
+    {
+        return (word >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    std::atomic<uint64_t> randomSeed(0);
+    // Incremented by every call of setRandomSeed, so the threads know to restart.
+    std::atomic<uint64_t> randomGeneration(0);
+    std::atomic<uint64_t> numThreadStreams(0);
+}
+
+void getPhiloxBlock(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+{
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for(size_t round = 0; round < PHILOX_ROUNDS; round++)
+    {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+void fillUniform(uint64_t seed, uint64_t stream, uint64_t position, double* out, size_t count, double start, double end)
+{
+    // Every block gives 2 words: block b holds the words 2b and 2b + 1.
+    double scale = end - start;
+    uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+    uint32_t counter[4] = {0, 0, (uint32_t)stream, (uint32_t)(stream >> 32)};
+    uint32_t block[4];
+    size_t i = 0;
+    if((position % 2 == 1) && (count > 0))
+    {
+        uint64_t b = position / 2;
+        counter[0] = (uint32_t)b;
+        counter[1] = (uint32_t)(b >> 32);
+        getPhiloxBlock(counter, key, block);
+        out[i++] = start + scale * getUnitDouble(((uint64_t)block[2] << 32) | block[3]);
+        position++;
+    }
+    // Whole groups of blocks, with the rounds running over the lanes in the inner loops so
+    // that they can be vectorized.
+    uint64_t firstBlock = position / 2;
+    while(i + 2 * NUM_LANES <= count)
+    {
+        uint32_t c0[NUM_LANES], c1[NUM_LANES], c2[NUM_LANES], c3[NUM_LANES];
+        for(size_t lane = 0; lane < NUM_LANES; lane++)
+        {
+            uint64_t b = firstBlock + lane;
+            c0[lane] = (uint32_t)b;
+            c1[lane] = (uint32_t)(b >> 32);
+            c2[lane] = counter[2];
+            c3[lane] = counter[3];
+        }
+        uint32_t k0 = key[0], k1 = key[1];
+        for(size_t round = 0; round < PHILOX_ROUNDS; round++)
+        {
+            for(size_t lane = 0; lane < NUM_LANES; lane++)
+            {
+                uint64_t p0 = (uint64_t)PHILOX_M0 * c0[lane];
+                uint64_t p1 = (uint64_t)PHILOX_M1 * c2[lane];
+                c0[lane] = (uint32_t)(p1 >> 32) ^ c1[lane] ^ k0;
+                c2[lane] = (uint32_t)(p0 >> 32) ^ c3[lane] ^ k1;
+                c1[lane] = (uint32_t)p1;
+                c3[lane] = (uint32_t)p0;
+            }
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        for(size_t lane = 0; lane < NUM_LANES; lane++)
+        {
+            out[i + 2 * lane] = start + scale * getUnitDouble(((uint64_t)c0[lane] << 32) | c1[lane]);
+            out[i + 2 * lane + 1] = start + scale * getUnitDouble(((uint64_t)c2[lane] << 32) | c3[lane]);
+        }
+        i += 2 * NUM_LANES;
+        firstBlock += NUM_LANES;
+    }
+    for(uint64_t b = firstBlock; i < count; b++)
+    {
+        counter[0] = (uint32_t)b;
+        counter[1] = (uint32_t)(b >> 32);
+        getPhiloxBlock(counter, key, block);
+        out[i++] = start + scale * getUnitDouble(((uint64_t)block[0] << 32) | block[1]);
+        if(i < count)
+        {
+            out[i++] = start + scale * getUnitDouble(((uint64_t)block[2] << 32) | block[3]);
+        }
+    }
+}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t stream)
+{
+    m_seed = seed;
+    m_stream = stream;
+    m_position = 0;
+    // No block is buffered yet.
+    m_bufferBlock = UINT64_MAX;
+    m_buffer[0] = m_buffer[1] = 0;
+}
+
+uint64_t RandomStream::getWord()
+{
+    uint64_t b = m_position / 2;
+    if(b != m_bufferBlock)
+    {
+        uint32_t key[2] = {(uint32_t)m_seed, (uint32_t)(m_seed >> 32)};
+        uint32_t counter[4] = {(uint32_t)b, (uint32_t)(b >> 32), (uint32_t)m_stream, (uint32_t)(m_stream >> 32)};
+        uint32_t block[4];
+        getPhiloxBlock(counter, key, block);
+        m_buffer[0] = ((uint64_t)block[0] << 32) | block[1];
+        m_buffer[1] = ((uint64_t)block[2] << 32) | block[3];
+        m_bufferBlock = b;
+    }
+    return m_buffer[m_position++ % 2];
+}
+
+double RandomStream::getUniform()
+{
+    return getUnitDouble(getWord());
+}
+
+double RandomStream::getUniform(double start, double end)
+{
+    return start + (end - start) * getUnitDouble(getWord());
+}
+
+uint64_t RandomStream::getInteger()
+{
+    return getWord();
+}
+
+uint64_t RandomStream::operator()()
+{
+    return getWord();
+}
+
+void RandomStream::fill(double* out, size_t count, double start, double end, size_t numThreads)
+{
+    // Short fills are not worth starting threads for.
+    size_t numChunks = getNumThreads(numThreads);
+    size_t maxChunks = count / (2 * NUM_LANES * 64) + 1;
+    numChunks = (numChunks < maxChunks) ? numChunks : maxChunks;
+    uint64_t position = m_position;
+    uint64_t seed = m_seed, stream = m_stream;
+    runInParallel(count, numChunks, [=](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        fillUniform(seed, stream, position + chunkStart, out + chunkStart, chunkEnd - chunkStart, start, end);
+    });
+    m_position += count;
+}
+
+uint64_t RandomStream::getSeed() const
+{
+    return m_seed;
+}
+
+uint64_t RandomStream::getStream() const
+{
+    return m_stream;
+}
+
+uint64_t RandomStream::getPosition() const
+{
+    return m_position;
+}
+
+void RandomStream::setPosition(uint64_t position)
+{
+    m_position = position;
+}
+
+void RandomStream::skip(uint64_t count)
+{
+    m_position += count;
+}
+
+void setRandomSeed(uint64_t seed)
+{
+    randomSeed = seed;
+    numThreadStreams = 0;
+    randomGeneration++;
+}
+
+uint64_t getRandomSeed()
+{
+    return randomSeed;
+}
+
+RandomStream& getThreadRandomStream()
+{
+    thread_local RandomStream threadStream;
+    thread_local uint64_t threadGeneration = UINT64_MAX;
+    if(threadGeneration != randomGeneration)
+    {
+        threadGeneration = randomGeneration;
+        threadStream = RandomStream(randomSeed, numThreadStreams++);
+    }
+    return threadStream;
+}
\ No newline at end of file
@@ -1,35 +1,274 @@
 #include "random_quantities.hpp"
 #include "matrix.hpp"
 #include "vectr.hpp"
-#include <cstdlib>
+#include "sparse_matrix.hpp"
+#include "sparse_vector.hpp"
+#include "random_generator.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+    // Fewer elements per thread than this are not worth starting a thread for.
+    const size_t MIN_CHUNK_SIZE = 16384;
+
+    size_t getNumChunks(size_t numElements, size_t numThreads)
+    {
+        size_t numChunks = getNumThreads(numThreads);
+        size_t maxChunks = numElements / MIN_CHUNK_SIZE + 1;
+        return (numChunks < maxChunks) ? numChunks : maxChunks;
+    }
+
+    // Number of stream positions reserved for each row of a random sparse matrix with
+    // numColumns columns: the row needs at most one number per element to skip to the
+    // next stored one, and one for its value.
+    uint64_t getSparseRowStride(size_t numColumns)
+    {
+        return 2 * (uint64_t)numColumns + 2;
+    }
+
+    // Stores every element of the row in [columnStart, columnEnd) with probability p, by
+    // drawing the geometrically distributed gaps between the stored elements from the
+    // stream starting at position.
+    void appendRandomRow(const RandomStream& stream, uint64_t position, size_t row, size_t columnStart, size_t columnEnd, double p, double start, double end, std::vector<SparseMatrixEntry>& entries)
+    {
+        if((p <= 0) || (columnStart >= columnEnd))
+        {
+            return;
+        }
+        RandomStream rowStream(stream.getSeed(), stream.getStream());
+        rowStream.setPosition(position);
+        double logComplement = (p < 1) ? log(1 - p) : 0;
+        size_t j = columnStart;
+        while(true)
+        {
+            if(p < 1)
+            {
+                // 1 - u is in (0, 1], so the logarithm is finite.
+                double gap = floor(log(1 - rowStream.getUniform()) / logComplement);
+                if(gap >= (double)(columnEnd - j))
+                {
+                    return;
+                }
+                j += (size_t)gap;
+            }
+            entries.push_back({row, j, rowStream.getUniform(start, end)});
+            j++;
+            if(j >= columnEnd)
+            {
+                return;
+            }
+        }
+    }
+
+    // Generates rows [0, numRows) in parallel by calling
+    // generateRow(row, entries), and concatenates the entries in row order.
+    template <typename Function>
+    std::vector<SparseMatrixEntry> getRowEntries(size_t numRows, size_t numElements, size_t numThreads, const Function& generateRow)
+    {
+        size_t numChunks = getNumChunks(numElements, numThreads);
+        numChunks = (numChunks < numRows) ? numChunks : ((numRows > 0) ? numRows : 1);
+        std::vector<std::vector<SparseMatrixEntry> > chunkEntries(numChunks);
+        runInParallel(numRows, numChunks, [&](size_t chunkIndex, size_t chunkStart, size_t chunkEnd)
+        {
+            for(size_t i = chunkStart; i < chunkEnd; i++)
+            {
+                generateRow(i, chunkEntries[chunkIndex]);
+            }
+        });
+        size_t count = 0;
+        for(const auto& e: chunkEntries)
+        {
+            count += e.size();
+        }
+        std::vector<SparseMatrixEntry> entries;
+        entries.reserve(count);
+        for(auto& e: chunkEntries)
+        {
+            entries.insert(entries.end(), e.begin(), e.end());
+            std::vector<SparseMatrixEntry>().swap(e);
+        }
+        return entries;
+    }
+
+    bool isBefore(const SparseMatrixEntry& a, const SparseMatrixEntry& b)
+    {
+        return (a.row < b.row) || ((a.row == b.row) && (a.column < b.column));
+    }
+}
 
 double getRandom(double start, double end)
 {
-    double diff = (end - start);
-    double frac = rand() / (double)RAND_MAX;
-    return start + diff * frac;
+    return getThreadRandomStream().getUniform(start, end);
 }
 
-Matrix getRandomMatrix(size_t numRows, size_t numColumns, double start, double end)
+Matrix getRandomMatrix(size_t numRows, size_t numColumns, double start, double end, RandomStream& stream, size_t numThreads)
 {
-    std::vector<std::vector<double> > data = {};
-    for(size_t i = 0; i < numRows; i++)
+    LinalgArray<LinalgArray<double> > data(numRows);
+    uint64_t seed = stream.getSeed();
+    uint64_t streamNumber = stream.getStream();
+    uint64_t position = stream.getPosition();
+    size_t numChunks = getNumChunks(numRows * numColumns, numThreads);
+    numChunks = (numChunks < numRows) ? numChunks : ((numRows > 0) ? numRows : 1);
+    // Every thread also allocates its own rows, except inside an arena scope, because the
+    // arena must only be used by the thread which opened it.
+    if(data.get_allocator().getArena() != nullptr)
     {
-        data.push_back({});
-        for(size_t j = 0; j < numColumns; j++)
+        for(auto& row: data)
         {
-            data[i].push_back(getRandom(start, end));
+            row.resize(numColumns);
         }
     }
-    return Matrix(data);
+    runInParallel(numRows, numChunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        for(size_t i = chunkStart; i < chunkEnd; i++)
+        {
+            data[i].resize(numColumns);
+            fillUniform(seed, streamNumber, position + i * numColumns, data[i].data(), numColumns, start, end);
+        }
+    });
+    stream.skip(numRows * numColumns);
+    return Matrix(std::move(data));
+}
+
+Vector getRandomVector(size_t vectorSize, double start, double end, RandomStream& stream, size_t numThreads)
+{
+    LinalgArray<double> data(vectorSize);
+    stream.fill(data.data(), vectorSize, start, end, getNumChunks(vectorSize, numThreads));
+    return Vector(std::move(data));
+}
+
+Matrix getRandomMatrix(size_t numRows, size_t numColumns, double start, double end)
+{
+    return getRandomMatrix(numRows, numColumns, start, end, getThreadRandomStream());
 }
 
 Vector getRandomVector(size_t vectorSize, double start, double end)
 {
-    std::vector<double> data = {};
-    for(size_t i = 0; i < vectorSize; i++)
+    return getRandomVector(vectorSize, start, end, getThreadRandomStream());
+}
+
+SparseVector getRandomSparseVector(size_t vectorSize, size_t numNonDefault, double defaultValue, double start, double end, RandomStream& stream)
+{
+    double p = (vectorSize > 0) ? (double)numNonDefault / vectorSize : 0;
+    std::vector<SparseMatrixEntry> entries;
+    appendRandomRow(stream, stream.getPosition(), 0, 0, vectorSize, p, start, end, entries);
+    stream.skip(getSparseRowStride(vectorSize));
+    SparseVector r(defaultValue, vectorSize);
+    for(const auto& e: entries)
+    {
+        r.pushBack(e.column, e.value);
+    }
+    return r;
+}
+
+SparseMatrix getRandomSparseMatrix(size_t numRows, size_t numColumns, size_t numNonDefault, double defaultValue, double start, double end, RandomStream& stream, size_t numThreads)
+{
+    double numElements = (double)numRows * numColumns;
+    double p = (numElements > 0) ? numNonDefault / numElements : 0;
+    uint64_t position = stream.getPosition();
+    uint64_t stride = getSparseRowStride(numColumns);
+    std::vector<SparseMatrixEntry> entries = getRowEntries(numRows, numNonDefault, numThreads, [&](size_t i, std::vector<SparseMatrixEntry>& rowEntries)
+    {
+        appendRandomRow(stream, position + i * stride, i, 0, numColumns, p, start, end, rowEntries);
+    });
+    stream.skip(numRows * stride);
+    return SparseMatrix(defaultValue, numRows, numColumns, entries);
+}
+
+SparseMatrix getRandomBandedMatrix(size_t numRows, size_t numColumns, size_t lowerBandwidth, size_t upperBandwidth, double defaultValue, double start, double end, RandomStream& stream, size_t numThreads)
+{
+    uint64_t position = stream.getPosition();
+    uint64_t stride = (uint64_t)lowerBandwidth + upperBandwidth + 1;
+    std::vector<SparseMatrixEntry> entries = getRowEntries(numRows, numRows * stride, numThreads, [&](size_t i, std::vector<SparseMatrixEntry>& rowEntries)
+    {
+        // Element (i, j) has the position i * stride + (j + lowerBandwidth - i).
+        size_t columnStart = (i > lowerBandwidth) ? (i - lowerBandwidth) : 0;
+        size_t columnEnd = ((i + upperBandwidth + 1) < numColumns) ? (i + upperBandwidth + 1) : numColumns;
+        if(columnStart >= columnEnd)
+        {
+            return;
+        }
+        RandomStream rowStream(stream.getSeed(), stream.getStream());
+        rowStream.setPosition(position + i * stride + (columnStart + lowerBandwidth - i));
+        for(size_t j = columnStart; j < columnEnd; j++)
+        {
+            rowEntries.push_back({i, j, rowStream.getUniform(start, end)});
+        }
+    });
+    stream.skip(numRows * stride);
+    return SparseMatrix(defaultValue, numRows, numColumns, entries);
+}
+
+SparseMatrix getRMATMatrix(size_t scale, size_t numEdges, double a, double b, double c, double defaultValue, double start, double end, RandomStream& stream, size_t numThreads)
+{
+    assert((scale < 64) && (a >= 0) && (b >= 0) && (c >= 0) && (a + b + c <= 1));
+    size_t size = (size_t)1 << scale;
+    uint64_t position = stream.getPosition();
+    uint64_t stride = scale + 1;
+    size_t numChunks = getNumChunks(numEdges, numThreads);
+    std::vector<SparseMatrixEntry> entries(numEdges);
+    runInParallel(numEdges, numChunks, [&](size_t, size_t chunkStart, size_t chunkEnd)
+    {
+        RandomStream edgeStream(stream.getSeed(), stream.getStream());
+        edgeStream.setPosition(position + chunkStart * stride);
+        for(size_t e = chunkStart; e < chunkEnd; e++)
+        {
+            size_t row = 0, column = 0;
+            for(size_t level = 0; level < scale; level++)
+            {
+                double u = edgeStream.getUniform();
+                // The quadrants a, b, c and d are top left, top right, bottom left
+                // and bottom right.
+                bool bottom = (u >= a + b);
+                bool right = ((u >= a) && (u < a + b)) || (u >= a + b + c);
+                row = (row << 1) | (bottom ? 1 : 0);
+                column = (column << 1) | (right ? 1 : 0);
+            }
+            entries[e] = {row, column, edgeStream.getUniform(start, end)};
+        }
+    });
+    stream.skip(numEdges * stride);
+    // Sorting by (row, column, edge) keeps the first of the edges on the same element.
+    std::stable_sort(entries.begin(), entries.end(), isBefore);
+    auto last = std::unique(entries.begin(), entries.end(), [](const SparseMatrixEntry& x, const SparseMatrixEntry& y)
+    {
+        return (x.row == y.row) && (x.column == y.column);
+    });
+    entries.erase(last, entries.end());
+    return SparseMatrix(defaultValue, size, size, entries);
+}
+
+SparseMatrix getRandomSPDMatrix(size_t size, size_t numNonDefault, double start, double end, RandomStream& stream, size_t numThreads)
+{
+    // The strictly upper triangular part, mirrored, and the diagonal.
+    double numPairs = 0.5 * (double)size * ((size > 0) ? size - 1 : 0);
+    double numOffDiagonal = (numNonDefault > size) ? 0.5 * (numNonDefault - size) : 0;
+    double p = (numPairs > 0) ? numOffDiagonal / numPairs : 0;
+    uint64_t position = stream.getPosition();
+    uint64_t stride = getSparseRowStride(size);
+    std::vector<SparseMatrixEntry> upper = getRowEntries(size, numNonDefault, numThreads, [&](size_t i, std::vector<SparseMatrixEntry>& rowEntries)
+    {
+        appendRandomRow(stream, position + i * stride, i, i + 1, size, p, start, end, rowEntries);
+    });
+    stream.skip(size * stride);
+    std::vector<double> diagonal(size, 1);
+    std::vector<SparseMatrixEntry> entries;
+    entries.reserve(2 * upper.size() + size);
+    for(const auto& e: upper)
+    {
+        diagonal[e.row] += fabs(e.value);
+        diagonal[e.column] += fabs(e.value);
+        entries.push_back(e);
+        entries.push_back({e.column, e.row, e.value});
+    }
+    for(size_t i = 0; i < size; i++)
     {
-        data.push_back(getRandom(start, end));
+        entries.push_back({i, i, diagonal[i]});
     }
-    return Vector(data);
+    std::sort(entries.begin(), entries.end(), isBefore);
+    return SparseMatrix(0, size, size, entries);
 }
\ No newline at end of file
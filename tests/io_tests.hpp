@@ -0,0 +1,408 @@
+#include "test_base.hpp"
+#include "binary_io.hpp"
+#include "matrix_market.hpp"
+#include "matrix_view.hpp"
+#include "npy_io.hpp"
+#include "random_generator.hpp"
+#include "random_quantities.hpp"
+#include "text_writer.hpp"
+#include "tiled_matrix.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+void performIOTests(vector<TestParams>& testParamsList)
+{
+    string testName;
+    bool passed;
+    {
+        testName = "Binary file of Matrix and Vector";
+        cout << "TEST: " << testName << endl;
+        RandomStream stream(11);
+        Matrix m = getRandomMatrix(37, 23, -5, 5, stream);
+        Vector v = getRandomVector(101, -5, 5, stream);
+        string matrixPath = "io_test_matrix.bin", vectorPath = "io_test_vector.bin";
+        passed = writeBinaryFile(matrixPath, m) && writeBinaryFile(vectorPath, v, false);
+        {
+            MappedMatrix mapped(matrixPath, true);
+            MappedVector mappedVector(vectorPath, true);
+            passed = passed && (mapped.getNumRows() == 37) && (mapped.getNumColumns() == 23);
+            passed = passed && (mapped(3, 4) == m[3][4]) && (mapped[36][22] == m[36][22]);
+            passed = passed && (mapped.getMatrix().getData() == m.getData());
+            // Used in place, through the row accessor, by the kernels and the views.
+            Vector w = getRandomVector(23, -5, 5, stream);
+            passed = passed && areEqual(getMatrixVectorProduct<double>(mapped, w, 37, 23), m * w, 37, 1e-12);
+            Matrix sum = getRandomMatrix(40, 30, -1, 1, stream);
+            sum.getBlock(2, 3, 37, 23).setSum(mapped, m);
+            passed = passed && areEqual(sum.getBlock(2, 3, 37, 23), m * 2, 37, 23, 0);
+            passed = passed && (mappedVector.size() == 101) && (mappedVector.getVector().getData() == v.getData());
+            // The payload is aligned, so the mapped doubles can be used in place.
+            passed = passed && (reinterpret_cast<uintptr_t>(mapped.getData()) % BINARY_ALIGNMENT == 0);
+        }
+        // A changed element is caught by the checksum.
+        {
+            fstream f(matrixPath, ios::in | ios::out | ios::binary);
+            f.seekp(BINARY_HEADER_SIZE + 8 * 100);
+            double changed = 1.5;
+            f.write(reinterpret_cast<const char*>(&changed), sizeof(double));
+        }
+        passed = passed && !verifyBinaryChecksum(MappedFile(matrixPath)) && verifyBinaryChecksum(MappedFile(vectorPath));
+        BinaryFileHeader header;
+        string error;
+        passed = passed && readBinaryFileHeader(MappedFile(matrixPath), header, error) && (header.objectType == BINARY_MATRIX);
+        passed = passed && !readBinaryFileHeader(MappedFile("io_test_missing.bin"), header, error);
+        {
+            ofstream f(vectorPath, ios::binary | ios::in | ios::out);
+            f.seekp(0);
+            f.write("NOTMATHS", 8);
+        }
+        passed = passed && !readBinaryFileHeader(MappedFile(vectorPath), header, error);
+        // The constructors with an error string leave the views empty on invalid files.
+        {
+            MappedMatrix changed(matrixPath, error, true);
+            passed = passed && !changed.isValid() && (error == "the checksum does not match") && (changed.getNumRows() == 0);
+            MappedMatrix unchecked(matrixPath, error);
+            passed = passed && unchecked.isValid() && error.empty() && (unchecked.getNumRows() == 37);
+            MappedVector wrongType(matrixPath, error);
+            passed = passed && !wrongType.isValid() && !error.empty() && (wrongType.size() == 0) && (wrongType.getData() == nullptr);
+            MappedVector corrupted(vectorPath, error);
+            passed = passed && !corrupted.isValid() && (error == "not a binary matrix file");
+            MappedMatrix missing("io_test_missing.bin", error);
+            passed = passed && !missing.isValid() && (error == "the file could not be opened");
+        }
+        remove(matrixPath.c_str());
+        remove(vectorPath.c_str());
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Binary file of SparseMatrix";
+        cout << "TEST: " << testName << endl;
+        RandomStream stream(12);
+        const SparseMatrix sm = getRandomSparseMatrix(120, 90, 900, 0.25, -1, 1, stream);
+        Vector v = getRandomVector(90, -1, 1, stream);
+        string path = "io_test_sparse.bin";
+        passed = writeBinaryFile(path, sm);
+        {
+            MappedSparseMatrix mapped(path, true);
+            passed = passed && (mapped.getNumRows() == 120) && (mapped.getNumColumns() == 90);
+            passed = passed && (mapped.getNumStoredElements() == sm.getNumStoredElements()) && (mapped.getDefaultValue() == 0.25);
+            bool same = true;
+            for(size_t i = 0; i < 120; i++)
+            {
+                for(size_t j = 0; j < 90; j++)
+                {
+                    same = same && (mapped(i, j) == sm[i][j]);
+                }
+            }
+            passed = passed && same && areEqual(mapped.getSparseMatrix().getFullMatrix(), sm.getFullMatrix(), 120, 90, 0);
+            passed = passed && areEqual(mapped * v, sm * v, 120, 1.e-12);
+        }
+        // Corrupted CSR arrays and sizes are reported when opening, not when reading.
+        BinaryFileHeader header;
+        string error;
+        size_t columnsOffset = (BINARY_HEADER_SIZE + 121 * 8 + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT * BINARY_ALIGNMENT;
+        uint64_t badValues[3] = {90, 1000000, 0};
+        size_t badOffsets[3] = {columnsOffset, BINARY_HEADER_SIZE + 8 * 60, BINARY_HEADER_SIZE + 8 * 120};
+        for(size_t n = 0; n < 3; n++)
+        {
+            passed = passed && writeBinaryFile(path, sm, false);
+            {
+                fstream f(path, ios::in | ios::out | ios::binary);
+                f.seekp(badOffsets[n]);
+                f.write(reinterpret_cast<const char*>(&badValues[n]), sizeof(uint64_t));
+            }
+            passed = passed && !readBinaryFileHeader(MappedFile(path), header, error) && !error.empty();
+        }
+        passed = passed && writeBinaryFile(path, sm, false);
+        {
+            // numStored such that numStored * sizeof(double) wraps around to a small size.
+            uint64_t numStored = (1ULL << 61) + 1;
+            fstream f(path, ios::in | ios::out | ios::binary);
+            f.seekp(offsetof(BinaryFileHeader, numStored));
+            f.write(reinterpret_cast<const char*>(&numStored), sizeof(uint64_t));
+        }
+        error.clear();
+        passed = passed && !readBinaryFileHeader(MappedFile(path), header, error) && (error == "the file is truncated");
+        {
+            MappedSparseMatrix truncated(path, error);
+            passed = passed && !truncated.isValid() && (error == "the file is truncated") && (truncated.getNumStoredElements() == 0);
+        }
+        remove(path.c_str());
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Matrix Market files";
+        cout << "TEST: " << testName << endl;
+        RandomStream stream(13);
+        const SparseMatrix sm = getRandomSparseMatrix(2000, 1500, 30000, 0, -1, 1, stream);
+        string path = "io_test_matrix.mtx";
+        string error;
+        passed = writeMatrixMarketFile(path, sm) && !writeMatrixMarketFile(path + ".bad", getRandomSparseMatrix(5, 5, 5, 1, 0, 1, stream));
+        // The values are written in their shortest exact form, and read back exactly,
+        // whatever the number of chunks.
+        for(size_t numThreads: {1, 7})
+        {
+            const SparseMatrix read = readMatrixMarketFile(path, error, numThreads);
+            passed = passed && error.empty() && (read.getNumRows() == 2000) && (read.getNumColumns() == 1500);
+            passed = passed && (read.getNumStoredElements() == sm.getNumStoredElements());
+            passed = passed && areEqual(read.getFullMatrix(), sm.getFullMatrix(), 2000, 1500, 0);
+        }
+        // Symmetric pattern file with comments, blank lines and CRLF line ends.
+        {
+            ofstream f(path, ios::binary);
+            f << "%%MatrixMarket matrix coordinate pattern symmetric\r\n% comment\r\n\r\n3 3 4\r\n1 1\r\n2 1\r\n3 2\r\n\r\n3 3\r\n";
+        }
+        const SparseMatrix symmetric = readMatrixMarketFile(path, error);
+        Matrix expected = vector<vector<double> >{{1, 1, 0}, {1, 0, 1}, {0, 1, 1}};
+        passed = passed && error.empty() && areEqual(symmetric.getFullMatrix(), expected, 3, 3, 0);
+        {
+            ofstream f(path, ios::binary);
+            f << "%%MatrixMarket matrix coordinate real skew-symmetric\n2 2 1\n2 1 -2.5e-1";
+        }
+        const SparseMatrix skew = readMatrixMarketFile(path, error, 4);
+        passed = passed && error.empty() && (skew[1][0] == -0.25) && (skew[0][1] == 0.25);
+        // Explicit plus signs, as printed with the %+ flag.
+        {
+            ofstream f(path, ios::binary);
+            f << "%%MatrixMarket matrix coordinate real general\n+2 2 +2\n1 +2 +1.5e+0\n+2 1 -3\n";
+        }
+        const SparseMatrix signs = readMatrixMarketFile(path, error);
+        passed = passed && error.empty() && (signs[0][1] == 1.5) && (signs[1][0] == -3) && (signs.getNumStoredElements() == 2);
+        // Malformed files.
+        for(string text: {"%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n",
+                          "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 x 1.0\n",
+                          "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1.0\n",
+                          "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n4\n",
+                          "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 +-1.0\n",
+                          "2 2 1\n1 1 1.0\n"})
+        {
+            {
+                ofstream f(path, ios::binary);
+                f << text;
+            }
+            readMatrixMarketFile(path, error);
+            passed = passed && !error.empty();
+        }
+        // An empty file is told apart from a missing one.
+        {
+            ofstream f(path, ios::binary);
+        }
+        passed = passed && (readMatrixMarketFile(path, error).getNumRows() == 0) && (error == "the file is empty");
+        readMatrixMarketFile("io_test_missing.mtx", error);
+        passed = passed && (error == "the file could not be opened");
+        remove(path.c_str());
+        remove((path + ".bad").c_str());
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Streaming text writer";
+        cout << "TEST: " << testName << endl;
+        Matrix m = vector<vector<double> >{{1.5, -20.25, 3}, {0, 1e6, -0.125}};
+        passed = (m.getText() == "1.500000       -20.250000     3.000000       \n"
+                                 "0.000000       1000000.000000 -0.125000      \n");
+        Vector v = vector<double>{2.5, -1, 100};
+        passed = passed && (v.getText() == "2.500000   -1.000000  100.000000 ");
+        // Chunked output through a stream and a callback, with another precision.
+        ostringstream os;
+        {
+            TextWriter writer(os, 2, 5);
+            writeText(writer, m);
+        }
+        passed = passed && (os.str() == "1.50       -20.25     3.00       \n0.00       1000000.00 -0.12      \n");
+        size_t numChunks = 0;
+        string chunked;
+        {
+            TextWriter writer([&](const char* data, size_t count) { numChunks++; chunked.append(data, count); }, 6, 7);
+            writeText(writer, v);
+        }
+        passed = passed && (chunked == v.getText()) && (numChunks == 5);
+        // The sparse versions only visit the stored elements.
+        RandomStream stream(17);
+        const SparseMatrix sm = getRandomSparseMatrix(40, 30, 120, 0, -100, 100, stream);
+        passed = passed && (sm.getText() == sm.getFullMatrix().getText());
+        SparseMatrix shifted(-1.5, 4, 3);
+        shifted[1][2] = 12.5;
+        shifted[3][0] = 2;
+        const SparseMatrix& constShifted = shifted;
+        passed = passed && (constShifted.getText() == constShifted.getFullMatrix().getText());
+        SparseVector sv(0.5, 6);
+        sv[4] = -3;
+        const SparseVector& constSv = sv;
+        passed = passed && (constSv.getText() == "0.500000  0.500000  0.500000  0.500000  -3.000000 0.500000  ");
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Out-of-core tiled matrix operations";
+        cout << "TEST: " << testName << endl;
+        RandomStream stream(23);
+        // Tiles of 16 do not divide the dimensions, so the edge tiles are padded.
+        Matrix m = getRandomMatrix(70, 45, -1, 1, stream);
+        Matrix m2 = getRandomMatrix(45, 38, -1, 1, stream);
+        Vector v = getRandomVector(45, -1, 1, stream);
+        string pathA = "io_test_tiled_a.bin", pathB = "io_test_tiled_b.bin", pathC = "io_test_tiled_c.bin", pathT = "io_test_tiled_t.bin";
+        {
+            TiledMatrix a(pathA, m, 16);
+            passed = (a.getNumTileRows() == 5) && (a.getNumTileColumns() == 3) && (a.getTileNumRows(4) == 6);
+            Matrix edge = a.getTile(4, 2);
+            passed = passed && (a(69, 44) == m[69][44]) && (edge.getNumRows() == 6) && (edge.getNumColumns() == 13);
+            passed = passed && (edge[5][12] == m[69][44]) && (edge[0][0] == m[64][32]);
+            passed = passed && areEqual(a.getMatrix(), m, 70, 45, 0) && a.sync();
+        }
+        {
+            // Reopened from the file.
+            const TiledMatrix a(pathA);
+            string error;
+            TiledMatrix checked(pathA, error);
+            passed = passed && checked.isValid() && error.empty() && (checked.getNumTileColumns() == 3);
+            TiledMatrix missing("io_test_tiled_missing.bin", error);
+            passed = passed && !missing.isValid() && !error.empty() && (missing.getNumRows() == 0) && (missing.getNumTileRows() == 0);
+            passed = passed && writeBinaryFile(pathT, m);
+            TiledMatrix wrongType(pathT, error);
+            passed = passed && !wrongType.isValid() && !error.empty() && (wrongType.getNumColumns() == 0);
+            TiledMatrix b(pathB, m2, 16);
+            TiledMatrix c(pathC, 70, 38, 16);
+            getTiledProduct(a, b, c, 3);
+            passed = passed && areEqual(c.getMatrix(), m * m2, 70, 38, 1e-12);
+            passed = passed && areEqual(getTiledProduct(a, v), m * v, 70, 1e-12);
+            TiledMatrix t(pathT, 45, 70, 16);
+            getTiledTranspose(a, t);
+            passed = passed && areEqual(t.getMatrix(), m.getTranspose(), 45, 70, 0);
+            Matrix tile = t.getTile(2, 4);
+            passed = passed && (tile.getNumRows() == 13) && (tile.getNumColumns() == 6) && (tile[12][5] == m[69][44]);
+        }
+        {
+            // Zeros on the diagonal, so the rows have to be exchanged, across tiles too.
+            Matrix d = getRandomMatrix(53, 53, -1, 1, stream);
+            for(size_t i = 0; i < 53; i++)
+            {
+                d[i][i] = 0;
+            }
+            Vector x = getRandomVector(53, -1, 1, stream);
+            TiledMatrix lu(pathA, d, 16);
+            vector<size_t> pivots = getTiledLUFactorization(lu, 2);
+            passed = passed && (pivots.size() == 53) && areEqual(getTiledLUSolution(lu, pivots, d * x), x, 53, 1e-10);
+            // L * U gives back the matrix with the rows exchanged.
+            Matrix factors = lu.getMatrix();
+            Matrix l = factors, u = factors, permuted = d;
+            for(size_t i = 0; i < 53; i++)
+            {
+                passed = passed && (pivots[i] >= i) && (pivots[i] < 53);
+                swap(permuted[i], permuted[pivots[i]]);
+                for(size_t j = 0; j < 53; j++)
+                {
+                    passed = passed && ((j >= i) || (abs(factors[i][j]) <= 1));
+                    l[i][j] = (j < i) ? factors[i][j] : ((i == j) ? 1 : 0);
+                    u[i][j] = (j >= i) ? factors[i][j] : 0;
+                }
+            }
+            passed = passed && areEqual(l * u, permuted, 53, 53, 1e-12);
+        }
+        remove(pathA.c_str());
+        remove(pathB.c_str());
+        remove(pathC.c_str());
+        remove(pathT.c_str());
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "NumPy .npy and .npz files";
+        cout << "TEST: " << testName << endl;
+        RandomStream stream(29);
+        Matrix m = getRandomMatrix(7, 5, -1, 1, stream);
+        Vector v = getRandomVector(11, -1, 1, stream);
+        string path = "io_test_array.npy", bundlePath = "io_test_arrays.npz";
+        string error;
+        passed = writeNpyFile(path, m);
+        {
+            NpyArray a = readNpyFile(path, error);
+            passed = passed && error.empty() && (a.getNumDimensions() == 2) && (a.getNumRows() == 7) && (a.getNumColumns() == 5);
+            // Elements start at a multiple of 64 bytes, so they can be used in place.
+            passed = passed && (a.getDoubleData() != nullptr) && (a.getDoubleData()[6] == m[1][1]);
+            passed = passed && areEqual(a.getMatrix(), m, 7, 5, 0);
+        }
+        passed = passed && writeNpyFile(path, m, NPY_FLOAT32, true);
+        {
+            NpyArray a = readNpyFile(path, error);
+            passed = passed && error.empty() && a.isFortranOrder() && (a.getDataType() == NPY_FLOAT32);
+            passed = passed && (a.getElement(1) == (float)m[1][0]) && (a[1][0] == (float)m[1][0]) && areEqual(a.getMatrix(), m, 7, 5, 1e-7);
+            // Used in place, through the row accessor, by the kernels and the views.
+            Vector w = getRandomVector(5, -1, 1, stream);
+            passed = passed && areEqual(getMatrixVectorProduct<double>(a, w, 7, 5), m * w, 7, 1e-6);
+            Matrix transpose = m.getTranspose();
+            Matrix product = getRandomMatrix(9, 9, -1, 1, stream);
+            product.getBlock(1, 2, 7, 7).setProduct(a, transpose);
+            passed = passed && areEqual(product.getBlock(1, 2, 7, 7), m * transpose, 7, 7, 1e-6);
+        }
+        passed = passed && writeNpyFile(path, v);
+        {
+            NpyArray a = readNpyFile(path, error);
+            passed = passed && error.empty() && (a.getShape() == vector<size_t>{11}) && areEqual(a.getVector(), v, 11, 0);
+        }
+        // A big-endian float32 array in Fortran order, as written by NumPy.
+        {
+            string header = "{'descr': '>f4', 'fortran_order': True, 'shape': (2, 3), }";
+            header.append(117 - header.size(), ' ');
+            header += '\n';
+            ofstream f(path, ios::binary);
+            f.write("\x93NUMPY\x01\x00\x76\x00", 10);
+            f << header;
+            for(float x: {1.0f, 4.0f, 2.0f, 5.0f, 3.0f, 6.5f})
+            {
+                uint32_t bits;
+                memcpy(&bits, &x, 4);
+                char bytes[4] = {(char)(bits >> 24), (char)(bits >> 16), (char)(bits >> 8), (char)bits};
+                f.write(bytes, 4);
+            }
+        }
+        {
+            NpyArray a = readNpyFile(path, error);
+            Matrix expected = vector<vector<double> >{{1, 2, 3}, {4, 5, 6.5}};
+            passed = passed && error.empty() && (a.getFloatData() == nullptr) && areEqual(a.getMatrix(), expected, 2, 3, 0);
+        }
+        // No rows: there are no elements to read, and the Matrix is 0 x 0.
+        {
+            string header = "{'descr': '<f8', 'fortran_order': False, 'shape': (0, 5), }";
+            header.append(117 - header.size(), ' ');
+            header += '\n';
+            ofstream f(path, ios::binary);
+            f.write("\x93NUMPY\x01\x00\x76\x00", 10);
+            f << header;
+        }
+        {
+            NpyArray a = readNpyFile(path, error);
+            Matrix empty = a.getMatrix();
+            passed = passed && error.empty() && (a.getNumRows() == 0) && (a.getNumColumns() == 5) && (a.size() == 0);
+            passed = passed && (empty.getNumRows() == 0) && (empty.getNumColumns() == 0) && (a.getVector().size() == 0);
+        }
+        {
+            ofstream f(path, ios::binary);
+            string text = string("\x93NUMPY\x01\x00\x39\x00", 10) + "{'descr': '<i8', 'fortran_order': False, 'shape': (2,), }";
+            f << text << string(16, '\0');
+        }
+        readNpyFile(path, error);
+        passed = passed && (error.find("unsupported element type") == 0);
+        {
+            NpzWriter writer(bundlePath);
+            passed = passed && writer.add("features", m) && writer.add("weights", v, NPY_FLOAT32) && writer.close();
+        }
+        {
+            map<string, NpyArray> arrays = readNpzFile(bundlePath, error);
+            passed = passed && error.empty() && (arrays.size() == 2);
+            passed = passed && areEqual(arrays["features"].getMatrix(), m, 7, 5, 0);
+            passed = passed && areEqual(arrays["weights"].getVector(), v, 11, 1e-7);
+        }
+        remove(path.c_str());
+        remove(bundlePath.c_str());
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+}
@@ -1,4 +1,11 @@
 #include "test_base.hpp"
+#include "fixed_matrix.hpp"
+#include "linalg_allocator.hpp"
+#include "matrix_view.hpp"
+#include "random_generator.hpp"
+#include "random_quantities.hpp"
+#include <complex>
+#include <cstdint>
 #include <vector>
 
 using namespace std;
@@ -29,4 +36,249 @@ void performLinearAlgebraTests2(vector<TestParams>& testParamsList)
     doTest(8.9, sv.getSum(), "SparseVector sum", testParamsList);
     doTest(-6.2, sv.getMin(), "SparseVector min", testParamsList);
     doTest(8.1, sv.getMax(), "SparseVector max", testParamsList);
+    {
+        string testName = "Float matrices and vectors";
+        cout << "TEST: " << testName << endl;
+        FloatMatrix m = vector<vector<float> >{{2, 1}, {1, 3}};
+        FloatVector v = vector<float>{1.5f, -2};
+        FloatVector mv = m * v;
+        bool passed = areEqual(mv, vector<float>{1, -4.5f}, 2, 0);
+        passed = passed && areEqual(m.getInverse() * m, vector<vector<float> >{{1, 0}, {0, 1}}, 2, 2, 1e-6);
+        FloatSparseVector sv(0.5f, 4);
+        sv[1] = -3;
+        passed = passed && (sv.getMin() == -3.0f) && (sv.getSum() == -1.5f);
+        // Conversions between element types are explicit.
+        Matrix promoted(m);
+        passed = passed && areEqual(promoted * Vector(v), vector<double>{1, -4.5}, 2, 0);
+        passed = passed && (m.getText() == promoted.getText());
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        string testName = "Complex matrices and vectors";
+        cout << "TEST: " << testName << endl;
+        typedef complex<double> Complex;
+        ComplexMatrix m = vector<vector<Complex> >{{Complex(4, 0), Complex(1, -2)}, {Complex(1, 2), Complex(6, 0)}};
+        ComplexVector v = vector<Complex>{Complex(1, 1), Complex(0, -1)};
+        ComplexVector mv = m * v;
+        bool passed = (abs(mv[0] - Complex(2, 3)) < 1e-12) && (abs(mv[1] - Complex(-1, -3)) < 1e-12);
+        // m is Hermitian positive definite, so m = L * L^H.
+        ComplexMatrix l = m.getCholeskyFactor();
+        ComplexMatrix lh = l.getTranspose();
+        for(size_t i = 0; i < 2; i++)
+        {
+            for(size_t j = 0; j < 2; j++)
+            {
+                lh[i][j] = conj(lh[i][j]);
+            }
+        }
+        ComplexMatrix product = l * lh;
+        ComplexMatrix identity = m.getInverse() * m;
+        for(size_t i = 0; i < 2; i++)
+        {
+            for(size_t j = 0; j < 2; j++)
+            {
+                passed = passed && (abs(product[i][j] - m[i][j]) < 1e-12);
+                passed = passed && (abs(identity[i][j] - Complex((i == j) ? 1 : 0, 0)) < 1e-12);
+            }
+        }
+        ComplexSparseMatrix sm(0, 2, 2);
+        sm[0][1] = Complex(0, 1);
+        ComplexVector smv = sm * v;
+        passed = passed && (smv[0] == Complex(1, 0)) && (smv[1] == Complex(0, 0));
+        passed = passed && (v.dot(v) == Complex(-1, 2)) && (v.getMax() == Complex(1, 1));
+        passed = passed && (v.getText() == "(1.000000,1.000000)  (0.000000,-1.000000) ");
+        ComplexMatrix promoted(FloatMatrix(vector<vector<float> >{{1.5f}}));
+        passed = passed && (promoted[0][0] == Complex(1.5, 0));
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        string testName = "Fixed-size matrices and vectors";
+        cout << "TEST: " << testName << endl;
+        // Evaluated at compile time.
+        constexpr FixedMatrix<3, 3> a = {{2, -1, 0}, {-1, 2, -1}, {0, -1, 2}};
+        static_assert(a.getDeterminant() == 4, "Determinant of a 3x3 matrix");
+        constexpr FixedMatrix<2, 2> b = FixedMatrix<2, 2>{{2, 1}, {1, 1}}.getInverse();
+        static_assert((b[0][0] == 1) && (b[0][1] == -1) && (b[1][1] == 2), "Inverse of a 2x2 matrix");
+        constexpr FixedVector<3> x = a * FixedVector<3>{1, 2, 3};
+        static_assert((x[0] == 0) && (x[1] == 0) && (x[2] == 4), "Matrix-vector product");
+        bool passed = areEqual((a * a.getInverse()).getMatrix(), FixedMatrix<3, 3>::getIdentity().getMatrix(), 3, 3, 1e-14);
+        FixedMatrix<4, 4> c = {{1, 2, 0, 1}, {0, 3, 1, 2}, {4, 0, 1, 0}, {1, 1, 1, 5}};
+        Matrix full = c.getMatrix();
+        passed = passed && areEqual(c.getInverse().getMatrix(), full.getInverse(), 4, 4, 1e-12);
+        passed = passed && areEqual(c.getDeterminant(), 46, 1e-12);
+        // Larger sizes use Gaussian elimination.
+        static_assert((FixedMatrix<5, 5>::getIdentity() * 2).getDeterminant() == 32, "Determinant of a 5x5 matrix");
+        FixedMatrix<5, 5> d;
+        for(size_t i = 0; i < 5; i++)
+        {
+            for(size_t j = 0; j < 5; j++)
+            {
+                d[i][j] = (i == j) ? 0 : 1.0 / (i + j + 1);
+            }
+        }
+        passed = passed && areEqual(d.getInverse().getMatrix(), d.getMatrix().getInverse(), 5, 5, 1e-10);
+        passed = passed && areEqual((d * d.getInverse()).getMatrix(), FixedMatrix<5, 5>::getIdentity().getMatrix(), 5, 5, 1e-12);
+        FixedMatrix<2, 3> e(Matrix(vector<vector<double> >{{1, 2, 3}, {4, 5, 6}}));
+        FixedVector<2> v(Vector(vector<double>{1, -1}));
+        passed = passed && areEqual((v * e).getVector(), vector<double>{-3, -3, -3}, 3, 0);
+        passed = passed && areEqual((e.getTranspose() * e).getMatrix(), (e.getMatrix().getTranspose() * e.getMatrix()), 3, 3, 0);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        string testName = "Arena scopes for linear algebra temporaries";
+        cout << "TEST: " << testName << endl;
+        Matrix a = vector<vector<double> >{{1, 2}, {3, 4}};
+        Vector x = vector<double>{1, -1};
+        Matrix kept;
+        SparseMatrix sparseKept(0, 2, 2);
+        Arena arena(1 << 16);
+        size_t capacity = 0;
+        bool passed = (LinalgArenaScope::getCurrentArena() == nullptr);
+        for(size_t iteration = 0; iteration < 3; iteration++)
+        {
+            LinalgArenaScope scope(arena);
+            Matrix p = a * a + a;
+            Vector y = p * x;
+            // The temporaries are taken from the arena, with aligned element arrays.
+            passed = passed && (p.getData().get_allocator().getArena() == &arena) && (p[1].get_allocator().getArena() == &arena);
+            passed = passed && (y.getData().get_allocator().getArena() == &arena);
+            passed = passed && (reinterpret_cast<uintptr_t>(p[0].data()) % LINALG_ALIGNMENT == 0);
+            // Assignments and insertions into objects made outside keep their memory.
+            kept = p;
+            sparseKept[1][0] = y[1];
+            {
+                Arena innerArena;
+                LinalgArenaScope innerScope(innerArena);
+                passed = passed && ((a * 2).getData().get_allocator().getArena() == &innerArena);
+            }
+            passed = passed && (LinalgArenaScope::getCurrentArena() == &arena);
+            // The arena is rewound at the end of every scope, so it only grows once.
+            passed = passed && ((iteration == 0) || (arena.getCapacity() == capacity));
+            capacity = arena.getCapacity();
+        }
+        passed = passed && (LinalgArenaScope::getCurrentArena() == nullptr) && (arena.getMarker().offset == 0);
+        {
+            // An object of an outer scope which grows inside an inner scope of the same
+            // arena is still valid after the inner scope ends.
+            LinalgArenaScope outerScope(arena);
+            Matrix grown = vector<vector<double> >{{1, 2}};
+            {
+                LinalgArenaScope innerScope(arena);
+                grown = vector<vector<double> >{{1, 2}, {3, 4}, {5, 6}, {7, 8}};
+            }
+            Matrix overwriting = vector<vector<double> >{{-1, -1}, {-1, -1}, {-1, -1}, {-1, -1}};
+            passed = passed && areEqual(grown, Matrix(vector<vector<double> >{{1, 2}, {3, 4}, {5, 6}, {7, 8}}), 4, 2, 0);
+            passed = passed && (LinalgArenaScope::getCurrentArena() == &arena) && (overwriting[3][1] == -1);
+        }
+        passed = passed && (arena.getMarker().offset == 0);
+        passed = passed && areEqual(kept, Matrix(vector<vector<double> >{{8, 12}, {18, 26}}), 2, 2, 0);
+        passed = passed && (kept.getData().get_allocator().getArena() == nullptr) && (kept[0].get_allocator().getArena() == nullptr);
+        passed = passed && (reinterpret_cast<uintptr_t>(kept[1].data()) % LINALG_ALIGNMENT == 0);
+        const SparseMatrix& constSparseKept = sparseKept;
+        passed = passed && (constSparseKept[1][0] == -8) && (sparseKept.getData().at(1).getData().get_allocator().getArena() == nullptr);
+        // Rows allocated by several threads are allocated up front inside a scope.
+        RandomStream serialStream(2024, 1), scopedStream(2024, 1);
+        Matrix serial = getRandomMatrix(40, 30, 0, 1, serialStream, 1);
+        {
+            LinalgArenaScope scope(arena);
+            Matrix scoped = getRandomMatrix(40, 30, 0, 1, scopedStream, 4);
+            passed = passed && (scoped.getData() == serial.getData()) && (scoped[39].get_allocator().getArena() == &arena);
+        }
+        // Outside of arenas the map nodes come from a free list, so a released node is
+        // the next one handed out.
+        const void* node = nullptr;
+        {
+            SparseVector sv(0, 10);
+            sv[3] = 1;
+            node = &(*sv.getData().begin());
+        }
+        {
+            SparseVector sv(0, 10);
+            sv[7] = 2;
+            passed = passed && (&(*sv.getData().begin()) == node);
+        }
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        string testName = "Matrix, vector and sparse matrix views";
+        cout << "TEST: " << testName << endl;
+        Matrix m = vector<vector<double> >{{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}, {13, 14, 15, 16}};
+        const Matrix& constM = m;
+        MatrixView block = m.getBlock(1, 1, 2, 2);
+        ConstMatrixView corner = constM.getBlock(0, 0, 2, 2);
+        Matrix blockCopy = vector<vector<double> >{{6, 7}, {10, 11}};
+        bool passed = areEqual(block, blockCopy, 2, 2, 0) && areEqual(block.getMatrix(), blockCopy, 2, 2, 0);
+        passed = passed && areEqual(constM.getColumn(2), vector<double>{3, 7, 11, 15}, 4, 0);
+        passed = passed && areEqual(m.getDiagonal(), vector<double>{1, 6, 11, 16}, 4, 0);
+        passed = passed && areEqual(block.getRow(1), vector<double>{10, 11}, 2, 0) && areEqual(m.getColumns(3, 1).getColumn(0), vector<double>{4, 8, 12, 16}, 4, 0);
+        // Views as operands, with each other and with whole matrices and vectors.
+        Vector ones = vector<double>{1, 1, 1, 1};
+        passed = passed && areEqual(block + corner, Matrix(vector<vector<double> >{{7, 9}, {15, 17}}), 2, 2, 0);
+        passed = passed && areEqual(block * corner, blockCopy * corner.getMatrix(), 2, 2, 0) && areEqual(blockCopy - block, Matrix(vector<vector<double> >{{0, 0}, {0, 0}}), 2, 2, 0);
+        passed = passed && areEqual(m * m.getColumn(0), m * Vector(vector<double>{1, 5, 9, 13}), 4, 0) && areEqual(m.getRows(1, 2) * ones, vector<double>{26, 42}, 2, 0);
+        passed = passed && areEqual(m.getColumn(2).dot(m.getDiagonal()), 406) && areEqual(ones * m.getColumns(1, 2), vector<double>{32, 36}, 2, 0);
+        // Views as outputs: products and sums written into parts of a larger matrix.
+        Matrix big = vector<vector<double> >(4, vector<double>(4, 0));
+        big.getBlock(2, 2, 2, 2).setProduct(block, block);
+        passed = passed && areEqual(big.getBlock(2, 2, 2, 2), blockCopy * blockCopy, 2, 2, 0);
+        passed = passed && areEqual(big.getBlock(0, 0, 2, 4), Matrix(vector<vector<double> >(2, vector<double>(4, 0))), 2, 4, 0);
+        big.getColumn(0).setProduct(m, ones);
+        passed = passed && areEqual(big.getColumn(0), vector<double>{10, 26, 42, 58}, 4, 0);
+        big.getBlock(0, 1, 1, 3).getRow(0).setLeftProduct(vector<double>{1, 0, 1}, m.getBlock(0, 0, 3, 3));
+        passed = passed && areEqual(big[0], vector<double>{10, 10, 12, 14}, 4, 0);
+        MatrixView lower = big.getBlock(2, 2, 2, 2);
+        lower.setSum(lower, lower);
+        passed = passed && areEqual(lower, blockCopy * blockCopy * 2, 2, 2, 0);
+        // Products added to what a view holds, e.g. C -= A * B.
+        lower.addProduct(blockCopy, block, -1);
+        passed = passed && areEqual(lower, blockCopy * blockCopy, 2, 2, 0);
+        big.getColumn(1).addProduct(m.getBlock(0, 0, 4, 2), vector<double>{1, -1}, 2);
+        passed = passed && areEqual(big.getColumn(1), vector<double>{8, -2, -2, -2}, 4, 0);
+        // The output of a product must not overlap its operands (an assertion fails).
+        passed = passed && m.getBlock(0, 0, 2, 2).getExtent().overlaps(getMatrixViewExtent(block)) && !block.getExtent().overlaps(getMatrixViewExtent(m.getBlock(3, 0, 1, 4)));
+        passed = passed && m.getDiagonal().getExtent().overlaps(getMatrixViewExtent(m)) && !lower.getExtent().overlaps(getMatrixViewExtent(m));
+        passed = passed && !m.getColumn(0).getExtent().overlaps(getMatrixViewExtent(m.getColumns(1, 3))) && !block.getExtent().overlaps(getMatrixViewExtent(ones));
+        // Nor may the output of an element-wise operation overlap a shifted operand, though it
+        // may be the operand itself.
+        passed = passed && m.getRows(1, 3).getExtent().overlapsShifted(getMatrixViewExtent(m.getRows(0, 3))) && !lower.getExtent().overlapsShifted(getMatrixViewExtent(lower));
+        passed = passed && m.getBlock(0, 1, 1, 3).getRow(0).getExtent().overlapsShifted(getMatrixViewExtent(m.getBlock(0, 0, 1, 3).getRow(0)));
+        passed = passed && !m.getColumn(1).getExtent().overlapsShifted(getMatrixViewExtent(m.getColumn(1))) && !m.getRows(2, 2).getExtent().overlapsShifted(getMatrixViewExtent(m.getRows(0, 2)));
+        // Writing through a view of the matrix changes the matrix itself.
+        block.setScaled(blockCopy, -1);
+        passed = passed && (m[1][1] == -6) && (m[2][2] == -11) && (m[1][3] == 8) && (corner[1][1] == -6);
+        // Blocks of a sparse matrix, as operands of the same kernels.
+        SparseMatrix sm(0, 5, 5, vector<SparseMatrixEntry>{{0, 0, 1}, {1, 2, 2}, {2, 1, 3}, {2, 4, 4}, {3, 3, 5}, {4, 0, 6}});
+        SparseMatrixView window = sm.getBlock(1, 1, 3, 3);
+        Matrix windowCopy = vector<vector<double> >{{0, 2, 0}, {3, 0, 0}, {0, 0, 5}};
+        passed = passed && areEqual(window.getMatrix(), windowCopy, 3, 3, 0) && (window.getSparseMatrix().getNumStoredElements() == 3);
+        passed = passed && areEqual(window * Vector(vector<double>{1, 2, 3}), vector<double>{4, 3, 15}, 3, 0);
+        Matrix product = vector<vector<double> >(3, vector<double>(3, 0));
+        product.getBlock(0, 0, 3, 3).setProduct(window, constM.getBlock(0, 0, 3, 3));
+        passed = passed && areEqual(product, windowCopy * constM.getBlock(0, 0, 3, 3).getMatrix(), 3, 3, 0);
+        // Sparse operands with views, and sparse views with other operands.
+        ConstMatrixView square = constM.getBlock(0, 0, 3, 3);
+        Matrix squareCopy = square.getMatrix();
+        SparseVector sv(0.5, 3);
+        sv[1] = -2;
+        passed = passed && areEqual(window + square, windowCopy + squareCopy, 3, 3, 0) && areEqual(window - square, windowCopy - squareCopy, 3, 3, 0);
+        passed = passed && areEqual(window * square, windowCopy * squareCopy, 3, 3, 0) && areEqual(window * window, windowCopy * windowCopy, 3, 3, 0);
+        passed = passed && areEqual((window + window).getFullMatrix(), windowCopy * 2, 3, 3, 0) && areEqual((window * 3).getFullMatrix(), windowCopy * 3, 3, 3, 0);
+        passed = passed && areEqual((window - window).getFullMatrix(), windowCopy * 0, 3, 3, 0);
+        passed = passed && areEqual(window * square.getColumn(1), windowCopy * squareCopy.getColumn(1).getVector(), 3, 0) && areEqual(window * sv, windowCopy * sv, 3, 0);
+        SparseMatrix smallSparse = window.getSparseMatrix();
+        passed = passed && areEqual(smallSparse + square, windowCopy + squareCopy, 3, 3, 0) && areEqual(smallSparse - square, windowCopy - squareCopy, 3, 3, 0);
+        passed = passed && areEqual(smallSparse * square, windowCopy * squareCopy, 3, 3, 0) && areEqual(smallSparse * square.getDiagonal(), windowCopy * square.getDiagonal(), 3, 0);
+        Vector column = square.getColumn(2).getVector();
+        passed = passed && areEqual(sv + square.getColumn(2), sv + column, 3, 0) && areEqual(sv - square.getColumn(2), sv - column, 3, 0);
+        passed = passed && areEqual(sv.dot(square.getColumn(2)), sv.dot(column)) && areEqual(sv * square, sv * squareCopy, 3, 0);
+        // Views of matrices of other element types.
+        FloatMatrix fm(m);
+        passed = passed && areEqual(FloatMatrix(fm.getBlock(1, 0, 2, 1).getMatrix() * 2.0f), Matrix(vector<vector<double> >{{10}, {18}}), 2, 1, 0);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
 }
\ No newline at end of file
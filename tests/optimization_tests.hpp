@@ -0,0 +1,124 @@
+#include "test_base.hpp"
+#include "optimization.hpp"
+#include <vector>
+
+using namespace std;
+
+// Extended Rosenbrock function and its gradient; the minimum is 0, at (1, ..., 1).
+double getRosenbrockObjective(const Vector& x, Vector& gradient)
+{
+    size_t n = x.size();
+    double sum = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        gradient[i] = 0;
+    }
+    for(size_t i = 0; (i + 1) < n; i++)
+    {
+        double a = x[i + 1] - x[i] * x[i];
+        double b = 1 - x[i];
+        sum += (100 * a * a + b * b);
+        gradient[i] += (-400 * a * x[i] - 2 * b);
+        gradient[i + 1] += 200 * a;
+    }
+    return sum;
+}
+
+void performOptimizationTests(vector<TestParams>& testParamsList)
+{
+    string testName;
+    bool passed;
+    {
+        testName = "Brent root";
+        cout << "TEST: " << testName << endl;
+        RootFindingResult r1 = getBrentRoot([](double x) { return cos(x) - x; }, 0, 1);
+        RootFindingResult r2 = getBrentRoot([](double x) { return x * x * x - 2 * x - 5; }, 3, 2);
+        passed = r1.converged && areEqual(r1.root, 0.7390851332151607, 1.e-12);
+        passed = passed && r2.converged && areEqual(r2.root, 2.0945514815423265, 1.e-12) && (r2.numIterations < 20);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Newton root";
+        cout << "TEST: " << testName << endl;
+        auto func = [](double x) { return x * x - 2; };
+        RootFindingResult r1 = getNewtonRoot(func, [](double x) { return 2 * x; }, 1.0);
+        RootFindingResult r2 = getFiniteDifferenceNewtonRoot(func, 1.0);
+        RootFindingResult r3 = getNewtonRoot([](double x) { return x * x + 1; }, [](double x) { return 2 * x; }, 0.0);
+        passed = r1.converged && areEqual(r1.root, sqrt(2.0), 1.e-14) && (r1.numIterations < 10);
+        passed = passed && r2.converged && areEqual(r2.root, sqrt(2.0), 1.e-12);
+        passed = passed && !r3.converged;
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "L-BFGS minimum";
+        cout << "TEST: " << testName << endl;
+        size_t n = 20;
+        vector<double> start(n), ones(n, 1);
+        for(size_t i = 0; i < n; i++)
+        {
+            start[i] = (i % 2 == 0) ? -1.2 : 1;
+        }
+        LBFGSWorkspace workspace(n, 8);
+        Vector x = start;
+        OptimizationResult result = getLBFGSMinimum(getRosenbrockObjective, x, workspace, 1.e-9);
+        passed = result.converged && areEqual(x, Vector(ones), n, 1.e-8) && areEqual(result.value, 0, 1.e-15);
+        // The workspace can be reused, and gives the same iterates again.
+        Vector y = start;
+        OptimizationResult repeated = getLBFGSMinimum(getRosenbrockObjective, y, workspace, 1.e-9);
+        passed = passed && (repeated.numEvaluations == result.numEvaluations) && areEqual(x, y, n, 0);
+        // Finite difference gradients.
+        Vector z = vector<double>{-1.2, 1};
+        auto objective = getFiniteDifferenceObjective([](const Vector& v) { return 100 * pow(v[1] - v[0] * v[0], 2) + pow(1 - v[0], 2); });
+        OptimizationResult fdResult = getLBFGSMinimum(objective, z, 1.e-6);
+        passed = passed && fdResult.converged && areEqual(z, vector<double>{1, 1}, 2, 1.e-5);
+        // A pair without positive curvature, once the history is full, leaves the stored
+        // pairs (including the oldest one, in the slot it would take) unchanged.
+        LBFGSWorkspace history(2, 2);
+        size_t newest = 0, numStored = 0;
+        Vector origin = vector<double>{0, 0}, first = vector<double>{1, 0}, second = vector<double>{1, 1};
+        passed = passed && addLBFGSCorrection(history, origin, first, origin, first, newest, numStored);
+        passed = passed && addLBFGSCorrection(history, first, second, first, second * 2, newest, numStored);
+        passed = passed && (numStored == 2) && (newest == 1);
+        passed = passed && !addLBFGSCorrection(history, second, origin, second, second * 3, newest, numStored);
+        passed = passed && (numStored == 2) && (newest == 1) && areEqual(history.s[0], first, 2, 0) && areEqual(history.y[0], first, 2, 0);
+        passed = passed && (history.rho[0] == 1) && areEqual(history.y[1], vector<double>{1, 2}, 2, 0);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Newton-CG minimum";
+        cout << "TEST: " << testName << endl;
+        size_t n = 20;
+        vector<double> start(n), ones(n, 1);
+        for(size_t i = 0; i < n; i++)
+        {
+            start[i] = (i % 2 == 0) ? -1.2 : 1;
+        }
+        NewtonCGWorkspace workspace(n);
+        Vector x = start;
+        OptimizationResult result = getNewtonCGMinimum(getRosenbrockObjective, x, workspace, 1.e-8);
+        passed = result.converged && areEqual(x, Vector(ones), n, 1.e-7);
+        // Quadratic with an exact Hessian product.
+        Matrix a = vector<vector<double> >{{4, 1, 0}, {1, 3, 1}, {0, 1, 2}};
+        Vector b = vector<double>{1, 2, 3};
+        auto quadratic = [&](const Vector& v, Vector& gradient)
+        {
+            Vector av = a * v;
+            gradient = av - b;
+            return 0.5 * v.dot(av) - b.dot(v);
+        };
+        auto hessianProduct = [&](const Vector& v, const Vector& d, Vector& hd)
+        {
+            hd = a * d;
+        };
+        NewtonCGWorkspace smallWorkspace(3);
+        Vector y = vector<double>{0, 0, 0};
+        OptimizationResult quadraticResult = getNewtonCGMinimum(quadratic, hessianProduct, y, smallWorkspace, 1.e-10);
+        Vector ay = a * y;
+        passed = passed && quadraticResult.converged && (quadraticResult.numIterations < 10) && areEqual(ay, b, 3, 1.e-10);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "test_base.hpp"
+#include "random_generator.hpp"
+#include "random_quantities.hpp"
+#include "random_distributions.hpp"
+#include "matrix.hpp"
+#include "vectr.hpp"
+#include "sparse_matrix.hpp"
+#include "sparse_vector.hpp"
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Sample mean and variance of the elements of v.
+void getSampleMoments(const Vector& v, double& mean, double& variance)
+{
+    double sum = 0, sumSquares = 0;
+    for(size_t i = 0; i < v.size(); i++)
+    {
+        sum += v[i];
+        sumSquares += v[i] * v[i];
+    }
+    mean = sum / v.size();
+    variance = sumSquares / v.size() - mean * mean;
+}
+
+void performRandomTests(vector<TestParams>& testParamsList)
+{
+    string testName;
+    bool passed;
+    {
+        testName = "Philox known answers";
+        cout << "TEST: " << testName << endl;
+        uint32_t zeroCounter[4] = {0, 0, 0, 0}, zeroKey[2] = {0, 0};
+        uint32_t piCounter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, piKey[2] = {0xa4093822, 0x299f31d0};
+        uint32_t out[4];
+        getPhiloxBlock(zeroCounter, zeroKey, out);
+        passed = (out[0] == 0x6627e8d5) && (out[1] == 0xe169c58d) && (out[2] == 0xbc57ac4c) && (out[3] == 0x9b00dbd8);
+        getPhiloxBlock(piCounter, piKey, out);
+        passed = passed && (out[0] == 0xd16cfe09) && (out[1] == 0x94fdcceb) && (out[2] == 0x5001e420) && (out[3] == 0x24126ea1);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Random stream bulk fill";
+        cout << "TEST: " << testName << endl;
+        size_t n = 100003;
+        RandomStream single(12345, 7);
+        single.skip(3);
+        vector<double> expected(n);
+        double sum = 0;
+        for(size_t i = 0; i < n; i++)
+        {
+            expected[i] = single.getUniform(-1, 2);
+            sum += expected[i];
+        }
+        passed = areEqual(sum / n, 0.5, 0.02);
+        // The same numbers, whatever the number of threads.
+        for(size_t numThreads: {1, 3, 8})
+        {
+            RandomStream bulk(12345, 7);
+            bulk.setPosition(3);
+            vector<double> values(n);
+            bulk.fill(&values[0], n, -1, 2, numThreads);
+            passed = passed && (values == expected) && (bulk.getPosition() == n + 3);
+        }
+        // Different streams and seeds differ.
+        RandomStream other(12345, 8), reseeded(12346, 7);
+        passed = passed && (other.getUniform() != RandomStream(12345, 7).getUniform());
+        passed = passed && (reseeded.getUniform() != RandomStream(12345, 7).getUniform());
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Thread-local getRandom";
+        cout << "TEST: " << testName << endl;
+        setRandomSeed(99);
+        vector<double> first(5);
+        for(auto& v: first)
+        {
+            v = getRandom(3, 4);
+        }
+        double otherThreadValue = 0;
+        thread t([&otherThreadValue]() { otherThreadValue = getRandom(3, 4); });
+        t.join();
+        setRandomSeed(99);
+        passed = true;
+        for(auto v: first)
+        {
+            passed = passed && (v == getRandom(3, 4)) && (v >= 3) && (v < 4);
+        }
+        passed = passed && (otherThreadValue >= 3) && (otherThreadValue < 4) && (otherThreadValue != first[0]);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Reproducible random matrix and vector";
+        cout << "TEST: " << testName << endl;
+        size_t numRows = 301, numColumns = 257;
+        RandomStream reference(2024, 3);
+        RandomStream serialStream(2024, 3);
+        Matrix serial = getRandomMatrix(numRows, numColumns, -2, 5, serialStream, 1);
+        Vector serialVector = getRandomVector(70001, 0, 1, serialStream, 1);
+        passed = (serial.getNumRows() == numRows) && (serial.getNumColumns() == numColumns);
+        // Row-major order from the stream, then the vector.
+        passed = passed && (serial[0][0] == reference.getUniform(-2, 5)) && (serial[0][1] == reference.getUniform(-2, 5));
+        reference.setPosition(numColumns);
+        passed = passed && (serial[1][0] == reference.getUniform(-2, 5));
+        reference.setPosition(numRows * numColumns);
+        passed = passed && (serialVector[0] == reference.getUniform());
+        passed = passed && (serialStream.getPosition() == numRows * numColumns + 70001);
+        for(size_t numThreads: {2, 5, 0})
+        {
+            RandomStream parallelStream(2024, 3);
+            Matrix parallel = getRandomMatrix(numRows, numColumns, -2, 5, parallelStream, numThreads);
+            Vector parallelVector = getRandomVector(70001, 0, 1, parallelStream, numThreads);
+            passed = passed && (parallel.getData() == serial.getData()) && (parallelVector.getData() == serialVector.getData());
+        }
+        passed = passed && (serial.getData()[0] != serial.getData()[1]) && (serialVector.getMin() >= 0) && (serialVector.getMax() < 1);
+        // No rows gives the null matrix, without drawing from the stream.
+        Matrix empty = getRandomMatrix(0, numColumns, -2, 5, serialStream, 4);
+        passed = passed && (empty.getNumRows() == 0) && (empty.getNumColumns() == 0) && (serialStream.getPosition() == numRows * numColumns + 70001);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "SparseMatrix from sorted entries";
+        cout << "TEST: " << testName << endl;
+        vector<SparseMatrixEntry> entries = {{0, 1, 2.5}, {0, 4, -1}, {2, 0, 3}, {3, 3, 7}, {3, 4, 0.5}};
+        SparseMatrix bulk(1.5, 5, 6, entries);
+        SparseMatrix single(1.5, 5, 6);
+        for(const auto& e: entries)
+        {
+            single[e.row][e.column] = e.value;
+        }
+        const SparseVector v(-1, 8, {{2, 4}, {5, 6}});
+        passed = (bulk.getNumRows() == 5) && (bulk.getNumColumns() == 6) && (bulk.getNumStoredElements() == 5);
+        passed = passed && areEqual(bulk.getFullMatrix(), single.getFullMatrix(), 5, 6, 0);
+        passed = passed && (v.size() == 8) && (v[2] == 4) && (v[5] == 6) && (v[7] == -1);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Random sparse matrices";
+        cout << "TEST: " << testName << endl;
+        RandomStream stream(77);
+        SparseMatrix uniform = getRandomSparseMatrix(300, 400, 12000, 0.25, -1, 1, stream, 1);
+        const SparseMatrix banded = getRandomBandedMatrix(50, 40, 2, 3, 0, 1, 2, stream, 1);
+        SparseVector sparseVector = getRandomSparseVector(100000, 1000, 0, 0, 1, stream);
+        // Expected number of elements, within a few standard deviations.
+        passed = (uniform.getNumStoredElements() > 11600) && (uniform.getNumStoredElements() < 12400);
+        passed = passed && (sparseVector.getData().size() > 900) && (sparseVector.getData().size() < 1100);
+        Matrix full = uniform.getFullMatrix();
+        size_t numDefault = 0;
+        for(size_t i = 0; i < 300; i++)
+        {
+            for(size_t j = 0; j < 400; j++)
+            {
+                numDefault += (full[i][j] == 0.25) ? 1 : 0;
+                passed = passed && (full[i][j] >= -1) && (full[i][j] < 1);
+            }
+        }
+        passed = passed && (numDefault + uniform.getNumStoredElements() == 300 * 400);
+        // Rows 0 and 1 are cut off by the band on the left, rows 38 to 49 on the right.
+        size_t expectedBand = 0;
+        for(size_t i = 0; i < 50; i++)
+        {
+            for(size_t j = 0; j < 40; j++)
+            {
+                bool inBand = (j + 2 >= i) && (j <= i + 3);
+                expectedBand += inBand ? 1 : 0;
+                passed = passed && (inBand ? (banded[i][j] >= 1) : (banded[i][j] == 0));
+            }
+        }
+        passed = passed && (banded.getNumStoredElements() == expectedBand);
+        // The same matrices on several threads.
+        RandomStream parallelStream(77);
+        SparseMatrix parallelUniform = getRandomSparseMatrix(300, 400, 12000, 0.25, -1, 1, parallelStream, 4);
+        SparseMatrix parallelBanded = getRandomBandedMatrix(50, 40, 2, 3, 0, 1, 2, parallelStream, 3);
+        passed = passed && areEqual(parallelUniform.getFullMatrix(), full, 300, 400, 0);
+        passed = passed && areEqual(parallelBanded.getFullMatrix(), banded.getFullMatrix(), 50, 40, 0);
+        passed = passed && (parallelStream.getPosition() == stream.getPosition() - (2 * 100000 + 2));
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "R-MAT and SPD sparse matrices";
+        cout << "TEST: " << testName << endl;
+        RandomStream stream(5), parallelStream(5);
+        const SparseMatrix rmat = getRMATMatrix(10, 20000, 0.57, 0.19, 0.19, 0, 1, 2, stream, 1);
+        SparseMatrix parallelRmat = getRMATMatrix(10, 20000, 0.57, 0.19, 0.19, 0, 1, 2, parallelStream, 4);
+        passed = (rmat.getNumRows() == 1024) && (rmat.getNumStoredElements() <= 20000) && (rmat.getNumStoredElements() > 10000);
+        passed = passed && areEqual(rmat.getFullMatrix(), parallelRmat.getFullMatrix(), 1024, 1024, 0);
+        // The degrees follow a power law: the first row, in the densest quadrant at every
+        // level, has far more elements than the average row.
+        passed = passed && (rmat[0].getData().size() > 10 * rmat.getNumStoredElements() / 1024);
+        SparseMatrix spd = getRandomSPDMatrix(200, 2000, -1, 1, stream, 3);
+        Matrix full = spd.getFullMatrix();
+        passed = passed && (spd.getNumStoredElements() > 1600) && (spd.getNumStoredElements() < 2400);
+        for(size_t i = 0; i < 200; i++)
+        {
+            double offDiagonal = 0;
+            for(size_t j = 0; j < 200; j++)
+            {
+                passed = passed && (full[i][j] == full[j][i]);
+                offDiagonal += (i == j) ? 0 : fabs(full[i][j]);
+            }
+            passed = passed && (full[i][i] > offDiagonal);
+        }
+        Vector x = getRandomVector(200, -1, 1, stream);
+        passed = passed && (x.dot(spd * x) > 0);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Random distributions";
+        cout << "TEST: " << testName << endl;
+        RandomStream stream(31337);
+        size_t n = 400000;
+        double mean, variance;
+        passed = true;
+        struct Moments
+        {
+            RandomDistribution distribution;
+            double mean;
+            double variance;
+        };
+        vector<Moments> cases = {
+            {RandomDistribution::getNormal(2, 3), 2, 9},
+            {RandomDistribution::getLogNormal(0.5, 0.5), exp(0.625), (exp(0.25) - 1) * exp(1.25)},
+            {RandomDistribution::getExponential(4), 0.25, 0.0625},
+            {RandomDistribution::getGamma(2.5, 2), 5, 10},
+            {RandomDistribution::getGamma(0.5, 1), 0.5, 0.5},
+            {RandomDistribution::getBernoulli(0.3), 0.3, 0.21}};
+        for(const auto& c: cases)
+        {
+            Vector v = getRandomVector(n, c.distribution, stream);
+            getSampleMoments(v, mean, variance);
+            // Within about 5 standard errors.
+            passed = passed && areEqual(mean, c.mean, 5 * sqrt(c.variance / n));
+            passed = passed && areEqual(variance / c.variance, 1, 0.03);
+        }
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Random distributions are independent of threads";
+        cout << "TEST: " << testName << endl;
+        passed = true;
+        for(const auto& distribution: {RandomDistribution::getNormal(), RandomDistribution::getGamma(3)})
+        {
+            RandomStream serialStream(8), parallelStream(8);
+            // An odd offset, so that the samples do not start at a Box-Muller pair.
+            serialStream.skip(3);
+            parallelStream.skip(3);
+            Vector serial = getRandomVector(100001, distribution, serialStream, 1);
+            Vector parallel = getRandomVector(100001, distribution, parallelStream, 6);
+            Matrix matrix = getRandomMatrix(37, 29, distribution, serialStream, 1);
+            Matrix parallelMatrix = getRandomMatrix(37, 29, distribution, parallelStream, 4);
+            passed = passed && (serial.getData() == parallel.getData()) && (matrix.getData() == parallelMatrix.getData());
+            passed = passed && (serialStream.getPosition() == parallelStream.getPosition());
+            // Any range of samples can be generated on its own.
+            vector<double> part(1000);
+            distribution.fill(8, 0, 1001, part.data(), 1000);
+            size_t first = (distribution.getType() == NORMAL) ? 4 : 1;
+            passed = passed && (part[0] == serial[1001 - first]) && (part[999] == serial[2000 - first]);
+        }
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+    {
+        testName = "Multivariate normal samples";
+        cout << "TEST: " << testName << endl;
+        Matrix covariance = vector<vector<double> >{{4, 1.2, -0.8}, {1.2, 2, 0.3}, {-0.8, 0.3, 1}};
+        Vector mean = vector<double>{1, -2, 0.5};
+        Matrix l = covariance.getCholeskyFactor();
+        passed = areEqual(l * l.getTranspose(), covariance, 3, 3, 1.e-14) && (l[0][1] == 0) && (l[1][2] == 0);
+        RandomStream stream(4);
+        size_t n = 200000;
+        Matrix samples = getMultivariateNormalMatrix(n, mean, l, stream);
+        vector<vector<double> > sampleCovariance(3, vector<double>(3, 0));
+        for(size_t s = 0; s < n; s++)
+        {
+            for(size_t i = 0; i < 3; i++)
+            {
+                for(size_t j = 0; j < 3; j++)
+                {
+                    sampleCovariance[i][j] += (samples[s][i] - mean[i]) * (samples[s][j] - mean[j]) / n;
+                }
+            }
+        }
+        passed = passed && areEqual(sampleCovariance, covariance, 3, 3, 0.05);
+        testParamsList.push_back(TestParams(testName, passed));
+        cout << "    passed: " << passed << endl;
+    }
+}
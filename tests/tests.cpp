@@ -2,7 +2,10 @@
 #include <vector>
 #include "linear_algebra_tests.hpp"
 #include "linear_algebra_tests2.hpp"
-//#include "calculus_tests.hpp" // in future
+#include "calculus_tests.hpp"
+#include "optimization_tests.hpp"
+#include "random_tests.hpp"
+#include "io_tests.hpp"
 
 using namespace std;
 
@@ -33,7 +36,10 @@ void testAll()
     vector<TestParams> testParamsList = {};
     performLinearAlgebraTests(testParamsList);
     performLinearAlgebraTests2(testParamsList);
-    //performCalculusTests(testParamsList);
+    performCalculusTests(testParamsList);
+    performOptimizationTests(testParamsList);
+    performRandomTests(testParamsList);
+    performIOTests(testParamsList);
     tabulateResults(testParamsList);
 }
 